@@ -0,0 +1,113 @@
+/*
+ * arq.h
+ *
+ * Selective-repeat ARQ over v2 packet frames.
+ *
+ *  Data  : v2 frame, SEQ = data sequence number, payload = CMD + PAYLOAD
+ *  ACK   : v2 frame, SEQ = next expected SEQ (cumulative),
+ *          payload = ARQ_CMD_ACK | SACK_L | SACK_H
+ *          SACK bit i set = SEQ (cum + 1 + i) already received
+ *  NACK  : v2 frame, SEQ = missing SEQ, payload = ARQ_CMD_NACK
+ *
+ * The receiver ACKs every data frame and NACKs each gap once when a later
+ * frame arrives first; the sender retransmits on NACK or when a frame's
+ * retransmit timeout expires (arq_poll()). Frames are delivered in order.
+ * v1 frames are not covered and pass through unchanged.
+ *
+ * The engine has no HAL/RTOS dependency: it is driven by the caller's
+ * clock (now, in ms) and talks to the link through callbacks. All calls on
+ * one Arq instance must come from the same context (see arq_link.h for the
+ * FreeRTOS wrapper used on UART1/UART3).
+ */
+
+#ifndef INC_ARQ_H_
+#define INC_ARQ_H_
+
+#include <stdint.h>
+#include "packet_codec.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Control CMD bytes (outside the CMD_ID range) */
+#define ARQ_CMD_ACK   0xF0U
+#define ARQ_CMD_NACK  0xF1U
+
+/* Slot storage per direction; power of two, at most 16 (SACK bitmap) */
+#ifndef ARQ_WINDOW_MAX
+#define ARQ_WINDOW_MAX  8U
+#endif
+
+#define ARQ_MAX_PAYLOAD  PKT_V2_MAX_PAYLOAD_LEN
+
+/* Send one encoded frame on the link */
+typedef void (*ArqTxFn)(void *ctx, const uint8_t *frame, uint16_t len);
+/* In-order delivery of a received CMD + PAYLOAD */
+typedef void (*ArqDeliverFn)(void *ctx, const uint8_t *payload, uint16_t len);
+
+typedef struct
+{
+    uint32_t tx_frames;         // first transmissions
+    uint32_t retransmits;       // timeout + NACK retransmissions
+    uint32_t timeouts;
+    uint32_t acks_rx;
+    uint32_t nacks_rx;
+    uint32_t acks_tx;
+    uint32_t nacks_tx;
+    uint32_t delivered;         // frames delivered in order
+    uint32_t delivered_bytes;   // CMD + PAYLOAD bytes delivered
+    uint32_t dup_rx;            // data frames received again
+    uint32_t out_of_window;     // data frames outside the receive window
+} ArqStats;
+
+typedef struct
+{
+    uint8_t payload[ARQ_MAX_PAYLOAD];
+    uint16_t len;
+    uint8_t used;       // tx: unacked frame held, rx: frame buffered
+    uint8_t flag;       // tx: SACKed, rx: NACK already sent for this gap
+    uint32_t sent_at;   // tx: last (re)transmission time
+} ArqSlot;
+
+typedef struct
+{
+    uint8_t window;     // frames in flight, 1..ARQ_WINDOW_MAX
+    uint32_t rto_ms;    // retransmit timeout
+
+    uint8_t snd_base;   // oldest unacked SEQ
+    uint8_t snd_next;   // next SEQ to send
+    ArqSlot tx[ARQ_WINDOW_MAX];
+
+    uint8_t rcv_base;   // next SEQ to deliver
+    ArqSlot rx[ARQ_WINDOW_MAX];
+
+    ArqTxFn tx_fn;
+    ArqDeliverFn deliver_fn;
+    void *ctx;
+
+    ArqStats stats;
+} Arq;
+
+/* window is clamped to 1..ARQ_WINDOW_MAX */
+void arq_init(Arq *a, uint8_t window, uint32_t rto_ms,
+        ArqTxFn tx_fn, ArqDeliverFn deliver_fn, void *ctx);
+
+/* Frames that can be sent right now without blocking on the window */
+uint8_t arq_window_free(const Arq *a);
+
+/* Send CMD + PAYLOAD reliably.
+ * Returns 0 on success, -1 window full, -2 bad length. */
+int arq_send(Arq *a, const uint8_t *payload, uint16_t len, uint32_t now);
+
+/* Feed a received v2 frame (data, ACK or NACK) */
+void arq_on_frame(Arq *a, const PacketFrame *frame, uint32_t now);
+
+/* Retransmit frames whose timeout has expired; call periodically */
+void arq_poll(Arq *a, uint32_t now);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_ARQ_H_ */
@@ -0,0 +1,99 @@
+/*
+ * arq_link.h
+ *
+ * FreeRTOS wrapper running the ARQ engine (arq.h) on one UART link.
+ * A per-link task owns the Arq instance; the UART RX path posts v2 frames
+ * into a message buffer, arq_link_send() queues outgoing commands, and a
+ * periodic FreeRTOS timer wakes the task to run the retransmit timers.
+ * Delivered commands go to the command dispatcher (cmd_dispatch.h).
+ */
+
+#ifndef INC_ARQ_LINK_H_
+#define INC_ARQ_LINK_H_
+
+#include <stdint.h>
+
+#include "main.h"
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "message_buffer.h"
+#include "timers.h"
+#include "arq.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 1: v2 frames on UART1/UART3 go through the ARQ layer
+ * 0: v2 frames are executed directly, no ACK/retransmit (default) */
+#ifndef ARQ_ENABLE
+#define ARQ_ENABLE (0)
+#endif
+
+#ifndef ARQ_LINK_WINDOW
+#define ARQ_LINK_WINDOW   4U
+#endif
+
+/* Retransmit timeout; keep above the round trip of a full frame + ACK */
+#ifndef ARQ_LINK_RTO_MS
+#define ARQ_LINK_RTO_MS   50U
+#endif
+
+/* Retransmit timer resolution */
+#ifndef ARQ_LINK_TICK_MS
+#define ARQ_LINK_TICK_MS  10U
+#endif
+
+/* Message buffer storage per direction (each message costs len + 4 bytes) */
+#ifndef ARQ_LINK_BUF_SIZE
+#define ARQ_LINK_BUF_SIZE 256U
+#endif
+
+typedef struct
+{
+    Arq arq;
+    UART_HandleTypeDef *huart;
+    uint8_t cobs;                   // 1: COBS framing on this link
+
+    MessageBufferHandle_t rx_buf;   // SEQ + CMD + PAYLOAD from the RX path
+    MessageBufferHandle_t tx_buf;   // CMD + PAYLOAD from arq_link_send()
+    TimerHandle_t timer;
+    osThreadId_t task;
+
+    ArqDeliverFn deliver;           // in-order CMD + PAYLOAD, NULL: dispatcher
+    void *deliver_ctx;
+
+    uint32_t rx_dropped;            // frames lost before reaching the task
+} ArqLink;
+
+/* Route delivered CMD + PAYLOAD to fn (link task context) instead of
+ * cmd_dispatch_post(). Call before arq_link_start(). */
+void arq_link_set_deliver(ArqLink *l, ArqDeliverFn fn, void *ctx);
+
+/* Create the link task, buffers and timer. Call from the RTOS threads
+ * section (kernel objects must not be created before the pre-scheduler
+ * loop in main()). cobs selects COBS framing for transmitted frames. */
+void arq_link_start(ArqLink *l, const char *name, UART_HandleTypeDef *huart,
+        uint8_t cobs);
+
+/* Hand a received v2 frame to the link task. Safe from ISR and task
+ * context; only the port's own RX path may call it.
+ * Returns 0 on success, -1 if dropped (not started or buffer full). */
+int arq_link_post_rx(ArqLink *l, const PacketFrame *frame);
+
+/* Queue CMD + PAYLOAD for reliable delivery; call from one task at a time.
+ * Blocks up to timeout_ms while the queue is full.
+ * Returns 0 on success, -1 on timeout, -2 bad length or not started. */
+int arq_link_send(ArqLink *l, const uint8_t *payload, uint16_t len,
+        uint32_t timeout_ms);
+
+static inline const ArqStats *arq_link_stats(const ArqLink *l)
+{
+    return &l->arq.stats;
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_ARQ_LINK_H_ */
@@ -0,0 +1,84 @@
+/*
+ * bipbuf.h
+ *
+ * Bip-buffer (bipartite circular buffer) of bytes, single producer /
+ * single consumer, lock-free like spsc_ring.h.
+ *
+ * Unlike a plain ring, every reservation the producer gets and every
+ * region the consumer peeks is contiguous: a reservation that does not
+ * fit in front of the end starts over at offset 0, and the end of the
+ * valid data (`last`) is recorded so the consumer skips the unused tail.
+ * A chunk committed in one piece can therefore be parsed in place, with
+ * no copy to linearize it (uart_rx.c copy path: one DMA chunk per RX
+ * event, a frame is never split by the wrap point of this buffer).
+ *
+ *   p = bipbuf_reserve(b, n);     // producer: n contiguous bytes or NULL
+ *   memcpy(p, src, n);
+ *   bipbuf_commit(b, n);
+ *
+ *   d = bipbuf_peek(b, &len);     // consumer: oldest contiguous region
+ *   ... use d[0..len) ...
+ *   bipbuf_release(b, len);
+ *
+ * Cost of contiguity: a reservation may leave the tail of the buffer
+ * unused, so the largest reservation that always fits is about size / 2.
+ * bipbuf_write() does not drop data for that: when no contiguous room is
+ * left it splits the chunk at the end of the buffer, as a plain ring
+ * would, and only bytes that do not fit at all count as `dropped`.
+ */
+
+#ifndef INC_BIPBUF_H_
+#define INC_BIPBUF_H_
+
+#include <stdint.h>
+
+#include "spsc_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct
+{
+    uint8_t *buf;
+    uint16_t size;
+    uint16_t write;     // producer: end of committed data
+    uint16_t last;      // producer: end of valid data before a wrap
+    uint16_t reserved;  // producer: start of the open reservation
+    uint16_t read;      // consumer: start of unread data
+    uint32_t dropped;   // bytes bipbuf_write() could not store
+#if (SPSC_RING_STATS != 0)
+    SpscRingStats stats;
+#endif
+} BipBuf;
+
+/* Returns 0, or -1 if size < 2 (a 1-byte buffer could never wrap) */
+int bipbuf_init(BipBuf *b, uint8_t *storage, uint16_t size);
+
+/* Producer: n contiguous bytes to fill, or NULL (nothing is counted) */
+uint8_t *bipbuf_reserve(BipBuf *b, uint16_t n);
+
+/* Producer: publish the first n bytes of the last reservation */
+void bipbuf_commit(BipBuf *b, uint16_t n);
+
+/* Producer: reserve + copy + commit, split at the end of the buffer if
+ * there is no contiguous room. Returns the bytes stored. */
+uint16_t bipbuf_write(BipBuf *b, const uint8_t *data, uint16_t n);
+
+/* Consumer: oldest unread contiguous region, NULL with *len = 0 if empty */
+const uint8_t *bipbuf_peek(BipBuf *b, uint16_t *len);
+
+/* Consumer: free the first n bytes of the peeked region */
+void bipbuf_release(BipBuf *b, uint16_t n);
+
+/* Unread bytes, both parts */
+uint16_t bipbuf_used(const BipBuf *b);
+
+/* Consumer: add the current fill level to the stats histogram */
+void bipbuf_sample(BipBuf *b);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_BIPBUF_H_ */
@@ -10,21 +10,27 @@
 
 #include <stdint.h>
 
+#include "cmd_list.h"
+
 /* ---------- CMD enum ---------- */
 typedef enum
 {
-    LED_ON = 0,
-    LED_OFF,
-    SET_LED,
-    UART_TX,
-    PWM_ON,
-    CRASH,
+#define CMD_ENUM_ENTRY(id, handler, console, args) id,
+    CMD_LIST(CMD_ENUM_ENTRY)
+#undef CMD_ENUM_ENTRY
     INVALID_CMD,
 }CMD_ID;
 
 /* ---------- Public APIs ---------- */
 void process_cmd(void);
-void handle_binary_cmd(uint8_t *payload, uint8_t length);
+/* Execute one binary command: payload = CMD + typed args (no text round-trip).
+ * Returns 0 on success, -1 unknown CMD, -2 bad argument length,
+ * -3 command failed. BATCH: -2 if the batch was rejected (nothing ran),
+ * -3 if a sub-command failed. */
+int handle_binary_cmd(const uint8_t *payload, uint16_t length);
+
+/* Register the "batch_status" reply record; call once after telemetry_init() */
+void cmd_telemetry_init(void);
 
 
 
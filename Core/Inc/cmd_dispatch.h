@@ -0,0 +1,59 @@
+/*
+ * cmd_dispatch.h
+ *
+ * Binary command dispatcher task.
+ * Completed frames are posted from the UART RX path (ISR or task) into
+ * FreeRTOS message buffers; a dedicated task runs handle_binary_cmd(), so
+ * GPIO/HAL calls and blocking UART TX never execute in interrupt context.
+ */
+
+#ifndef INC_CMD_DISPATCH_H_
+#define INC_CMD_DISPATCH_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 1: run binary commands in the dispatcher task (default)
+ * 0: run them inline in the caller's context (legacy, for comparison) */
+#ifndef CMD_DISPATCH_TASK_ENABLE
+#define CMD_DISPATCH_TASK_ENABLE (1)
+#endif
+
+/* Storage of each message buffer in bytes, one for ISR and one for task
+ * producers (each message costs len + 4 bytes) */
+#ifndef CMD_DISPATCH_BUF_SIZE
+#define CMD_DISPATCH_BUF_SIZE (256U)
+#endif
+
+/* Largest CMD + PAYLOAD accepted by the dispatcher; also bounds a BATCH
+ * (e.g. 32 x SET_LED = 97 bytes). The dispatcher task keeps one such
+ * payload on its stack. */
+#ifndef CMD_DISPATCH_MAX_PAYLOAD
+#define CMD_DISPATCH_MAX_PAYLOAD (128U)
+#endif
+
+/* Create the message buffers and the dispatcher task.
+ * Call from the RTOS threads section: creating kernel objects before the
+ * pre-scheduler loop in main() would leave interrupts masked.
+ */
+void cmd_dispatch_start(void);
+
+/* Queue one CMD + PAYLOAD for execution. Safe from ISR and task context and
+ * from several producers at once: ISR posts must all come from interrupts
+ * of one NVIC priority (they may not nest), task posts take a mutex.
+ * Until cmd_dispatch_start() has run, the command executes inline.
+ * Returns 0 on success, -1 if the payload is too large or the buffer is full.
+ */
+int cmd_dispatch_post(const uint8_t *payload, uint16_t len);
+
+/* Messages dropped because the buffer was full or the payload too large */
+uint32_t cmd_dispatch_dropped(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_CMD_DISPATCH_H_ */
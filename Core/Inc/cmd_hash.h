@@ -0,0 +1,30 @@
+/*
+ * cmd_hash.h
+ *
+ *  GENERATED by tools/cmdgen/gen_cmd_hash.py from cmd_list.h - do not edit.
+ *  Minimal perfect hash for console command lookup (see cmd.c).
+ *  Commands: LED_ON LED_OFF SET_LED UART_TX PWM_ON CRASH LINK_STATS
+ *    BATCH RING_STATS
+ */
+
+#ifndef INC_CMD_HASH_H_
+#define INC_CMD_HASH_H_
+
+#include <stdint.h>
+
+#define CMD_HASH_COUNT    9u
+#define CMD_HASH_SEED     0x00000001u
+#define CMD_HASH_BUCKETS  4u
+#define CMD_HASH_SLOTS    16u
+#define CMD_HASH_EMPTY    0xFFu
+
+static const uint8_t cmd_hash_disp[CMD_HASH_BUCKETS] = {
+    0x00, 0x00, 0x00, 0x04,
+};
+
+/* slot -> CMD_ID (CMD_HASH_EMPTY if unused) */
+static const uint8_t cmd_hash_slot[CMD_HASH_SLOTS] = {
+    0x07, 0x08, 0x06, 0x03, 0xFF, 0x05, 0xFF, 0x04, 0xFF, 0xFF, 0x02, 0xFF, 0xFF, 0x00, 0xFF, 0x01,
+};
+
+#endif /* INC_CMD_HASH_H_ */
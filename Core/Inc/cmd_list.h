@@ -0,0 +1,42 @@
+/*
+ * cmd_list.h
+ *
+ *  Single source of truth for the command set (X-macro schema).
+ *
+ *  X(ID, handler, console, CMD_ARGS(type name, ...))
+ *    ID       : CMD_ID enum value, binary CMD byte (in list order) and
+ *               console command name (#ID)
+ *    handler  : typed handler in cmd.c, shared by binary and console:
+ *                 int handler(const CmdArgs_<ID> *a)   (int handler(void)
+ *                 when CMD_ARGS() is empty); 0 on success, <0 failure
+ *    console  : CMD_CON_AUTO = parse the console tokens by the arg types
+ *               and call handler, or a hand-written
+ *                 void func(int para_count, char **para)
+ *    CMD_ARGS : argument layout, little-endian, in wire order
+ *                 u8 i8 u16 i16 u32 i32 : fixed-size integers
+ *                 bytes                 : rest of the payload (>= 1 byte),
+ *                                         last arg only
+ *
+ *  The schema is expanded by the C preprocessor for CMD_ID (cmd.h) and by
+ *  tools/cmdgen/gen_cmd.py for everything else. After adding/changing a
+ *  command, regenerate:
+ *    python tools/cmdgen/gen_cmd.py
+ *  which writes cmd_hash.h (console lookup), cmd_table.h (dispatch tables
+ *  and arg decoding) and tools/packet/cmd_encoder.py (host encoders).
+ */
+
+#ifndef INC_CMD_LIST_H_
+#define INC_CMD_LIST_H_
+
+#define CMD_LIST(X)                                                              \
+    X(LED_ON,     cmd_led_on,     CMD_CON_AUTO,    CMD_ARGS())                   \
+    X(LED_OFF,    cmd_led_off,    CMD_CON_AUTO,    CMD_ARGS())                   \
+    X(SET_LED,    cmd_set_led,    CMD_CON_AUTO,    CMD_ARGS(u8 led_num))         \
+    X(UART_TX,    cmd_uart_tx,    CMD_CON_AUTO,    CMD_ARGS(bytes data))         \
+    X(PWM_ON,     cmd_pwm_on,     CMD_CON_AUTO,    CMD_ARGS(u8 duty, u16 freq))  \
+    X(CRASH,      cmd_crash,      CMD_CON_AUTO,    CMD_ARGS())                   \
+    X(LINK_STATS, cmd_link_stats, func_link_stats, CMD_ARGS())                   \
+    X(BATCH,      cmd_batch,      func_batch,      CMD_ARGS(bytes cmds))         \
+    X(RING_STATS, cmd_ring_stats, func_ring_stats, CMD_ARGS(u8 reset))
+
+#endif /* INC_CMD_LIST_H_ */
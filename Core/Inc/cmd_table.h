@@ -0,0 +1,259 @@
+/*
+ * cmd_table.h
+ *
+ *  GENERATED by tools/cmdgen/gen_cmd.py from cmd_list.h - do not edit.
+ *  Included once by cmd.c: CmdArgs_* structs, argument decoding and the
+ *  console / binary dispatch tables indexed by CMD_ID.
+ *
+ *  Binary args are little-endian at fixed offsets; the length is checked
+ *  against bin_cmd_table before the decoder runs.
+ */
+
+#ifndef INC_CMD_TABLE_H_
+#define INC_CMD_TABLE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "cmd.h"
+
+_Static_assert(LED_ON == 0, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");
+_Static_assert(LED_OFF == 1, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");
+_Static_assert(SET_LED == 2, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");
+_Static_assert(UART_TX == 3, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");
+_Static_assert(PWM_ON == 4, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");
+_Static_assert(CRASH == 5, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");
+_Static_assert(LINK_STATS == 6, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");
+_Static_assert(BATCH == 7, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");
+_Static_assert(RING_STATS == 8, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");
+
+_Static_assert(INVALID_CMD == 9, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");
+
+/* ---------- argument structs ---------- */
+typedef struct
+{
+    uint8_t led_num;
+} CmdArgs_SET_LED;
+
+typedef struct
+{
+    const uint8_t *data;
+    uint16_t data_len;
+} CmdArgs_UART_TX;
+
+typedef struct
+{
+    uint8_t duty;
+    uint16_t freq;
+} CmdArgs_PWM_ON;
+
+typedef struct
+{
+    const uint8_t *cmds;
+    uint16_t cmds_len;
+} CmdArgs_BATCH;
+
+typedef struct
+{
+    uint8_t reset;
+} CmdArgs_RING_STATS;
+
+/* ---------- handlers (cmd.c) ---------- */
+static int cmd_led_on(void);
+static int cmd_led_off(void);
+static int cmd_set_led(const CmdArgs_SET_LED *a);
+static int cmd_uart_tx(const CmdArgs_UART_TX *a);
+static int cmd_pwm_on(const CmdArgs_PWM_ON *a);
+static int cmd_crash(void);
+static int cmd_link_stats(void);
+static int cmd_batch(const CmdArgs_BATCH *a);
+static int cmd_ring_stats(const CmdArgs_RING_STATS *a);
+void func_batch(int para_count, char **para);
+void func_link_stats(int para_count, char **para);
+void func_ring_stats(int para_count, char **para);
+void func_invalid(int para_count, char **para);
+
+/* ---------- binary decoders ---------- */
+static int cmd_led_on_bin(const uint8_t *args, uint16_t len)
+{
+    (void)args; (void)len;
+    return cmd_led_on();
+}
+
+static int cmd_led_off_bin(const uint8_t *args, uint16_t len)
+{
+    (void)args; (void)len;
+    return cmd_led_off();
+}
+
+static int cmd_set_led_bin(const uint8_t *args, uint16_t len)
+{
+    CmdArgs_SET_LED a;
+    (void)len;
+    a.led_num = (uint8_t)(args[0]);
+    return cmd_set_led(&a);
+}
+
+static int cmd_uart_tx_bin(const uint8_t *args, uint16_t len)
+{
+    CmdArgs_UART_TX a;
+    a.data = &args[0];
+    a.data_len = len;
+    return cmd_uart_tx(&a);
+}
+
+static int cmd_pwm_on_bin(const uint8_t *args, uint16_t len)
+{
+    CmdArgs_PWM_ON a;
+    (void)len;
+    a.duty = (uint8_t)(args[0]);
+    a.freq = (uint16_t)(args[1] | (args[2] << 8));
+    return cmd_pwm_on(&a);
+}
+
+static int cmd_crash_bin(const uint8_t *args, uint16_t len)
+{
+    (void)args; (void)len;
+    return cmd_crash();
+}
+
+static int cmd_link_stats_bin(const uint8_t *args, uint16_t len)
+{
+    (void)args; (void)len;
+    return cmd_link_stats();
+}
+
+static int cmd_batch_bin(const uint8_t *args, uint16_t len)
+{
+    CmdArgs_BATCH a;
+    a.cmds = &args[0];
+    a.cmds_len = len;
+    return cmd_batch(&a);
+}
+
+static int cmd_ring_stats_bin(const uint8_t *args, uint16_t len)
+{
+    CmdArgs_RING_STATS a;
+    (void)len;
+    a.reset = (uint8_t)(args[0]);
+    return cmd_ring_stats(&a);
+}
+
+/* ---------- console decoders ---------- */
+static void cmd_led_on_con(int para_count, char **para)
+{
+    (void)para;
+    if (para_count != 0)
+    {
+        print("error: LED_ON takes no parameters\r\n");
+        return;
+    }
+    cmd_led_on();
+}
+
+static void cmd_led_off_con(int para_count, char **para)
+{
+    (void)para;
+    if (para_count != 0)
+    {
+        print("error: LED_OFF takes no parameters\r\n");
+        return;
+    }
+    cmd_led_off();
+}
+
+static void cmd_set_led_con(int para_count, char **para)
+{
+    if (para_count != 1)
+    {
+        print("error: SET_LED takes 1 parameter\r\n");
+        return;
+    }
+    CmdArgs_SET_LED a;
+    int32_t v;
+    if (cmd_con_int(para[0], 0, 255, &v) != 0)
+    {
+        print("error: SET_LED: bad led_num '%s' (u8)\r\n", para[0]);
+        return;
+    }
+    a.led_num = (uint8_t)v;
+    cmd_set_led(&a);
+}
+
+static void cmd_uart_tx_con(int para_count, char **para)
+{
+    if (para_count != 1)
+    {
+        print("error: UART_TX takes 1 parameter\r\n");
+        return;
+    }
+    CmdArgs_UART_TX a;
+    a.data = (const uint8_t *)para[0];
+    a.data_len = (uint16_t)strlen(para[0]);
+    cmd_uart_tx(&a);
+}
+
+static void cmd_pwm_on_con(int para_count, char **para)
+{
+    if (para_count != 2)
+    {
+        print("error: PWM_ON takes 2 parameters\r\n");
+        return;
+    }
+    CmdArgs_PWM_ON a;
+    int32_t v;
+    if (cmd_con_int(para[0], 0, 255, &v) != 0)
+    {
+        print("error: PWM_ON: bad duty '%s' (u8)\r\n", para[0]);
+        return;
+    }
+    a.duty = (uint8_t)v;
+    if (cmd_con_int(para[1], 0, 65535, &v) != 0)
+    {
+        print("error: PWM_ON: bad freq '%s' (u16)\r\n", para[1]);
+        return;
+    }
+    a.freq = (uint16_t)v;
+    cmd_pwm_on(&a);
+}
+
+static void cmd_crash_con(int para_count, char **para)
+{
+    (void)para;
+    if (para_count != 0)
+    {
+        print("error: CRASH takes no parameters\r\n");
+        return;
+    }
+    cmd_crash();
+}
+
+/* ---------- tables ---------- */
+/* Console table, indexed by CMD_ID */
+static const CmdEntry cmd_table[] = {
+    {"LED_ON",     cmd_led_on_con},
+    {"LED_OFF",    cmd_led_off_con},
+    {"SET_LED",    cmd_set_led_con},
+    {"UART_TX",    cmd_uart_tx_con},
+    {"PWM_ON",     cmd_pwm_on_con},
+    {"CRASH",      cmd_crash_con},
+    {"LINK_STATS", func_link_stats},
+    {"BATCH",      func_batch},
+    {"RING_STATS", func_ring_stats},
+    {"INVALID_CMD",func_invalid},
+};
+
+/* Binary table (packet links), indexed by CMD_ID: {arg_len_min, arg_len_max, decoder} */
+static const BinCmdEntry bin_cmd_table[INVALID_CMD] = {
+    [LED_ON]     = {0, 0, cmd_led_on_bin},
+    [LED_OFF]    = {0, 0, cmd_led_off_bin},
+    [SET_LED]    = {1, 1, cmd_set_led_bin},
+    [UART_TX]    = {1, 255, cmd_uart_tx_bin},
+    [PWM_ON]     = {3, 3, cmd_pwm_on_bin},
+    [CRASH]      = {0, 0, cmd_crash_bin},
+    [LINK_STATS] = {0, 0, cmd_link_stats_bin},
+    [BATCH]      = {1, 255, cmd_batch_bin},
+    [RING_STATS] = {1, 1, cmd_ring_stats_bin},
+};
+
+#endif /* INC_CMD_TABLE_H_ */
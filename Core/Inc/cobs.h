@@ -0,0 +1,30 @@
+/*
+ * cobs.h
+ *
+ * Consistent Overhead Byte Stuffing.
+ * Encoded data contains no 0x00 bytes, so 0x00 can delimit frames on the
+ * wire. Overhead is at most 1 byte per 254 bytes of input (plus the
+ * delimiter added by the framing layer).
+ */
+
+#ifndef INC_COBS_H_
+#define INC_COBS_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define COBS_DELIMITER  0x00
+
+/* Worst-case encoded size of n input bytes (without delimiter) */
+#define COBS_MAX_ENCODED_LEN(n)  ((n) + ((n) / 254) + 1)
+
+/* Encode len bytes of src into dst (COBS_MAX_ENCODED_LEN(len) bytes).
+ * No delimiter is appended. Returns the encoded length. */
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *dst);
+
+/* Decode one frame (delimiter excluded) in a single pass.
+ * dst may equal src for in-place decoding.
+ * Returns the decoded length, or -1 if the input is not valid COBS. */
+int cobs_decode(const uint8_t *src, size_t len, uint8_t *dst);
+
+#endif /* INC_COBS_H_ */
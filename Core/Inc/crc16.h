@@ -0,0 +1,35 @@
+/*
+ * crc16.h
+ *
+ * CRC-16/CCITT-FALSE used by protocol v2 frames (see packet.h).
+ *   poly 0x1021, init 0xFFFF, no reflection, no final XOR
+ *   check value: crc16_ccitt(CRC16_CCITT_INIT, "123456789", 9) == 0x29B1
+ */
+
+#ifndef INC_CRC16_H_
+#define INC_CRC16_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define CRC16_CCITT_INIT  0xFFFFU
+
+/* Table-driven slice-by-4: four table lookups per 4 input bytes, with a
+ * byte-at-a-time tail. Tables are const (2 KB flash, no RAM).
+ *
+ * Pass CRC16_CCITT_INIT to start, or a previous result to continue a CRC
+ * across several buffers.
+ *
+ * Cost (-O2, 4 KB buffer):
+ *   host x86-64      : ~2.3 TSC cycles/byte (bitwise loop: ~26)
+ *   Cortex-M0+ (est.): ~9 cycles/byte. Per 4-byte step: 4 byte loads,
+ *                      4 halfword table loads (2 cycles each on M0+),
+ *                      index shift/mask/XOR and loop overhead, ~35 cycles.
+ *                      The bitwise loop is ~55 cycles/byte.
+ */
+uint16_t crc16_ccitt(uint16_t crc, const uint8_t *data, size_t len);
+
+/* Same CRC, copying src to dst in the same pass (packet_tx.c) */
+uint16_t crc16_ccitt_copy(uint16_t crc, uint8_t *dst, const uint8_t *src, size_t len);
+
+#endif /* INC_CRC16_H_ */
@@ -0,0 +1,114 @@
+/*
+ * frag.h
+ *
+ * Fragmentation / reassembly of bulk payloads (up to 64 KB) over packet
+ * frames, e.g. firmware chunks or captured sample blocks.
+ *
+ *  Fragment = CMD + PAYLOAD of an ordinary v1/v2 frame:
+ *
+ *      | FRAG_CMD | XFER_ID | OFF_L | OFF_H | TOTAL_L | TOTAL_H | DATA... |
+ *
+ *  OFF   : byte offset of DATA in the transfer
+ *  TOTAL : transfer size in bytes
+ *
+ *  Fragments of one transfer must arrive in order (run it over ARQ on a
+ *  lossy link); a gap, a new XFER_ID or a TOTAL change aborts the transfer.
+ *  A fragment whose bytes were all received already (a duplicate, or the
+ *  sender restarting the same XFER_ID) is ignored.
+ *
+ *  The receiver reassembles straight into a buffer taken from a caller
+ *  provided pool. A completed block is handed to the consumer, which owns
+ *  it (no copy) until it calls frag_release(); while every buffer is owned,
+ *  new transfers are dropped.
+ */
+
+#ifndef INC_FRAG_H_
+#define INC_FRAG_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Control CMD byte (outside the CMD_ID range) */
+#define FRAG_CMD         0xE0U
+#define FRAG_HDR_LEN     6U      // FRAG_CMD .. TOTAL_H
+
+#ifndef FRAG_POOL_MAX
+#define FRAG_POOL_MAX    4U      // buffers per reassembler
+#endif
+
+/* ---------- sender ---------- */
+typedef struct
+{
+    const uint8_t *data;
+    uint16_t total;
+    uint16_t off;
+    uint16_t chunk;     // DATA bytes per fragment
+    uint8_t xfer_id;
+} FragTx;
+
+/* max_payload: largest CMD + PAYLOAD one frame may carry on the link,
+ * e.g. PKT_V2_MAX_PAYLOAD_LEN or the peer parser capacity - overhead. */
+void frag_tx_init(FragTx *t, uint8_t xfer_id, const uint8_t *data, uint16_t len,
+        uint16_t max_payload);
+
+/* Write the next fragment (CMD + PAYLOAD) into payload.
+ * Returns its length, 0 when the whole transfer has been emitted. */
+uint16_t frag_tx_next(FragTx *t, uint8_t *payload);
+
+/* ---------- receiver ---------- */
+typedef enum
+{
+    FRAG_BLOCK_FREE = 0,
+    FRAG_BLOCK_FILLING,
+    FRAG_BLOCK_OWNED,       // handed to the consumer
+} FragBlockState;
+
+typedef struct
+{
+    uint8_t *data;
+    uint16_t len;
+    uint8_t xfer_id;
+    volatile uint8_t state;  // FragBlockState
+} FragBlock;
+
+/* Completed transfer; the consumer owns blk until frag_release() */
+typedef void (*FragDoneFn)(void *ctx, FragBlock *blk);
+
+typedef struct
+{
+    FragBlock blocks[FRAG_POOL_MAX];
+    uint8_t count;
+    uint16_t buf_size;
+
+    FragBlock *cur;         // transfer being reassembled
+    uint16_t total;
+
+    FragDoneFn done;
+    void *ctx;
+
+    uint32_t completed;
+    uint32_t aborted;       // gap / restart / oversize
+    uint32_t duplicates;    // fragments ignored, bytes already received
+    uint32_t no_buffer;     // transfers dropped, all buffers owned
+} FragRx;
+
+/* pool: count buffers of buf_size bytes back to back (count <= FRAG_POOL_MAX) */
+void frag_rx_init(FragRx *r, uint8_t *pool, uint16_t buf_size, uint8_t count,
+        FragDoneFn done, void *ctx);
+
+/* Feed one received CMD + PAYLOAD with payload[0] == FRAG_CMD.
+ * Returns 1 if this fragment completed a transfer, 0 if accepted,
+ * -1 if dropped. */
+int frag_rx_feed(FragRx *r, const uint8_t *payload, uint16_t len);
+
+/* Give a completed block back to the pool; safe from another task */
+void frag_release(FragRx *r, FragBlock *blk);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_FRAG_H_ */
@@ -12,6 +12,14 @@ void latency_init(TIM_HandleTypeDef *timer_handle, UART_HandleTypeDef *log_uart)
 void latency_on_tim_period_elapsed_isr(TIM_HandleTypeDef *htim);
 void latency_start_logging_task(void);
 
+/* ISR execution-time probe on the TIM3 time base.
+ * Wrap an ISR body with enter/exit; the logging task reports the probe
+ * min/max/avg as a "# isr_probe" line every stats window.
+ * Intervals longer than one TIM3 period (1 ms) alias.
+ */
+uint16_t latency_probe_enter(void);
+void latency_probe_exit(uint16_t entry_cnt);
+
 #ifdef __cplusplus
 }
 #endif
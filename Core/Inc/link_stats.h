@@ -0,0 +1,62 @@
+/*
+ * link_stats.h
+ *
+ * Per-port RX link health counters (UART1, UART3).
+ *
+ * The counters live where they are updated, as plain uint32_t increments
+ * in the feeding context (RX ISR): frame / error counts in the port's
+ * PacketParser or PacketCobsParser, overruns in its BipBuf and DMA
+ * position anomalies in main.c. link_stats_attach() tells this module
+ * where to find them; a snapshot copies them all with interrupts masked.
+ *
+ * The LINK_STATS command (binary or console) reports the snapshot of all
+ * ports: binary as one telemetry record "link_stats" (telemetry.h) with
+ * fields u1_* / u3_*, console as text.
+ */
+
+#ifndef INC_LINK_STATS_H_
+#define INC_LINK_STATS_H_
+
+#include <stdint.h>
+
+#include "packet_codec.h"
+#include "bipbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Port 0 = UART1, 1 = UART3 */
+#define LINK_STATS_PORTS  2U
+
+typedef struct
+{
+    uint32_t frames_ok;     // valid frames dispatched
+    uint32_t csum_err;      // checksum/CRC mismatch (parse_packet() -4)
+    uint32_t len_err;       // LENGTH out of range (parse_packet() -3)
+    uint32_t rb_overrun;    // bytes dropped, BipBuf full (copy path)
+    uint32_t dma_anomaly;   // RX event ignored (position out of range), RX restarts
+    uint32_t resync;        // rejected frames rescanned (PacketParser)
+    uint32_t dropped_bytes; // bytes discarded while rescanning
+} LinkStats;
+
+/* Register the counter sources of a port; any pointer may be NULL */
+void link_stats_attach(uint8_t port, const PacketParser *parser,
+        const PacketCobsParser *cobs, const BipBuf *bip,
+        const volatile uint32_t *dma_anomaly);
+
+/* Copy the counters of every port into out[LINK_STATS_PORTS] */
+void link_stats_snapshot(LinkStats *out);
+
+/* Register the "link_stats" record type; call once after telemetry_init() */
+void link_stats_telemetry_init(void);
+
+/* Send the snapshot as one "link_stats" telemetry record.
+ * Returns telemetry_send() result. */
+int link_stats_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_LINK_STATS_H_ */
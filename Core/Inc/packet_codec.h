@@ -0,0 +1,339 @@
+/*
+ * packet_codec.h
+ *
+ * Packet codec: frame build / validate, streaming and COBS parsers.
+ * No HAL dependency, so the same sources build for the host
+ * (tools/packet/host); the UART glue is in packet.h.
+ */
+
+#ifndef INC_PACKET_CODEC_H_
+#define INC_PACKET_CODEC_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include "cmd.h"     // include CMD_ID
+#include "cobs.h"    // COBS_MAX_ENCODED_LEN
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ============================================================
+ * Packet Format Definition
+ * ============================================================
+ *
+ *  Packet Layout (Byte Stream):
+ *
+ *      +--------+--------+--------+-------------+----------+
+ *      | HEADER | LENGTH |  CMD   |   PAYLOAD   | CHECKSUM |
+ *      +--------+--------+--------+-------------+----------+
+ *        1 byte   1 byte   1 byte    N bytes       1 byte
+ *
+ *  ------------------------------------------------------------
+ *  FIELD DESCRIPTION
+ *  ------------------------------------------------------------
+ *
+ *  HEADER   :
+ *      Fixed packet start byte.
+ *      Used to indicate the beginning of a packet.
+ *
+ *      Value:
+ *          CMD_HEADER (0xAA)
+ *
+ *  LENGTH   :
+ *      Payload length in bytes.
+ *      This length includes:
+ *          - CMD field (1 byte)
+ *          - PAYLOAD field (N bytes)
+ *
+ *      Example:
+ *          LENGTH = 0x03
+ *          => CMD (1) + PAYLOAD (2)
+ *
+ *  CMD      :
+ *      Command ID.
+ *      Identifies the operation or message type.
+ *
+ *  PAYLOAD  :
+ *      Optional command parameters.
+ *      Size = LENGTH - 1 bytes.
+ *
+ *  CHECKSUM :
+ *      8-bit checksum for packet validation.
+ *      Calculated as the sum of all bytes except checksum itself:
+ *
+ *          CHECKSUM =
+ *              HEADER +
+ *              LENGTH +
+ *              CMD +
+ *              PAYLOAD bytes
+ *
+ *      Only the lowest 8 bits are kept.
+ *
+ *  ------------------------------------------------------------
+ *  PACKET LENGTH
+ *  ------------------------------------------------------------
+ *
+ *      Total Packet Length =
+ *          HEADER (1) +
+ *          LENGTH (1) +
+ *          PAYLOAD (LENGTH bytes) +
+ *          CHECKSUM (1)
+ *
+ *      => TOTAL = LENGTH + 3 bytes
+ *
+ *  ------------------------------------------------------------
+ *  EXAMPLE PACKET
+ *  ------------------------------------------------------------
+ *
+ *      CMD_HEADER = 0xAA
+ *      CMD        = 0x01
+ *      PAYLOAD    = { 0x10, 0x20 }
+ *
+ *      LENGTH  = 1 (CMD) + 2 (PAYLOAD) = 0x03
+ *
+ *      CHECKSUM = 0xAA + 0x03 + 0x01 + 0x10 + 0x20 = 0xDE
+ *
+ *      Byte Stream:
+ *          AA 03 01 10 20 DE
+ *
+ * ============================================================
+ */
+
+/* ============================================================
+ * Packet Format v2
+ * ============================================================
+ *
+ *  Selected by its own header byte, so v1 and v2 frames can be
+ *  mixed on one link and share the same streaming parser.
+ *
+ *      +--------+-------+-------+-----+-----+---------+-------+-------+
+ *      | HEADER | LEN_L | LEN_H | SEQ | CMD | PAYLOAD | CRC_L | CRC_H |
+ *      +--------+-------+-------+-----+-----+---------+-------+-------+
+ *        1 byte  1 byte  1 byte  1 b   1 b   N bytes   1 byte  1 byte
+ *
+ *  HEADER   : CMD_HEADER_V2 (0xA5)
+ *  LEN      : 16-bit little-endian, CMD (1) + PAYLOAD (N), like v1 LENGTH
+ *  SEQ      : 8-bit sequence number, chosen by the sender
+ *  CRC      : CRC-16/CCITT-FALSE (crc16.h) over HEADER .. PAYLOAD,
+ *             little-endian
+ *
+ *      => TOTAL = LEN + 6 bytes
+ *
+ *  EXAMPLE (SEQ = 0x07, CMD = 0x01, PAYLOAD = { 0x10, 0x20 }):
+ *
+ *      A5 03 00 07 01 10 20 <CRC_L> <CRC_H>
+ *
+ * ============================================================
+ */
+
+/* ===== Protocol define ===== */
+#define CMD_HEADER     0xAA
+#define CMD_HEADER_V2  0xA5
+
+/* Framing bytes around CMD + PAYLOAD */
+#define PKT_V1_OVERHEAD  3   // HEADER, LENGTH, CHECKSUM
+#define PKT_V2_OVERHEAD  6   // HEADER, LEN_L, LEN_H, SEQ, CRC_L, CRC_H
+
+/* ===== Packet API ===== */
+void print_packet(uint8_t *buf, uint16_t len, const char *msg);
+
+uint8_t build_packet(uint8_t *buf, CMD_ID cmd_enum, uint8_t *params, uint8_t param_len);
+
+/* v2 frame into buf (needs param_len + 1 + PKT_V2_OVERHEAD bytes) */
+uint16_t build_packet_v2(uint8_t *buf, uint8_t seq, CMD_ID cmd_enum,
+        const uint8_t *params, uint16_t param_len);
+
+/* Validate a complete v1 or v2 frame (version chosen by buf[0]).
+ * Returns 0 if valid, -1 too short, -2 bad header, -3 length mismatch,
+ * -4 checksum/CRC mismatch. */
+int parse_packet(uint8_t *buf, uint16_t len);
+
+/* ===== Frame delivery ===== */
+
+/* A validated frame handed to the receiver */
+typedef struct
+{
+    uint8_t version;        // 1 or 2
+    uint8_t seq;            // v2 SEQ (0 for v1)
+    uint8_t *payload;       // CMD + PAYLOAD, into the parser buffer or the fed data
+    uint16_t len;           // CMD + PAYLOAD length
+} PacketFrame;
+
+/* Called for every valid frame, in the context that fed the parser.
+ * frame->payload is only valid during the call. */
+typedef void (*PacketFrameHandler)(void *ctx, const PacketFrame *frame);
+
+/* Handler of parsers without packet_*_set_handler(); provided by the
+ * application, not by the codec (packet.c: handle_binary_cmd()) */
+void packet_default_handler(void *ctx, const PacketFrame *frame);
+
+/* ===== Streaming parser ===== */
+/* Default frame capacity (packet_parser_init()) */
+#define PKT_PARSER_BUF_SIZE  64
+/* Largest LENGTH field the default parser can hold, per format */
+#define PKT_MAX_PAYLOAD_LEN     (PKT_PARSER_BUF_SIZE - PKT_V1_OVERHEAD)
+#define PKT_V2_MAX_PAYLOAD_LEN  (PKT_PARSER_BUF_SIZE - PKT_V2_OVERHEAD)
+
+/* Frame capacity needed for a given CMD + PAYLOAD length */
+#define PKT_V1_FRAME_SIZE(payload_len)  ((payload_len) + PKT_V1_OVERHEAD)
+#define PKT_V2_FRAME_SIZE(payload_len)  ((payload_len) + PKT_V2_OVERHEAD)
+
+typedef enum
+{
+    PKT_WAIT_HEADER,
+    PKT_WAIT_LEN,
+    PKT_WAIT_LEN_HI,    // v2 only
+    PKT_WAIT_SEQ,       // v2 only
+    PKT_WAIT_PAYLOAD,
+    PKT_WAIT_CSUM       // v1: CHECKSUM, v2: CRC_L + CRC_H
+} pkt_state_t;
+
+typedef struct
+{
+    pkt_state_t state;
+    uint8_t *buf;       // frame buffer: buf_default or caller storage
+    uint16_t cap;       // frames longer than cap are rejected as -3
+    uint16_t idx;
+    uint16_t payload_len;
+    uint8_t version;    // 1 or 2, from the header byte of the current frame
+    uint8_t seq;        // v2 SEQ of the current frame
+
+    PacketFrameHandler handler;     // default: packet_default_handler()
+    void *handler_ctx;
+
+    /* Resync mode: after a checksum/length error, rescan the buffered bytes
+     * for the next CMD_HEADER instead of discarding them all. */
+    uint8_t resync;
+    uint32_t resync_count;      // rejected frames that triggered a rescan
+    uint32_t dropped_bytes;     // bytes discarded while rescanning
+    uint32_t recovered_frames;  // valid frames found inside rejected bytes
+
+    /* In-place mode (default on): packet_parser_feed_buf() / _feed_dma()
+     * hand a frame that lies whole inside the fed chunk to the handler
+     * straight from the input, without copying it into buf. */
+    uint8_t inplace;
+    uint32_t inplace_frames;    // frames dispatched without the copy
+
+    /* Link health (link_stats.h); written only by the feeding context */
+    uint32_t frames_ok;         // frames dispatched
+    uint32_t csum_err;          // parse_packet() -4
+    uint32_t len_err;           // LENGTH out of range / parse_packet() -3
+
+    uint8_t buf_default[PKT_PARSER_BUF_SIZE];
+} PacketParser;
+
+/* Parser with the default PKT_PARSER_BUF_SIZE frame capacity */
+void packet_parser_init(PacketParser *p);
+/* Parser with caller-provided frame storage of cap bytes, e.g.
+ * PKT_V2_FRAME_SIZE(1024) for large frames; buf must outlive the parser. */
+void packet_parser_init_buf(PacketParser *p, uint8_t *buf, uint16_t cap);
+void packet_parser_set_resync(PacketParser *p, uint8_t enable);
+void packet_parser_set_inplace(PacketParser *p, uint8_t enable);
+void packet_parser_set_handler(PacketParser *p, PacketFrameHandler handler, void *ctx);
+void packet_parser_feed(PacketParser *p, uint8_t byte);
+
+/* Feed a contiguous chunk of received bytes.
+ * Same state machine as packet_parser_feed(), but the header search uses
+ * pkt_find_header() and payload runs are copied with a single memcpy().
+ * In-place mode: a frame complete in data is not copied, the handler's
+ * frame->payload points into data (valid during the call only, as always).
+ * Returns the number of valid frames completed (and dispatched) in this call.
+ */
+uint16_t packet_parser_feed_buf(PacketParser *p, const uint8_t *data, size_t len);
+
+/* Zero-copy feed straight from a circular DMA RX buffer.
+ * New data is [last_pos, cur_pos) of dma_buf, seen as up to two contiguous
+ * segments when the DMA write position has wrapped past the end. A frame
+ * that straddles the wrap point is completed across both segments.
+ * Positions equal to buf_size are treated as 0.
+ * Returns the number of valid frames completed.
+ */
+uint16_t packet_parser_feed_dma(PacketParser *p, const uint8_t *dma_buf,
+        uint16_t buf_size, uint16_t last_pos, uint16_t cur_pos);
+
+/* ===== COBS framing =====
+ *
+ *  Alternative link framing: a complete v1 or v2 frame is COBS encoded
+ *  (cobs.h) and terminated by a 0x00 delimiter.
+ *
+ *      | COBS( HEADER ... CHECKSUM/CRC ) | 0x00 |
+ *
+ *  The receiver splits frames with memchr() on the delimiter, so after
+ *  corruption it resynchronizes at the next 0x00 without rescanning.
+ *  Each frame is decoded in place in one pass and then validated with
+ *  parse_packet() as usual.
+ */
+#define PKT_COBS_BUF_SIZE  COBS_MAX_ENCODED_LEN(PKT_PARSER_BUF_SIZE)
+
+typedef struct
+{
+    uint8_t buf[PKT_COBS_BUF_SIZE];     // encoded bytes of the current frame
+    uint16_t idx;
+    uint8_t overflow;                   // frame too long, skip to delimiter
+    PacketFrameHandler handler;         // default: packet_default_handler()
+    void *handler_ctx;
+
+    uint32_t frames_ok;                 // frames dispatched
+    uint32_t csum_err;                  // bad checksum/CRC/header, undecodable COBS
+    uint32_t len_err;                   // parse_packet() -3, frame too long
+} PacketCobsParser;
+
+/* Encode frame[0..len) into out (COBS_MAX_ENCODED_LEN(len) + 1 bytes),
+ * delimiter included. Returns the number of bytes to transmit. */
+uint16_t packet_cobs_encode(uint8_t *out, const uint8_t *frame, uint16_t len);
+
+void packet_cobs_init(PacketCobsParser *c);
+void packet_cobs_set_handler(PacketCobsParser *c, PacketFrameHandler handler, void *ctx);
+
+/* Same contracts as packet_parser_feed_buf() / packet_parser_feed_dma() */
+uint16_t packet_cobs_feed_buf(PacketCobsParser *c, const uint8_t *data, size_t len);
+uint16_t packet_cobs_feed_dma(PacketCobsParser *c, const uint8_t *dma_buf,
+        uint16_t buf_size, uint16_t last_pos, uint16_t cur_pos);
+
+/* ===== Command batch =====
+ *
+ *  Arguments of a batch command (the BATCH CMD byte itself excluded):
+ *  several sub-commands, each prefixed with its CMD + ARGS length.
+ *
+ *      | LEN1 | CMD1 | ARGS1... | LEN2 | CMD2 | ARGS2... | ...
+ *
+ *  LENn is 1..255. The whole batch shares the one frame header and
+ *  checksum/CRC, and is dispatched as a single message.
+ *
+ *  packet_batch_run() first walks the length chain and calls check() on
+ *  every sub-command; if anything is wrong nothing is executed. Only then
+ *  is exec() called for each sub-command in order. A failing exec() does
+ *  not stop the batch; the outcome is summarized in PacketBatchStatus.
+ */
+#define PKT_BATCH_MAX_CMDS  32U     // fail_mask has one bit per sub-command
+
+/* Check or execute one sub-command (CMD + ARGS); 0 = ok, <0 = error code */
+typedef int (*PacketBatchFn)(void *ctx, const uint8_t *cmd, uint16_t len);
+
+typedef struct
+{
+    uint32_t fail_mask;     // bit n: sub-command n rejected / failed
+    uint8_t count;          // sub-commands in the batch (0 if malformed)
+    uint8_t ok;             // sub-commands executed successfully
+    uint8_t first_fail;     // index of the first failure, 0xFF if none
+    int8_t first_err;       // its check()/exec() error code
+} PacketBatchStatus;
+
+/* Append one sub-command at buf[pos]; the batch lives in buf[0..cap).
+ * Returns the new batch length, or 0 if it does not fit. */
+uint16_t packet_batch_append(uint8_t *buf, uint16_t cap, uint16_t pos,
+        uint8_t cmd, const uint8_t *args, uint8_t args_len);
+
+/* Validate then execute a batch (see above). st may be NULL.
+ * Returns 0 all executed ok, -1 malformed length chain or more than
+ * PKT_BATCH_MAX_CMDS sub-commands, -2 check() rejected a sub-command
+ * (nothing executed), -3 at least one exec() failed. */
+int packet_batch_run(const uint8_t *data, uint16_t len, PacketBatchFn check,
+        PacketBatchFn exec, void *ctx, PacketBatchStatus *st);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_PACKET_CODEC_H_ */
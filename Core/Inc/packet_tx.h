@@ -0,0 +1,82 @@
+/*
+ * packet_tx.h
+ *
+ * Asynchronous packet transmit through a TX DMA ring.
+ *
+ *  packet_tx_send_v1/v2() build a frame straight into the ring from a list
+ *  of payload segments (iovec style): header, CMD and segments are written
+ *  once, and the checksum/CRC is computed in the same pass as the copy.
+ *  The frame is then committed and sent by DMA (UART TX DMA in normal
+ *  mode); HAL_UART_TxCpltCallback() -> packet_tx_on_tx_complete() starts
+ *  the next chunk, so the caller never waits on the UART.
+ *
+ *  A frame may wrap around the end of the ring; it then goes out as two
+ *  DMA transfers back to back.
+ *
+ *  One producer per PacketTx (task or ISR); the DMA side runs in the
+ *  UART TX complete interrupt.
+ */
+
+#ifndef INC_PACKET_TX_H_
+#define INC_PACKET_TX_H_
+
+#include <stdint.h>
+
+#include "main.h"
+#include "cmd.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Ports with a registered PacketTx (UART1, UART3) */
+#ifndef PKT_TX_MAX_PORTS
+#define PKT_TX_MAX_PORTS  2U
+#endif
+
+/* One payload segment */
+typedef struct
+{
+    const void *base;
+    uint16_t len;
+} PktIoVec;
+
+typedef struct
+{
+    UART_HandleTypeDef *huart;
+    uint8_t *ring;
+    uint16_t size;
+
+    volatile uint16_t head;     // producer: end of committed frames
+    volatile uint16_t tail;     // DMA: start of unsent bytes
+    volatile uint16_t dma_len;  // bytes in the running transfer, 0 = idle
+
+    uint32_t frames;            // frames committed
+    uint32_t bytes;             // bytes committed
+    uint32_t full;              // frames rejected, ring full
+    uint32_t dma_errors;        // HAL_UART_Transmit_DMA() refused
+} PacketTx;
+
+/* ring: size bytes of DMA-reachable RAM (size-1 usable).
+ * Registers tx for packet_tx_on_tx_complete(). */
+void packet_tx_init(PacketTx *tx, UART_HandleTypeDef *huart, uint8_t *ring, uint16_t size);
+
+/* Build and queue HEADER | LENGTH | CMD | segments... | CHECKSUM.
+ * Returns frame length, -1 ring full, -2 payload too long. */
+int packet_tx_send_v1(PacketTx *tx, CMD_ID cmd, const PktIoVec *iov, uint8_t iovcnt);
+
+/* Build and queue HEADER | LEN16 | SEQ | CMD | segments... | CRC16.
+ * Returns frame length, -1 ring full, -2 payload too long. */
+int packet_tx_send_v2(PacketTx *tx, uint8_t seq, CMD_ID cmd, const PktIoVec *iov, uint8_t iovcnt);
+
+/* Bytes committed but not yet sent (including the running transfer) */
+uint16_t packet_tx_pending(const PacketTx *tx);
+
+/* Call from HAL_UART_TxCpltCallback() */
+void packet_tx_on_tx_complete(UART_HandleTypeDef *huart);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_PACKET_TX_H_ */
@@ -0,0 +1,62 @@
+/*
+ * pkt_scan.h
+ *
+ * Byte-scan kernels of the packet codec: header search (PKT_WAIT_HEADER,
+ * resync) and the v1 8-bit sum checksum (build_packet / parse_packet).
+ *
+ * Two implementations of each, both always compiled so the host bench can
+ * compare them (tools/packet/host/scan_bench.cpp):
+ *   _scalar : byte at a time (header search: memchr() per header value)
+ *   _swar   : 32-bit word at a time (SIMD within a register). Unaligned
+ *             head bytes are handled one at a time until the pointer is
+ *             word aligned (Cortex-M0+ has no unaligned loads), then whole
+ *             words, then the tail bytes.
+ * pkt_find_header() / pkt_sum8() are the ones the codec uses.
+ */
+
+#ifndef INC_PKT_SCAN_H_
+#define INC_PKT_SCAN_H_
+
+#include <stdint.h>
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 1: word-at-a-time kernels, 0: scalar fallback */
+#ifndef PKT_USE_SWAR
+#define PKT_USE_SWAR 1
+#endif
+
+/* First byte equal to a or b in data[0..len), NULL if none.
+ *
+ * SWAR: per word, XOR with the byte broadcast turns matches into zero
+ * bytes; (x - 0x01010101) & ~x & 0x80808080 is non-zero iff x has a zero
+ * byte. Both values are tested in one pass and only a word with a hit is
+ * searched byte by byte (ARMv6-M has no CLZ/CTZ).
+ * Cortex-M0+ (est.): ~4 cycles/byte of junk, vs ~7 per value for a byte
+ * loop (newlib-nano memchr()), i.e. ~14 for the two-value scalar search. */
+const uint8_t *pkt_find2_scalar(const uint8_t *data, size_t len, uint8_t a, uint8_t b);
+const uint8_t *pkt_find2_swar(const uint8_t *data, size_t len, uint8_t a, uint8_t b);
+
+/* (init + sum of data[0..len)) & 0xFF
+ *
+ * SWAR: bytes 0/2 and 1/3 of each word are masked into 16-bit lanes and
+ * accumulated (at most 128 words per block so a lane cannot carry into the
+ * next), then the lanes are folded to 8 bits.
+ * Cortex-M0+ (est.): ~3.5 cycles/byte vs ~7 for the byte loop. */
+uint8_t pkt_sum8_scalar(uint8_t init, const uint8_t *data, size_t len);
+uint8_t pkt_sum8_swar(uint8_t init, const uint8_t *data, size_t len);
+
+/* First v1 (CMD_HEADER) or v2 (CMD_HEADER_V2) header byte, NULL if none */
+const uint8_t *pkt_find_header(const uint8_t *data, size_t len);
+
+/* v1 checksum with the kernel selected by PKT_USE_SWAR */
+uint8_t pkt_sum8(uint8_t init, const uint8_t *data, size_t len);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_PKT_SCAN_H_ */
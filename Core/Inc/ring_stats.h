@@ -0,0 +1,72 @@
+/*
+ * ring_stats.h
+ *
+ * Fill level statistics of the firmware's ring buffers, for sizing
+ * UART_RX_BIP_SIZE, LATENCY_RING_SIZE and RX_BUF_SIZE from real traffic.
+ *
+ * The numbers live in each ring (SpscRing.stats, BipBuf.stats,
+ * UartRxPort.dma_stats, see spsc_ring.h) and are updated by the ring's
+ * own producer / consumer; ring_stats_attach*() registers a ring under a
+ * name, a snapshot copies them all with interrupts masked.
+ *
+ * The RING_STATS command (binary or console) reports every registered
+ * ring: binary as one telemetry record "ring_stats" per ring (telemetry.h),
+ * console as text. With reset != 0 the high watermarks, overflow counts
+ * and histograms are cleared after the report; dropped is cumulative
+ * (it is also LINK_STATS rb_overrun).
+ */
+
+#ifndef INC_RING_STATS_H_
+#define INC_RING_STATS_H_
+
+#include <stdint.h>
+
+#include "bipbuf.h"
+#include "spsc_ring.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define RING_STATS_MAX  6U
+
+typedef struct
+{
+    const char *name;
+    uint16_t size;          // capacity in elements
+    uint16_t used;          // fill level at the snapshot
+    uint16_t high_water;
+    uint32_t overflows;     // pushes that found the ring full
+    uint32_t dropped;       // elements lost (SpscRing, BipBuf)
+    uint32_t hist[SPSC_RING_HIST_BINS];     // drains per fill level eighth
+} RingStats;
+
+/* Register an SpscRing (its embedded stats). Returns the ring index,
+ * -1 registry full. */
+int ring_stats_attach_spsc(const char *name, SpscRing *ring);
+
+/* Register a BipBuf (its embedded stats) */
+int ring_stats_attach_bip(const char *name, BipBuf *bip);
+
+/* Register a buffer that only has SpscRingStats (e.g. a DMA RX buffer) */
+int ring_stats_attach(const char *name, uint16_t size, SpscRingStats *stats);
+
+/* Copy the stats of every registered ring into out[RING_STATS_MAX].
+ * Returns the number of rings. */
+uint8_t ring_stats_snapshot(RingStats *out);
+
+/* Clear high watermarks, overflow counts and histograms */
+void ring_stats_reset(void);
+
+/* Register the "ring_stats" record type; call once after telemetry_init() */
+void ring_stats_telemetry_init(void);
+
+/* Send one "ring_stats" telemetry record per ring.
+ * Returns 0, or the first failing telemetry_send() result. */
+int ring_stats_report(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_RING_STATS_H_ */
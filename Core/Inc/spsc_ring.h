@@ -0,0 +1,352 @@
+/*
+ * spsc_ring.h
+ *
+ * Single-producer / single-consumer ring of fixed-size elements, one
+ * typed instance per SPSC_RING_DEFINE(). Used by the latency sample ring
+ * (latency.c) and the byte rings of uart_rb.h, which only the uart_test.c
+ * loopback still uses; the UART RX path runs on bipbuf.h, which shares the
+ * SPSC_LOAD_ACQ / SPSC_STORE_REL barriers and the occupancy stats below.
+ *
+ * One context pushes (typically an ISR), one context pops (task / main
+ * loop); neither side takes a lock or masks interrupts. Storage is
+ * supplied by the caller, the element count must be a power of two
+ * (index & mask) and at most SPSC_RING_MAX. Indices run freely over
+ * uint32_t.
+ *
+ * Full-ring policy, per instance:
+ *   SPSC_RING_REJECT_NEWEST  push stores what fits, the rest is dropped;
+ *                            unread elements are never touched.
+ *   SPSC_RING_DROP_OLDEST    push always stores and overwrites the oldest
+ *                            unread elements. The producer never reads
+ *                            tail: the consumer detects that it was
+ *                            lapped, and discards any element the producer
+ *                            may have rewritten while it was being copied
+ *                            (checked against `claim` after the copy).
+ * dropped counts lost elements: on the producer side for REJECT_NEWEST,
+ * on the consumer side (when it notices) for DROP_OLDEST.
+ *
+ * Occupancy stats (SPSC_RING_STATS): the producer keeps the high
+ * watermark and counts pushes that found the ring full (overflows); the
+ * consumer calls prefix_sample() once per drain pass to add the current
+ * fill level to a histogram of SPSC_RING_HIST_BINS bins (eighths of the
+ * size). ring_stats.h collects them for the RING_STATS command.
+ *
+ *   SPSC_RING_DEFINE(SampleRing, sample_ring, Sample)
+ *
+ *   static Sample slots[64];
+ *   static SampleRing ring;
+ *   sample_ring_init(&ring, slots, 64, SPSC_RING_DROP_OLDEST);
+ *   sample_ring_push(&ring, &s);                    // ISR
+ *   n = sample_ring_read(&ring, batch, 8);          // task, batched pop
+ */
+
+#ifndef INC_SPSC_RING_H_
+#define INC_SPSC_RING_H_
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>   // memcpy, memmove
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define SPSC_RING_REJECT_NEWEST  0U
+#define SPSC_RING_DROP_OLDEST    1U
+
+#define SPSC_RING_MAX  0x8000U
+
+/* 1: occupancy stats in every ring (40 bytes each). 0: compiled out,
+ * prefix_sample() is a no-op. */
+#ifndef SPSC_RING_STATS
+#define SPSC_RING_STATS 1
+#endif
+
+#define SPSC_RING_HIST_BINS  8U
+
+/* Index handoff: acquire load of the other side's index before touching
+ * the slots, release store of our own index after. GCC emits a DMB on
+ * Cortex-M0+; on a single core a compiler barrier would be enough, the
+ * DMB also covers other bus masters. */
+#define SPSC_LOAD_ACQ(p)      __atomic_load_n((p), __ATOMIC_ACQUIRE)
+#define SPSC_STORE_REL(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELEASE)
+#define SPSC_LOAD_OWN(p)      __atomic_load_n((p), __ATOMIC_RELAXED)
+#define SPSC_STORE_OWN(p, v)  __atomic_store_n((p), (v), __ATOMIC_RELAXED)
+
+/* Fill level statistics of a ring-shaped buffer. Also used for buffers
+ * that are not an SpscRing (the UART DMA RX buffers, uart_rx.h). */
+typedef struct
+{
+    uint16_t high_water;    // most elements unread at once (producer)
+    uint8_t hist_shift;     // log2(size): fill level -> bin
+    uint32_t overflows;     // pushes that found the buffer full (producer)
+    uint32_t hist[SPSC_RING_HIST_BINS];     // fill level at each drain (consumer)
+} SpscRingStats;
+
+static inline void spsc_stats_init(SpscRingStats *s, uint16_t size)
+{
+    uint8_t log2 = 0;
+    while ((2UL << log2) <= size)
+        log2++;
+    memset(s, 0, sizeof(*s));
+    s->hist_shift = log2;
+}
+
+/* Producer: used = elements unread once this push completes, before any
+ * are refused or overwritten */
+static inline void spsc_stats_put(SpscRingStats *s, uint32_t used, uint16_t size)
+{
+    if (used > size)
+    {
+        s->overflows++;
+        used = size;
+    }
+    if (used > s->high_water)
+        s->high_water = (uint16_t)used;
+}
+
+/* Consumer: one histogram sample per drain pass. Bin = used * 8 / size,
+ * without a divide (none on Cortex-M0+); full lands in the last bin. */
+static inline void spsc_stats_sample(SpscRingStats *s, uint32_t used)
+{
+    uint32_t bin = (used << 3) >> s->hist_shift;
+    if (bin >= SPSC_RING_HIST_BINS)
+        bin = SPSC_RING_HIST_BINS - 1U;
+    s->hist[bin]++;
+}
+
+typedef struct
+{
+    uint16_t size;      // element count, power of two
+    uint16_t mask;      // size - 1
+    uint8_t policy;     // SPSC_RING_REJECT_NEWEST / SPSC_RING_DROP_OLDEST
+    uint32_t head;      // written by the producer only
+    uint32_t claim;     // DROP_OLDEST: head + elements being written
+    uint32_t tail;      // written by the consumer only
+    uint32_t dropped;   // elements lost, see policy above
+#if (SPSC_RING_STATS != 0)
+    SpscRingStats stats;
+#endif
+} SpscRing;
+
+/* Returns 0, or -1 if size is not a power of two in 1..SPSC_RING_MAX */
+static inline int spsc_ring_init(SpscRing *r, uint16_t size, uint8_t policy)
+{
+    memset(r, 0, sizeof(*r));
+    if ((size == 0U) || (size > SPSC_RING_MAX) || ((size & (size - 1U)) != 0U))
+        return -1;
+    r->size = size;
+    r->mask = (uint16_t)(size - 1U);
+    r->policy = policy;
+#if (SPSC_RING_STATS != 0)
+    spsc_stats_init(&r->stats, size);
+#endif
+    return 0;
+}
+
+/* Elements available to the consumer (at most size) */
+static inline uint16_t spsc_ring_used(const SpscRing *r)
+{
+    uint32_t used = SPSC_LOAD_ACQ(&r->head) - SPSC_LOAD_OWN(&r->tail);
+    return (uint16_t)((used < r->size) ? used : r->size);
+}
+
+/* Room for the producer; DROP_OLDEST never runs out of room */
+static inline uint16_t spsc_ring_free(const SpscRing *r)
+{
+    if (r->policy == SPSC_RING_DROP_OLDEST)
+        return r->size;
+    return (uint16_t)(r->size - (SPSC_LOAD_OWN(&r->head) - SPSC_LOAD_ACQ(&r->tail)));
+}
+
+/* Consumer: add the current fill level to the histogram */
+static inline void spsc_ring_sample(SpscRing *r)
+{
+#if (SPSC_RING_STATS != 0)
+    spsc_stats_sample(&r->stats, spsc_ring_used(r));
+#else
+    (void)r;
+#endif
+}
+
+/* Copy n elements between slot index pos and a linear buffer, in at most
+ * two segments. to_ring selects the direction. A single element is a
+ * constant-size copy (inlined loads/stores, no memcpy call): the ISR push. */
+static inline void spsc_ring_copy(const SpscRing *r, uint8_t *slots, size_t esz,
+        uint32_t pos, uint8_t *lin, uint16_t n, int to_ring)
+{
+    uint16_t at = (uint16_t)(pos & r->mask);
+    uint8_t *slot = &slots[at * esz];
+
+    if (n == 1U)
+    {
+        if (to_ring)
+            memcpy(slot, lin, esz);
+        else
+            memcpy(lin, slot, esz);
+        return;
+    }
+
+    uint16_t first = (uint16_t)(r->size - at);
+    if (first > n)
+        first = n;
+
+    if (to_ring)
+        memcpy(slot, lin, first * esz);
+    else
+        memcpy(lin, slot, first * esz);
+    if (first == n)
+        return;
+
+    if (to_ring)
+        memcpy(slots, &lin[first * esz], (size_t)(n - first) * esz);
+    else
+        memcpy(&lin[first * esz], slots, (size_t)(n - first) * esz);
+}
+
+/* Producer: push n elements of esz bytes, returns the count stored.
+ * DROP_OLDEST stores all n (only the last size of them if n > size). */
+static inline uint16_t spsc_ring_put(SpscRing *r, void *slots, size_t esz,
+        const void *src, uint16_t n)
+{
+    uint32_t head = SPSC_LOAD_OWN(&r->head);
+    const uint8_t *in = (const uint8_t *)src;
+
+    if (r->policy == SPSC_RING_DROP_OLDEST)
+    {
+        uint16_t skip = (n > r->size) ? (uint16_t)(n - r->size) : 0U;
+
+#if (SPSC_RING_STATS != 0)
+        spsc_stats_put(&r->stats, head + n - SPSC_LOAD_OWN(&r->tail), r->size);
+#endif
+        // Announce the overwrite before any slot changes
+        SPSC_STORE_OWN(&r->claim, head + n);
+        __atomic_thread_fence(__ATOMIC_RELEASE);
+        spsc_ring_copy(r, (uint8_t *)slots, esz, head + skip, (uint8_t *)&in[skip * esz],
+                (uint16_t)(n - skip), 1);
+        SPSC_STORE_REL(&r->head, head + n);
+        return n;
+    }
+
+    uint16_t room = (uint16_t)(r->size - (head - SPSC_LOAD_ACQ(&r->tail)));
+    uint16_t k = (n < room) ? n : room;
+#if (SPSC_RING_STATS != 0)
+    spsc_stats_put(&r->stats, (uint32_t)(r->size - room) + n, r->size);
+#endif
+    if (k < n)
+        r->dropped += (uint32_t)(n - k);
+    if (k == 0U)
+        return 0;
+
+    spsc_ring_copy(r, (uint8_t *)slots, esz, head, (uint8_t *)in, k, 1);
+    SPSC_STORE_REL(&r->head, head + k);
+    return k;
+}
+
+/* Consumer: pop up to max elements into out, returns the count read */
+static inline uint16_t spsc_ring_get(SpscRing *r, void *slots, size_t esz,
+        void *out, uint16_t max)
+{
+    uint32_t tail = SPSC_LOAD_OWN(&r->tail);
+    uint32_t head = SPSC_LOAD_ACQ(&r->head);
+    uint32_t lost = 0;
+    uint8_t *o = (uint8_t *)out;
+
+    if ((r->policy == SPSC_RING_DROP_OLDEST) && (head - tail > r->size))
+    {
+        // Lapped: everything older than the last size elements is gone
+        lost = head - tail - r->size;
+        tail = head - r->size;
+    }
+
+    uint32_t avail = head - tail;
+    uint16_t n = (avail < max) ? (uint16_t)avail : max;
+    if (n != 0U)
+        spsc_ring_copy(r, (uint8_t *)slots, esz, tail, o, n, 0);
+
+    if ((r->policy == SPSC_RING_DROP_OLDEST) && (n != 0U))
+    {
+        // Slot of index i is reused by index i + size: any i below
+        // claim - size may have been rewritten during the copy
+        __atomic_thread_fence(__ATOMIC_ACQUIRE);
+        int32_t bad = (int32_t)(SPSC_LOAD_OWN(&r->claim) - r->size - tail);
+        if (bad > 0)
+        {
+            uint16_t b = (bad < (int32_t)n) ? (uint16_t)bad : n;
+            memmove(o, &o[b * esz], (size_t)(n - b) * esz);
+            n = (uint16_t)(n - b);
+            tail += b;
+            lost += b;
+        }
+    }
+
+    if (lost != 0U)
+        r->dropped += lost;
+    SPSC_STORE_REL(&r->tail, tail + n);
+    return n;
+}
+
+/* Typed ring `type_name` of `elem_type`, functions prefixed with `prefix`:
+ *   prefix_init(q, slots, count, policy)   0 / -1
+ *   prefix_push(q, &elem)                  1 stored, 0 dropped (REJECT_NEWEST)
+ *   prefix_write(q, elems, n)              elements stored
+ *   prefix_pop(q, &elem)                   1 read, 0 empty
+ *   prefix_read(q, elems, max)             batched pop, elements read
+ *   prefix_used / prefix_free / prefix_full / prefix_dropped
+ *   prefix_sample(q)                       histogram sample, once per drain
+ * All static inline: sizeof(elem_type) is a constant in the copies. */
+#define SPSC_RING_DEFINE(type_name, prefix, elem_type)                              \
+typedef struct                                                                      \
+{                                                                                   \
+    SpscRing ring;                                                                  \
+    elem_type *slots;                                                               \
+} type_name;                                                                        \
+                                                                                    \
+static inline int prefix##_init(type_name *q, elem_type *slots, uint16_t count,     \
+        uint8_t policy)                                                             \
+{                                                                                   \
+    q->slots = slots;                                                               \
+    return spsc_ring_init(&q->ring, count, policy);                                 \
+}                                                                                   \
+static inline int prefix##_push(type_name *q, const elem_type *e)                   \
+{                                                                                   \
+    return (int)spsc_ring_put(&q->ring, q->slots, sizeof(elem_type), e, 1U);        \
+}                                                                                   \
+static inline uint16_t prefix##_write(type_name *q, const elem_type *e, uint16_t n) \
+{                                                                                   \
+    return spsc_ring_put(&q->ring, q->slots, sizeof(elem_type), e, n);              \
+}                                                                                   \
+static inline int prefix##_pop(type_name *q, elem_type *out)                        \
+{                                                                                   \
+    return (int)spsc_ring_get(&q->ring, q->slots, sizeof(elem_type), out, 1U);      \
+}                                                                                   \
+static inline uint16_t prefix##_read(type_name *q, elem_type *out, uint16_t max)    \
+{                                                                                   \
+    return spsc_ring_get(&q->ring, q->slots, sizeof(elem_type), out, max);          \
+}                                                                                   \
+static inline uint16_t prefix##_used(const type_name *q)                            \
+{                                                                                   \
+    return spsc_ring_used(&q->ring);                                                \
+}                                                                                   \
+static inline uint16_t prefix##_free(const type_name *q)                            \
+{                                                                                   \
+    return spsc_ring_free(&q->ring);                                                \
+}                                                                                   \
+static inline int prefix##_full(const type_name *q)                                 \
+{                                                                                   \
+    return spsc_ring_free(&q->ring) == 0U;                                          \
+}                                                                                   \
+static inline uint32_t prefix##_dropped(const type_name *q)                         \
+{                                                                                   \
+    return __atomic_load_n(&q->ring.dropped, __ATOMIC_RELAXED);                     \
+}                                                                                   \
+static inline void prefix##_sample(type_name *q)                                    \
+{                                                                                   \
+    spsc_ring_sample(&q->ring);                                                     \
+}
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_SPSC_RING_H_ */
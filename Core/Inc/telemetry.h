@@ -0,0 +1,70 @@
+/*
+ * telemetry.h
+ *
+ * Binary measurement records, device -> host, as v1 packet frames on the
+ * console UART (see packet.h):
+ *
+ *      | CMD_HEADER | LENGTH | TELEM_CMD_BASE + id | RECORD | CHECKSUM |
+ *
+ *  RECORD : packed little-endian fields, layout given by the record type
+ *
+ * Modules declare their record types with telemetry_register(). Each
+ * registration is announced to the host with a schema frame:
+ *
+ *      | CMD_HEADER | LENGTH | TELEM_CMD_SCHEMA | id | "name|field:T,..." | CHECKSUM |
+ *
+ *  T : Python struct code of the field, one of B b H h I i
+ *
+ * so tools/telemetry/decode_telemetry.py needs no copy of the layouts.
+ * The frames can share the UART with print() text: CMD_HEADER (0xAA) is
+ * never part of ASCII output, the host resyncs on it.
+ */
+
+#ifndef INC_TELEMETRY_H_
+#define INC_TELEMETRY_H_
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 1 = latency.c / phase2_pi.c emit binary records instead of CSV rows */
+#ifndef TELEMETRY_BINARY
+#define TELEMETRY_BINARY  0
+#endif
+
+/* Reserved CMD range (outside CMD_ID): data records + schema */
+#define TELEM_CMD_BASE    0xC0U
+#define TELEM_CMD_SCHEMA  0xCFU
+#define TELEM_MAX_TYPES   (TELEM_CMD_SCHEMA - TELEM_CMD_BASE)
+
+/* Largest RECORD (and schema text); keeps the frame within build_packet() */
+#define TELEM_MAX_RECORD  250U
+
+typedef struct
+{
+    const char *name;       // e.g. "lat_sample"
+    const char *fields;     // e.g. "seq:I,load_active:B,delta:h"
+    uint8_t size;           // packed RECORD size, checked against fields
+} TelemType;
+
+/* Frames go out on this UART (blocking, like print()) */
+void telemetry_init(void *uart_handle);
+
+/* Register a record type (t must stay valid) and send its schema frame.
+ * Returns the record id (>= 0), -1 registry full, -2 bad layout. */
+int telemetry_register(const TelemType *t);
+
+/* Send one record of type id; len must equal the registered size.
+ * Returns 0 on success, -1 unknown id or bad length. */
+int telemetry_send(int id, const void *record, uint8_t len);
+
+/* Re-send every schema frame, e.g. for a host that attached late */
+void telemetry_announce(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_TELEMETRY_H_ */
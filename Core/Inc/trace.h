@@ -0,0 +1,79 @@
+/*
+ * trace.h
+ *
+ * Compile-time trace levels per module.
+ *
+ *  Each source file picks its module before including this header:
+ *
+ *      #define TRACE_MODULE PACKET
+ *      #include "trace.h"
+ *
+ *  and traces with TRACE_ERROR / TRACE_INFO / TRACE_DEBUG (print() format).
+ *  Calls above the module level are removed by the preprocessor, so their
+ *  arguments are not evaluated and no print() reference is left behind.
+ *
+ *  Module level: -DTRACE_LEVEL_<MODULE>=<0..3>, default TRACE_LEVEL_DEFAULT
+ *  (INFO in the Debug configuration, ERROR otherwise).
+ */
+
+#ifndef INC_TRACE_H_
+#define INC_TRACE_H_
+
+#include "console.h"  // print()
+
+#define TRACE_LEVEL_NONE   0
+#define TRACE_LEVEL_ERROR  1
+#define TRACE_LEVEL_INFO   2
+#define TRACE_LEVEL_DEBUG  3  // per-byte / per-frame dumps, blocks at 87 us/char
+
+#ifndef TRACE_LEVEL_DEFAULT
+#ifdef DEBUG
+#define TRACE_LEVEL_DEFAULT TRACE_LEVEL_INFO
+#else
+#define TRACE_LEVEL_DEFAULT TRACE_LEVEL_ERROR
+#endif
+#endif
+
+/* ---------- Modules ---------- */
+#ifndef TRACE_LEVEL_PACKET
+#define TRACE_LEVEL_PACKET TRACE_LEVEL_DEFAULT  // packet_codec.c: codec + parser
+#endif
+
+#ifndef TRACE_LEVEL_CMD
+#define TRACE_LEVEL_CMD TRACE_LEVEL_DEFAULT     // cmd.c: console + binary commands
+#endif
+
+#define TRACE_CAT_(a, b)      a##b
+#define TRACE_LEVEL_OF_(m)    TRACE_CAT_(TRACE_LEVEL_, m)
+
+#endif /* INC_TRACE_H_ */
+
+/* ---------- Per-file part (TRACE_MODULE may differ per file) ---------- */
+#ifndef TRACE_MODULE
+#error "define TRACE_MODULE before including trace.h"
+#endif
+
+#undef TRACE_LEVEL
+#define TRACE_LEVEL TRACE_LEVEL_OF_(TRACE_MODULE)
+
+#undef TRACE_ERROR
+#undef TRACE_INFO
+#undef TRACE_DEBUG
+
+#if (TRACE_LEVEL >= TRACE_LEVEL_ERROR)
+#define TRACE_ERROR(...) print(__VA_ARGS__)
+#else
+#define TRACE_ERROR(...) ((void)0)
+#endif
+
+#if (TRACE_LEVEL >= TRACE_LEVEL_INFO)
+#define TRACE_INFO(...) print(__VA_ARGS__)
+#else
+#define TRACE_INFO(...) ((void)0)
+#endif
+
+#if (TRACE_LEVEL >= TRACE_LEVEL_DEBUG)
+#define TRACE_DEBUG(...) print(__VA_ARGS__)
+#else
+#define TRACE_DEBUG(...) ((void)0)
+#endif
@@ -11,22 +11,31 @@
 
 #include <stdint.h>
 
-#define RB_SIZE 128
-#define RB_MASK (RB_SIZE - 1)
-
-typedef struct {
-    uint8_t buf[RB_SIZE];
-    volatile uint16_t head;
-    volatile uint16_t tail;
-} RingBuffer;
+#include "spsc_ring.h"
 
-/* API */
-void rb_init(RingBuffer *rb);
-void rb_push(RingBuffer *rb, uint8_t data);
-int  rb_pop(RingBuffer *rb, uint8_t *out);
+#ifdef __cplusplus
+extern "C" {
+#endif
 
+/* UART byte ring: SPSC ring of uint8_t (see spsc_ring.h).
+ *
+ * One context writes (e.g. an ISR), another reads. Byte rings use
+ * SPSC_RING_REJECT_NEWEST: a full ring drops the new bytes and counts
+ * them in rb_dropped(); unread data is never overwritten, so a frame in
+ * progress is not torn. (The UART RX copy path uses bipbuf.h.)
+ *
+ *   rb_init(rb, buf, size, policy)   0 / -1 (size not a power of two)
+ *   rb_push / rb_pop                 one byte, 1 / 0
+ *   rb_write / rb_read               bulk, at most two memcpy segments
+ *   rb_used / rb_free / rb_full / rb_dropped */
 
+/* Default capacity of the UART rings */
+#define RB_SIZE 128
 
+SPSC_RING_DEFINE(RingBuffer, rb, uint8_t)
 
+#ifdef __cplusplus
+}
+#endif
 
 #endif /* INC_UART_RB_H_ */
@@ -0,0 +1,153 @@
+/*
+ * uart_rx.h
+ *
+ * UART1/UART3 RX path: circular DMA buffer -> (BipBuf) -> packet parser.
+ *
+ * Reception is HAL_UARTEx_ReceiveToIdle_DMA() on a circular buffer: the
+ * RX event callback fires at half transfer, transfer complete and IDLE,
+ * and the caller passes its position here. A continuous stream with no
+ * idle gap is therefore processed every half buffer; data is only
+ * overwritten if an event is handled more than half a buffer late.
+ * The bytes written since the previous event are either parsed straight
+ * out of the DMA buffer (UART_RX_ZERO_COPY) or copied as one contiguous
+ * chunk into the port's bip-buffer and drained into the parser. Completed
+ * frames go to the parser's handler; a frame that lies whole in the
+ * drained region is handed over in place (packet_parser_set_inplace()).
+ *
+ * With a notify hook (uart_rx_set_notify(), uart_rx_task.h) the event
+ * only does bookkeeping: the zero-copy path publishes the new DMA
+ * position, the copy path copies the chunk into the bip-buffer. The hook
+ * wakes the port's RX task, which parses everything in uart_rx_service().
+ * Without a hook (before the scheduler runs, UART_RX_TASK = 0) the event
+ * parses itself: all new bytes on the zero-copy path, at most
+ * UART_RX_ISR_DRAIN bytes of the bip-buffer on the copy path.
+ *
+ * No HAL dependency: tools/rxreplay builds this file unchanged and replays
+ * captured byte streams through it with mocked HT / TC / IDLE events.
+ */
+
+#ifndef INC_UART_RX_H_
+#define INC_UART_RX_H_
+
+#include <stdint.h>
+
+#include "packet_codec.h"
+#include "bipbuf.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* 1: parse UART1/UART3 frames directly out of the circular DMA buffer.
+ * 0: copy path, copy new bytes into the port's BipBuf and drain them. */
+#ifndef UART_RX_ZERO_COPY
+#define UART_RX_ZERO_COPY 1
+#endif
+
+/* UART1/UART3 link framing:
+ * 0: HEADER + LENGTH framing, streaming PacketParser
+ * 1: COBS framing, 0x00 delimited (see packet_codec.h) */
+#ifndef UART_LINK_COBS
+#define UART_LINK_COBS 0
+#endif
+
+/* 1: parse UART1/UART3 in per-port RX tasks woken by the RX event
+ * 0: parse in the RX event ISR (see UART_RX_ISR_DRAIN) */
+#ifndef UART_RX_TASK
+#define UART_RX_TASK 1
+#endif
+
+/* Copy path: bip-buffer capacity. A DMA chunk is at most the DMA buffer
+ * size and the largest reservation that always fits is about half the
+ * bip-buffer, so twice the DMA buffer. */
+#ifndef UART_RX_BIP_SIZE
+#define UART_RX_BIP_SIZE 128U
+#endif
+
+/* Copy path without RX task: bytes drained from the BipBuf inside the
+ * RX event ISR; the rest waits for the next event */
+#ifndef UART_RX_ISR_DRAIN
+#define UART_RX_ISR_DRAIN 32U
+#endif
+
+/* Stage timing hooks, empty on target. The replay harness force-includes
+ * its own definitions to time each stage. */
+#define UART_RX_STAGE_PUSH   0   // DMA buffer -> BipBuf (copy path)
+#define UART_RX_STAGE_PARSE  1   // parser feed, frame handler included
+#ifndef UART_RX_PROF_BEGIN
+#define UART_RX_PROF_BEGIN(stage)
+#define UART_RX_PROF_END(stage)
+#endif
+
+typedef struct
+{
+    uint8_t *dma_buf;           // circular DMA RX buffer
+    uint16_t dma_size;
+    uint16_t last_pos;          // DMA write position at the previous event
+    BipBuf *bip;                // copy path only
+    PacketParser *parser;
+    PacketCobsParser *cobs;
+    volatile uint32_t dma_anomaly;  // events ignored (position out of range), RX restarts
+
+    /* ISR -> RX task handoff, see uart_rx_set_notify() */
+    void (*notify)(void *ctx);
+    void *notify_ctx;
+    uint32_t seq;               // ISR: bumped after each update of the ISR fields
+    uint32_t rx_head;           // ISR, zero-copy: bytes published, wraps
+    uint32_t restart_head;      // ISR, zero-copy: rx_head at the last restart
+    uint16_t restarts;          // ISR, zero-copy: uart_rx_restart() calls
+    uint16_t task_restarts;     // service: restarts handled
+    uint16_t task_pos;          // service: DMA position parsed up to
+    uint32_t task_done;         // service: bytes parsed (or skipped), wraps
+    volatile uint32_t lapped;   // service: bytes the DMA overwrote before or while they were parsed
+    const volatile uint32_t *dma_cndtr; // zero-copy: live DMA counter, see uart_rx_set_dma_counter()
+#if (SPSC_RING_STATS != 0)
+    /* DMA buffer fill level: bytes not yet processed when an event is
+     * handled, i.e. the event's new bytes plus what arrived during the
+     * interrupt latency. Above dma_size the DMA has lapped (overflows);
+     * a high_water near dma_size means the latency eats the margin. */
+    SpscRingStats dma_stats;
+#endif
+} UartRxPort;
+
+void uart_rx_port_init(UartRxPort *port, uint8_t *dma_buf, uint16_t dma_size,
+        BipBuf *bip, PacketParser *parser, PacketCobsParser *cobs);
+
+/* RX event (ISR): half transfer, transfer complete or IDLE.
+ * pos = position reported by HAL_UARTEx_RxEventCallback() (Size), dma_size
+ * at transfer complete; dma_remaining = DMA counter (NDTR) read now, only
+ * for the fill level statistics. */
+void uart_rx_on_event(UartRxPort *port, uint16_t pos, uint16_t dma_remaining);
+
+/* Reception was restarted (HAL error abort): the DMA starts over at 0 */
+void uart_rx_restart(UartRxPort *port);
+
+/* Set the hook the RX event calls (ISR context) after its bookkeeping,
+ * typically a task notification; the woken task calls uart_rx_service().
+ * NULL: parse in the ISR. */
+void uart_rx_set_notify(UartRxPort *port, void (*notify)(void *ctx), void *ctx);
+
+/* Zero-copy: live DMA counter (CNDTR) of the port's RX channel. The RX
+ * task parses the DMA buffer while the DMA keeps writing into it, so
+ * uart_rx_service() reads the counter before and after feeding the
+ * parser: bytes already overwritten are skipped, bytes overwritten while
+ * parsed are counted; both go to lapped. Without a counter (NULL, the
+ * default) only a task a whole buffer late is detected, lapped undercounts
+ * and the frame CRC is the only guard against overwritten bytes. */
+void uart_rx_set_dma_counter(UartRxPort *port, const volatile uint32_t *cndtr);
+
+/* Parse everything received up to the last RX event: the DMA region
+ * published by the ISR (zero-copy) or the whole BipBuf (copy path).
+ * One caller context per port: the RX task, or the ISR without a hook. */
+void uart_rx_service(UartRxPort *port);
+
+/* Copy path: drain the BipBuf into the parser.
+ * max_bytes = 0 for unlimited drain in task / main loop context, a small
+ * cap (UART_RX_ISR_DRAIN) in interrupt context. */
+void uart_rx_drain(UartRxPort *port, uint16_t max_bytes);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_UART_RX_H_ */
@@ -0,0 +1,32 @@
+/*
+ * uart_rx_task.h
+ *
+ * Per-port RX task of the UART1/UART3 RX path (uart_rx.h).
+ * The RX event ISR does only its bookkeeping and gives the port's task a
+ * notification; the task parses everything received so far with
+ * uart_rx_service(), so frame handlers run at task priority and no bytes
+ * are left waiting for the next RX event.
+ */
+
+#ifndef INC_UART_RX_TASK_H_
+#define INC_UART_RX_TASK_H_
+
+#include "cmsis_os2.h"
+#include "uart_rx.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Create the RX task of a port. The task hooks itself to the port's RX
+ * events before its first uart_rx_service(), so the ISR and the task never
+ * parse at the same time. Call from the RTOS threads section, after
+ * uart_rx_port_init().
+ * Returns the task, or NULL (the ISR keeps parsing). */
+osThreadId_t uart_rx_task_start(UartRxPort *port, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* INC_UART_RX_TASK_H_ */
@@ -12,13 +12,18 @@
 #include "main.h"
 #include "packet.h"
 #include "uart_rb.h"
+#include "arq_link.h"
 
 /* Test case IDs */
 typedef enum {
     UART_TEST_SINGLE_CMD = 0,
     UART_TEST_CMD_WITH_IDLE,
     UART_TEST_CMD_STICKY,      // Multiple commands concatenated together
-    UART_TEST_CONTINUOUS_STREAM
+    UART_TEST_CONTINUOUS_STREAM,
+    UART_TEST_MIXED_VERSIONS,  // v1 and v2 frames interleaved on one link
+    UART_TEST_COBS_FRAMES,     // COBS framed (peer must use UART_LINK_COBS=1)
+    UART_TEST_TX_THROUGHPUT,   // frames/s: blocking build+send vs packet_tx DMA ring
+    UART_TEST_CMD_BATCH        // CMD_STICKY's commands as one BATCH frame
 } UART_TestCase;
 
 /* Initialize the test module */
@@ -30,4 +35,22 @@ void uart_test_run(UART_TestCase test_case);
 /* Simulate DMA/IDLE reception, write data into RingBuffer and parse */
 void uart_test_feed_data(uint8_t *data, uint16_t len);
 
+#if (ARQ_ENABLE != 0)
+/* 1: start the ARQ loopback test task with the RTOS threads (UART1 <-> UART3
+ * wired back to back, ARQ_ENABLE=1) */
+#ifndef UART_TEST_ARQ
+#define UART_TEST_ARQ (0)
+#endif
+
+/* Commands sent by the ARQ loopback test */
+#ifndef UART_TEST_ARQ_CMDS
+#define UART_TEST_ARQ_CMDS 200
+#endif
+
+/* Task that sends UART_TEST_ARQ_CMDS LED_ON / LED_OFF commands through
+ * arq_link_send() on tx, waits until rx has delivered them and prints the
+ * elapsed time, goodput and retransmit counters of both links. */
+void uart_test_arq_start(ArqLink *tx, ArqLink *rx);
+#endif
+
 #endif /* INC_UART_TEST_H_ */
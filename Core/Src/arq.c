@@ -0,0 +1,220 @@
+/*
+ * arq.c
+ *
+ * Selective-repeat ARQ over v2 packet frames (see arq.h).
+ */
+#include "arq.h"
+
+#include <string.h>
+
+#include "cmd.h"
+
+_Static_assert((ARQ_WINDOW_MAX & (ARQ_WINDOW_MAX - 1U)) == 0U && ARQ_WINDOW_MAX <= 16U,
+        "ARQ_WINDOW_MAX must be a power of two <= 16");
+_Static_assert(INVALID_CMD < ARQ_CMD_ACK, "ARQ control CMD overlaps CMD_ID");
+
+#define ARQ_SLOT(seq)  ((uint8_t)(seq) & (ARQ_WINDOW_MAX - 1U))
+
+static void arq_tx_frame(Arq *a, uint8_t seq, const uint8_t *payload, uint16_t len)
+{
+    uint8_t frame[PKT_PARSER_BUF_SIZE];
+    uint16_t n = build_packet_v2(frame, seq, (CMD_ID)payload[0], &payload[1], len - 1U);
+    a->tx_fn(a->ctx, frame, n);
+}
+
+static void arq_send_ack(Arq *a)
+{
+    uint16_t sack = 0;
+    for (uint8_t i = 1; i < a->window; i++)
+    {
+        if (a->rx[ARQ_SLOT(a->rcv_base + i)].used)
+            sack |= (uint16_t)(1U << (i - 1U));
+    }
+
+    uint8_t ctl[3] = { ARQ_CMD_ACK, (uint8_t)(sack & 0xFF), (uint8_t)(sack >> 8) };
+    uint8_t frame[PKT_V2_OVERHEAD + sizeof(ctl)];
+    uint16_t n = build_packet_v2(frame, a->rcv_base, (CMD_ID)ctl[0], &ctl[1], 2);
+    a->tx_fn(a->ctx, frame, n);
+    a->stats.acks_tx++;
+}
+
+static void arq_send_nack(Arq *a, uint8_t seq)
+{
+    uint8_t frame[PKT_V2_OVERHEAD + 1];
+    uint16_t n = build_packet_v2(frame, seq, (CMD_ID)ARQ_CMD_NACK, NULL, 0);
+    a->tx_fn(a->ctx, frame, n);
+    a->stats.nacks_tx++;
+}
+
+static void arq_retransmit(Arq *a, ArqSlot *s, uint8_t seq, uint32_t now)
+{
+    arq_tx_frame(a, seq, s->payload, s->len);
+    s->sent_at = now;
+    a->stats.retransmits++;
+}
+
+void arq_init(Arq *a, uint8_t window, uint32_t rto_ms,
+        ArqTxFn tx_fn, ArqDeliverFn deliver_fn, void *ctx)
+{
+    memset(a, 0, sizeof(*a));
+    if (window == 0U)
+        window = 1U;
+    if (window > ARQ_WINDOW_MAX)
+        window = ARQ_WINDOW_MAX;
+    a->window = window;
+    a->rto_ms = rto_ms;
+    a->tx_fn = tx_fn;
+    a->deliver_fn = deliver_fn;
+    a->ctx = ctx;
+}
+
+uint8_t arq_window_free(const Arq *a)
+{
+    return (uint8_t)(a->window - (uint8_t)(a->snd_next - a->snd_base));
+}
+
+int arq_send(Arq *a, const uint8_t *payload, uint16_t len, uint32_t now)
+{
+    if ((len == 0U) || (len > ARQ_MAX_PAYLOAD))
+        return -2;
+    if (arq_window_free(a) == 0U)
+        return -1;
+
+    uint8_t seq = a->snd_next++;
+    ArqSlot *s = &a->tx[ARQ_SLOT(seq)];
+    memcpy(s->payload, payload, len);
+    s->len = len;
+    s->used = 1;
+    s->flag = 0;
+    s->sent_at = now;
+
+    arq_tx_frame(a, seq, payload, len);
+    a->stats.tx_frames++;
+    return 0;
+}
+
+/* ---------- sender side ---------- */
+static void arq_on_ack(Arq *a, uint8_t cum, const uint8_t *sack_bytes, uint16_t sack_len)
+{
+    uint8_t in_flight = (uint8_t)(a->snd_next - a->snd_base);
+    uint8_t advance = (uint8_t)(cum - a->snd_base);
+
+    a->stats.acks_rx++;
+    if (advance > in_flight)
+        return; // stale or bogus
+
+    while (a->snd_base != cum)
+    {
+        a->tx[ARQ_SLOT(a->snd_base)].used = 0;
+        a->snd_base++;
+    }
+
+    uint16_t sack = 0;
+    if (sack_len >= 2U)
+        sack = (uint16_t)(sack_bytes[0] | (sack_bytes[1] << 8));
+
+    for (uint8_t i = 1; sack != 0U; i++, sack >>= 1)
+    {
+        if ((sack & 1U) && (uint8_t)(i) < (uint8_t)(a->snd_next - a->snd_base))
+            a->tx[ARQ_SLOT(cum + i)].flag = 1;
+    }
+}
+
+static void arq_on_nack(Arq *a, uint8_t seq, uint32_t now)
+{
+    a->stats.nacks_rx++;
+    if ((uint8_t)(seq - a->snd_base) >= (uint8_t)(a->snd_next - a->snd_base))
+        return;
+
+    ArqSlot *s = &a->tx[ARQ_SLOT(seq)];
+    if (s->used && !s->flag)
+        arq_retransmit(a, s, seq, now);
+}
+
+void arq_poll(Arq *a, uint32_t now)
+{
+    for (uint8_t seq = a->snd_base; seq != a->snd_next; seq++)
+    {
+        ArqSlot *s = &a->tx[ARQ_SLOT(seq)];
+        if (s->used && !s->flag && (uint32_t)(now - s->sent_at) >= a->rto_ms)
+        {
+            a->stats.timeouts++;
+            arq_retransmit(a, s, seq, now);
+        }
+    }
+}
+
+/* ---------- receiver side ---------- */
+static void arq_on_data(Arq *a, uint8_t seq, const uint8_t *payload, uint16_t len)
+{
+    uint8_t off = (uint8_t)(seq - a->rcv_base);
+
+    if (off >= a->window)
+    {
+        // Behind the window: our ACK was lost, repeat it
+        if ((uint8_t)(a->rcv_base - seq) <= a->window)
+            a->stats.dup_rx++;
+        else
+            a->stats.out_of_window++;
+        arq_send_ack(a);
+        return;
+    }
+
+    ArqSlot *s = &a->rx[ARQ_SLOT(seq)];
+    if (s->used)
+    {
+        a->stats.dup_rx++;
+    }
+    else if (len <= ARQ_MAX_PAYLOAD)
+    {
+        memcpy(s->payload, payload, len);
+        s->len = len;
+        s->used = 1;
+    }
+
+    // NACK each missing SEQ before this one, once per gap
+    for (uint8_t i = 0; i < off; i++)
+    {
+        ArqSlot *gap = &a->rx[ARQ_SLOT(a->rcv_base + i)];
+        if (!gap->used && !gap->flag)
+        {
+            gap->flag = 1;
+            arq_send_nack(a, (uint8_t)(a->rcv_base + i));
+        }
+    }
+
+    // Deliver the in-order run
+    for (;;)
+    {
+        ArqSlot *head = &a->rx[ARQ_SLOT(a->rcv_base)];
+        if (!head->used)
+            break;
+        a->deliver_fn(a->ctx, head->payload, head->len);
+        a->stats.delivered++;
+        a->stats.delivered_bytes += head->len;
+        head->used = 0;
+        head->flag = 0;
+        a->rcv_base++;
+    }
+
+    arq_send_ack(a);
+}
+
+void arq_on_frame(Arq *a, const PacketFrame *frame, uint32_t now)
+{
+    if ((frame->version != 2U) || (frame->len == 0U))
+        return;
+
+    switch (frame->payload[0])
+    {
+    case ARQ_CMD_ACK:
+        arq_on_ack(a, frame->seq, &frame->payload[1], frame->len - 1U);
+        break;
+    case ARQ_CMD_NACK:
+        arq_on_nack(a, frame->seq, now);
+        break;
+    default:
+        arq_on_data(a, frame->seq, frame->payload, frame->len);
+        break;
+    }
+}
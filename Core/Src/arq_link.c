@@ -0,0 +1,161 @@
+/*
+ * arq_link.c
+ *
+ * FreeRTOS wrapper running the ARQ engine on one UART link (see arq_link.h).
+ */
+#include "arq_link.h"
+
+#include <string.h>
+
+#include "task.h"
+#include "cmd_dispatch.h"
+
+static const osThreadAttr_t g_arq_task_attr_template = {
+    .priority = (osPriority_t) osPriorityAboveNormal,
+    .stack_size = 384 * 4  // message copy + v2 frame (arq.c) + COBS wire buffer (arq_link_tx)
+};
+
+/* ---------- Arq callbacks (link task context) ---------- */
+static void arq_link_tx(void *ctx, const uint8_t *frame, uint16_t len)
+{
+    ArqLink *l = (ArqLink *) ctx;
+
+    if (l->cobs)
+    {
+        uint8_t wire[PKT_COBS_BUF_SIZE + 1];
+        uint16_t n = packet_cobs_encode(wire, frame, len);
+        HAL_UART_Transmit(l->huart, wire, n, HAL_MAX_DELAY);
+    }
+    else
+    {
+        HAL_UART_Transmit(l->huart, (uint8_t *) frame, len, HAL_MAX_DELAY);
+    }
+}
+
+static void arq_link_deliver(void *ctx, const uint8_t *payload, uint16_t len)
+{
+    ArqLink *l = (ArqLink *) ctx;
+
+    if (l->deliver != NULL)
+        l->deliver(l->deliver_ctx, payload, len);
+    else
+        cmd_dispatch_post(payload, len);
+}
+
+/* ---------- task / timer ---------- */
+static void arq_link_timer_cb(TimerHandle_t timer)
+{
+    ArqLink *l = (ArqLink *) pvTimerGetTimerID(timer);
+    xTaskNotifyGive((TaskHandle_t) l->task);
+}
+
+static void arq_link_task(void *argument)
+{
+    ArqLink *l = (ArqLink *) argument;
+    uint8_t buf[1 + ARQ_MAX_PAYLOAD];
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        uint32_t now = HAL_GetTick();
+
+        size_t n;
+        while ((n = xMessageBufferReceive(l->rx_buf, buf, sizeof(buf), 0)) > 1U)
+        {
+            PacketFrame frame = {
+                .version = 2,
+                .seq = buf[0],
+                .payload = &buf[1],
+                .len = (uint16_t)(n - 1U),
+            };
+            arq_on_frame(&l->arq, &frame, now);
+        }
+
+        while (arq_window_free(&l->arq) > 0U)
+        {
+            n = xMessageBufferReceive(l->tx_buf, buf, ARQ_MAX_PAYLOAD, 0);
+            if (n == 0U)
+                break;
+            arq_send(&l->arq, buf, (uint16_t) n, now);
+        }
+
+        arq_poll(&l->arq, now);
+    }
+}
+
+/* ---------- public APIs ---------- */
+void arq_link_set_deliver(ArqLink *l, ArqDeliverFn fn, void *ctx)
+{
+    l->deliver = fn;
+    l->deliver_ctx = ctx;
+}
+
+void arq_link_start(ArqLink *l, const char *name, UART_HandleTypeDef *huart,
+        uint8_t cobs)
+{
+    l->huart = huart;
+    l->cobs = cobs;
+    arq_init(&l->arq, ARQ_LINK_WINDOW, ARQ_LINK_RTO_MS,
+            arq_link_tx, arq_link_deliver, l);
+
+    l->rx_buf = xMessageBufferCreate(ARQ_LINK_BUF_SIZE);
+    l->tx_buf = xMessageBufferCreate(ARQ_LINK_BUF_SIZE);
+    l->timer = xTimerCreate(name, pdMS_TO_TICKS(ARQ_LINK_TICK_MS), pdTRUE, l,
+            arq_link_timer_cb);
+    if ((l->rx_buf == NULL) || (l->tx_buf == NULL) || (l->timer == NULL))
+        return;
+
+    osThreadAttr_t attr = g_arq_task_attr_template;
+    attr.name = name;
+    l->task = osThreadNew(arq_link_task, l, &attr);
+    if (l->task != NULL)
+        xTimerStart(l->timer, 0);
+}
+
+int arq_link_post_rx(ArqLink *l, const PacketFrame *frame)
+{
+    uint8_t msg[1 + ARQ_MAX_PAYLOAD];
+
+    if ((l->task == NULL) || (frame->len == 0U) || (frame->len > ARQ_MAX_PAYLOAD))
+    {
+        l->rx_dropped++;
+        return -1;
+    }
+
+    msg[0] = frame->seq;
+    memcpy(&msg[1], frame->payload, frame->len);
+
+    size_t sent;
+    if (__get_IPSR() != 0U)
+    {
+        BaseType_t woken = pdFALSE;
+        sent = xMessageBufferSendFromISR(l->rx_buf, msg, frame->len + 1U, &woken);
+        vTaskNotifyGiveFromISR((TaskHandle_t) l->task, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+    else
+    {
+        sent = xMessageBufferSend(l->rx_buf, msg, frame->len + 1U, 0);
+        xTaskNotifyGive((TaskHandle_t) l->task);
+    }
+
+    if (sent == 0U)
+    {
+        l->rx_dropped++;
+        return -1;
+    }
+    return 0;
+}
+
+int arq_link_send(ArqLink *l, const uint8_t *payload, uint16_t len,
+        uint32_t timeout_ms)
+{
+    if ((l->task == NULL) || (len == 0U) || (len > ARQ_MAX_PAYLOAD))
+        return -2;
+
+    if (xMessageBufferSend(l->tx_buf, payload, len, pdMS_TO_TICKS(timeout_ms)) != len)
+        return -1;
+
+    xTaskNotifyGive((TaskHandle_t) l->task);
+    return 0;
+}
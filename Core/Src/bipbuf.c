@@ -0,0 +1,165 @@
+/*
+ * bipbuf.c
+ *
+ * SPSC bip-buffer (see bipbuf.h).
+ *
+ * Layout: not wrapped when read <= write, data is [read, write).
+ * Wrapped when write < read, data is [read, last) then [0, write).
+ * The producer only wraps when it stays strictly behind read, so
+ * write == read always means empty.
+ */
+#include "bipbuf.h"
+
+#include <string.h>
+
+int bipbuf_init(BipBuf *b, uint8_t *storage, uint16_t size)
+{
+    memset(b, 0, sizeof(*b));
+    if (size < 2U)
+        return -1;
+    b->buf = storage;
+    b->size = size;
+#if (SPSC_RING_STATS != 0)
+    spsc_stats_init(&b->stats, size);
+#endif
+    return 0;
+}
+
+uint8_t *bipbuf_reserve(BipBuf *b, uint16_t n)
+{
+    uint16_t w = SPSC_LOAD_OWN(&b->write);
+    uint16_t r = SPSC_LOAD_ACQ(&b->read);
+
+    if (w >= r)
+    {
+        if ((uint16_t)(b->size - w) >= n)
+        {
+            b->reserved = w;
+            return &b->buf[w];
+        }
+        if (r > n)
+        {
+            // Wrap: the tail [w, size) stays unused
+            b->reserved = 0;
+            return b->buf;
+        }
+    }
+    else if ((uint16_t)(r - w) > n)
+    {
+        b->reserved = w;
+        return &b->buf[w];
+    }
+
+    return NULL;
+}
+
+void bipbuf_commit(BipBuf *b, uint16_t n)
+{
+    uint16_t w = SPSC_LOAD_OWN(&b->write);
+    uint16_t start = b->reserved;
+
+    if (start < w)
+    {
+        // Wrapped: end of the old data first, write (release) publishes both
+        SPSC_STORE_OWN(&b->last, w);
+    }
+    SPSC_STORE_REL(&b->write, (uint16_t)(start + n));
+
+#if (SPSC_RING_STATS != 0)
+    spsc_stats_put(&b->stats, bipbuf_used(b), b->size);
+#endif
+}
+
+/* Room for a reservation at write, or at 0 once the tail is full */
+static uint16_t bipbuf_room(const BipBuf *b)
+{
+    uint16_t w = SPSC_LOAD_OWN(&b->write);
+    uint16_t r = SPSC_LOAD_ACQ(&b->read);
+
+    if (w < r)
+        return (uint16_t)(r - w - 1U);
+    if (w < b->size)
+        return (uint16_t)(b->size - w);
+    return (r > 0U) ? (uint16_t)(r - 1U) : 0U;
+}
+
+uint16_t bipbuf_write(BipBuf *b, const uint8_t *data, uint16_t n)
+{
+    uint8_t *p = bipbuf_reserve(b, n);
+    if (p != NULL)
+    {
+        memcpy(p, data, n);
+        bipbuf_commit(b, n);
+        return n;
+    }
+
+    // Fragmented or full: fill up to the end, then from the start
+    uint16_t done = 0;
+    for (uint8_t pass = 0; (pass < 2U) && (done < n); pass++)
+    {
+        uint16_t k = bipbuf_room(b);
+        if (k > n - done)
+            k = (uint16_t)(n - done);
+        if (k == 0U)
+            break;
+        p = bipbuf_reserve(b, k);
+        memcpy(p, &data[done], k);
+        bipbuf_commit(b, k);
+        done += k;
+    }
+
+    if (done < n)
+    {
+        b->dropped += (uint32_t)(n - done);
+#if (SPSC_RING_STATS != 0)
+        spsc_stats_put(&b->stats, (uint32_t)b->size + 1U, b->size);
+#endif
+    }
+    return done;
+}
+
+const uint8_t *bipbuf_peek(BipBuf *b, uint16_t *len)
+{
+    uint16_t r = SPSC_LOAD_OWN(&b->read);
+    uint16_t w = SPSC_LOAD_ACQ(&b->write);
+
+    if (w < r)
+    {
+        uint16_t last = SPSC_LOAD_OWN(&b->last);
+        if (r != last)
+        {
+            *len = (uint16_t)(last - r);
+            return &b->buf[r];
+        }
+        // First part consumed: continue at the start
+        r = 0;
+        SPSC_STORE_REL(&b->read, r);
+    }
+
+    *len = (uint16_t)(w - r);
+    return (*len != 0U) ? &b->buf[r] : NULL;
+}
+
+void bipbuf_release(BipBuf *b, uint16_t n)
+{
+    SPSC_STORE_REL(&b->read, (uint16_t)(SPSC_LOAD_OWN(&b->read) + n));
+}
+
+uint16_t bipbuf_used(const BipBuf *b)
+{
+    uint16_t r = SPSC_LOAD_ACQ(&b->read);
+    uint16_t w = SPSC_LOAD_ACQ(&b->write);
+
+    if (w >= r)
+        return (uint16_t)(w - r);
+    return (uint16_t)(SPSC_LOAD_OWN(&b->last) - r + w);
+}
+
+void bipbuf_sample(BipBuf *b)
+{
+#if (SPSC_RING_STATS != 0)
+    spsc_stats_sample(&b->stats, bipbuf_used(b));
+#else
+    (void)b;
+#endif
+}
@@ -6,15 +6,22 @@
  */
 
 #include "cmd.h"
+#include "cmd_hash.h" // generated by tools/cmdgen/gen_cmd.py
 
 #include <string.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <ctype.h>
 
 #include "main.h"     // GPIO / TIM / UART handle
 #include "console.h"  // print()
 #include "watchdog.h" // System_Simulate_Deadlock()
+#include "link_stats.h"
+#include "ring_stats.h"
+#include "packet_codec.h" // packet_batch_run()
+#include "telemetry.h"
+
+#define TRACE_MODULE CMD
+#include "trace.h"
 
 /* ---------- external resources from main.c ---------- */
 extern UART_HandleTypeDef huart2;
@@ -29,66 +36,85 @@ typedef void (*CmdHandler)(int argc, char **argv);
 
 typedef struct
 {
-    char *cmd_name;
+    const char *cmd_name;
     CmdHandler handler;
 } CmdEntry;
 
-static void str_to_upper_inplace(char *s)
+typedef int (*BinCmdHandler)(const uint8_t *args, uint16_t len);
+
+typedef struct
 {
-    if (s == NULL)
-        return;
-    while (*s)
-    {
-        *s = (char)toupper((unsigned char)*s);
-        s++;
-    }
+    uint8_t arg_len_min;
+    uint8_t arg_len_max;
+    BinCmdHandler handler;
+} BinCmdEntry;
+
+/* Console integer argument (decimal or 0x hex) within [lo, hi].
+ * Used by the generated console decoders. Returns 0 on success. */
+static int cmd_con_int(const char *s, int32_t lo, int32_t hi, int32_t *out)
+{
+    char *end;
+    long v = strtol(s, &end, 0);
+    if ((end == s) || (*end != '\0') || (v < lo) || (v > hi))
+        return -1;
+    *out = (int32_t)v;
+    return 0;
 }
 
-/* ---------- CMD handlers ---------- */
-void func_led_on(int para_count, char **para)
+/* Console u32 argument (decimal or 0x hex), full range, no sign.
+ * Used by the generated console decoders; unused while no command in
+ * cmd_list.h takes a u32. Returns 0 on success. */
+__attribute__((unused))
+static int cmd_con_u32(const char *s, uint32_t *out)
+{
+    char *end;
+    if (*s == '-')
+        return -1;
+    unsigned long v = strtoul(s, &end, 0);
+    if ((end == s) || (*end != '\0'))
+        return -1;
+    *out = (uint32_t)v;
+    return 0;
+}
+
+/* Arg structs, decoders and the console / binary tables, generated from
+ * cmd_list.h by tools/cmdgen/gen_cmd.py */
+#include "cmd_table.h"
+
+_Static_assert(CMD_HASH_COUNT == INVALID_CMD,
+        "cmd_hash.h is stale: run tools/cmdgen/gen_cmd.py");
+
+
+/* ---------- CMD handlers (typed, shared by console and binary) ----------
+ * Called by the generated decoders with arguments already range/length
+ * checked. Return 0 on success, <0 if the command failed. */
+static int cmd_led_on(void)
 {
-    if (para_count != 0)
-    {
-        print("error: func_led_on: para_count != 0, must check!\r\n");
-        return;
-    }
     HAL_GPIO_WritePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin, GPIO_PIN_SET);
+    return 0;
 }
-void func_led_off(int para_count, char **para)
+
+static int cmd_led_off(void)
 {
-    if (para_count != 0)
-    {
-        print("error: func_led_off: para_count != 0, must check!\r\n");
-        return;
-    }
     HAL_GPIO_WritePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin, GPIO_PIN_RESET);
+    return 0;
 }
-void func_set_led(int para_count, char **para)
+
+static int cmd_set_led(const CmdArgs_SET_LED *a)
 {
-    if (para_count != 1)
-    {
-        print("error: func_led_off: para_count = %d != 1, must check!\r\n",
-                para_count);
-        return;
-    }
-    int led_num;
-    sscanf(para[0], "%d", &led_num); // led_num will be 1
-    if (led_num == 1)
+    if (a->led_num == 1)
         HAL_GPIO_WritePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin, GPIO_PIN_SET);
 //    else if (led_num == 2) HAL_GPIO_WritePin(LED_GREEN_GPIO_Port, LED_GREEN_Pin, GPIO_PIN_SET);
+    return 0;
 }
-void func_uart_tx(int para_count, char **para)
+
+/* data: raw bytes to transmit on the console UART */
+static int cmd_uart_tx(const CmdArgs_UART_TX *a)
 {
-    char *paraStr = malloc(strlen(para[0]) + 1);  // +1 for '\0'
-    if (paraStr != NULL)
-    {
-        strcpy(paraStr, para[0]);
-    }
-    HAL_UART_Transmit(&huart2, (uint8_t*) paraStr, strlen(paraStr),
-    HAL_MAX_DELAY);
-    // free
-    free(paraStr);
+    HAL_UART_Transmit(&huart2, (uint8_t*) a->data, a->data_len, HAL_MAX_DELAY);
+    return 0;
 }
+
 /* ---------- PWM/GPIO helpers ---------- */
 static void set_pwm_pin_gpio(int high)
 {
@@ -112,18 +138,12 @@ static void set_pwm_pin_af(void)
     GPIO_InitStruct.Alternate = GPIO_AF2_TIM2; // PA0 -> TIM2_CH1
     HAL_GPIO_Init(GPIOA, &GPIO_InitStruct);
 }
-void func_pwm_on(int para_count, char **para)
+
+static int cmd_pwm_on(const CmdArgs_PWM_ON *a)
 {
-    if (para_count != 2)
-    {
-        print("error: func_pwm_on: para_count != 2, must check!\r\n");
-        return;
-    }
-    int Duty;
-    int Freq;
+    int Duty = a->duty;
+    int Freq = a->freq;
 
-    sscanf(para[0], "%d", &Duty);
-    sscanf(para[1], "%d", &Freq);
     if (Duty > 100)
     {
         Duty = 100;
@@ -152,7 +172,7 @@ void func_pwm_on(int para_count, char **para)
         //    ARR (Period) sets the PWM frequency, CCR1 (Pulse) sets the duty cycle.
         //    htim2.Init.Period = 16000;
         //    sConfigOC.Pulse = 5000;
-        uint32_t arr = 16000000 / (uint32_t)Freq;
+        uint32_t arr = (Freq > 0) ? 16000000 / (uint32_t)Freq : 0;
         if (arr == 0) arr = 1;
         htim2.Instance->ARR = arr;
         uint32_t ccr = (arr * (uint32_t)Duty) / 100;
@@ -162,20 +182,149 @@ void func_pwm_on(int para_count, char **para)
         // Start PWM
         HAL_TIM_PWM_Start(&htim2, TIM_CHANNEL_1);
     }
+    return 0;
+}
+
+static int cmd_crash(void)
+{
+    print("\r\n[SYSTEM] Simulating deadlock now...\r\n");
+    System_Simulate_Deadlock();
+    return 0;
+}
 
+/* reply: one "link_stats" telemetry record on the console UART */
+static int cmd_link_stats(void)
+{
+    return (link_stats_report() == 0) ? 0 : -3;
+}
+
+/* reply: one "ring_stats" telemetry record per ring; reset != 0 clears
+ * the watermarks and histograms afterwards */
+static int cmd_ring_stats(const CmdArgs_RING_STATS *a)
+{
+    int rc = ring_stats_report();
+    if (a->reset != 0U)
+        ring_stats_reset();
+    return (rc == 0) ? 0 : -3;
+}
+
+/* ---------- BATCH ---------- */
+static int bin_cmd_check(const uint8_t *payload, uint16_t length);
+
+/* Sub-commands of a batch: any binary command except BATCH itself */
+static int batch_check(void *ctx, const uint8_t *cmd, uint16_t len)
+{
+    (void)ctx;
+    int rc = bin_cmd_check(cmd, len);
+    if ((rc == 0) && (cmd[0] == BATCH))
+        rc = -1;
+    return rc;
+}
+
+static int batch_exec(void *ctx, const uint8_t *cmd, uint16_t len)
+{
+    (void)ctx;
+    return bin_cmd_table[cmd[0]].handler(&cmd[1], len - 1);
 }
 
-void func_crash(int para_count, char **para)
+typedef __PACKED_STRUCT
+{
+    int8_t result;          // packet_batch_run() return value
+    uint8_t count;
+    uint8_t ok;
+    uint8_t first_fail;     // 0xFF if none
+    int8_t first_err;
+    uint32_t fail_mask;
+} BatchStatusRecord;
+
+static const TelemType g_batch_type = {
+    .name = "batch_status",
+    .fields = "result:b,count:B,ok:B,first_fail:B,first_err:b,fail_mask:I",
+    .size = sizeof(BatchStatusRecord)
+};
+
+static int g_batch_type_id = -1;
+
+void cmd_telemetry_init(void)
+{
+    g_batch_type_id = telemetry_register(&g_batch_type);
+}
+
+/* cmds: length-prefixed sub-commands (packet_codec.h), validated as a
+ * whole, then run in order. reply: one "batch_status" telemetry record. */
+static int cmd_batch(const CmdArgs_BATCH *a)
+{
+    PacketBatchStatus st;
+    int rc = packet_batch_run(a->cmds, a->cmds_len, batch_check, batch_exec, NULL, &st);
+
+    BatchStatusRecord rec = {
+        .result = (int8_t)rc,
+        .count = st.count,
+        .ok = st.ok,
+        .first_fail = st.first_fail,
+        .first_err = st.first_err,
+        .fail_mask = st.fail_mask
+    };
+    telemetry_send(g_batch_type_id, &rec, sizeof(rec));
+
+    if (rc == -1)
+        return -2;      // malformed batch = bad arguments
+    return rc;
+}
+
+/* ---------- console-only handlers ---------- */
+/* LINK_STATS on the console prints text instead of a telemetry record */
+void func_link_stats(int para_count, char **para)
 {
     (void)para;
     if (para_count != 0)
     {
-        print("error: CRASH takes no parameters\r\n");
+        print("error: LINK_STATS takes no parameters\r\n");
         return;
     }
 
-    print("\r\n[SYSTEM] Simulating deadlock now...\r\n");
-    System_Simulate_Deadlock();
+    LinkStats snap[LINK_STATS_PORTS];
+    link_stats_snapshot(snap);
+    for (uint8_t i = 0; i < LINK_STATS_PORTS; i++)
+    {
+        print("UART%u: ok=%lu csum_err=%lu len_err=%lu rb_overrun=%lu dma_anomaly=%lu resync=%lu dropped=%lu\r\n",
+              (i == 0) ? 1U : 3U,
+              snap[i].frames_ok, snap[i].csum_err, snap[i].len_err,
+              snap[i].rb_overrun, snap[i].dma_anomaly,
+              snap[i].resync, snap[i].dropped_bytes);
+    }
+}
+static int cmd_token_is(const char *tok, const char *ref);
+
+/* RING_STATS [RESET] on the console: one text line per ring */
+void func_ring_stats(int para_count, char **para)
+{
+    uint8_t reset = 0;
+    if ((para_count == 1) && (cmd_token_is(para[0], "RESET")))
+        reset = 1;
+    else if (para_count != 0)
+    {
+        print("error: RING_STATS takes no parameters or RESET\r\n");
+        return;
+    }
+
+    RingStats snap[RING_STATS_MAX];
+    uint8_t n = ring_stats_snapshot(snap);
+    for (uint8_t i = 0; i < n; i++)
+    {
+        const RingStats *r = &snap[i];
+        print("%s: size=%u used=%u high=%u overflows=%lu dropped=%lu hist=%lu/%lu/%lu/%lu/%lu/%lu/%lu/%lu\r\n",
+              r->name, r->size, r->used, r->high_water, r->overflows, r->dropped,
+              r->hist[0], r->hist[1], r->hist[2], r->hist[3],
+              r->hist[4], r->hist[5], r->hist[6], r->hist[7]);
+    }
+    if (reset != 0U)
+        ring_stats_reset();
+}
+void func_batch(int para_count, char **para)
+{
+    (void)para_count; (void)para;
+    print("error: BATCH is a binary (packet link) command\r\n");
 }
 void func_invalid(int para_count, char **para)
 {
@@ -183,19 +332,56 @@ void func_invalid(int para_count, char **para)
     return;
 }
 
-/* ---------- CMD table ---------- */
-static CmdEntry cmd_table[] = {
-    {"LED_ON",     func_led_on},
-    {"LED_OFF",    func_led_off},
-    {"SET_LED",    func_set_led},
-    {"UART_TX",    func_uart_tx},
-    {"PWM_ON",     func_pwm_on},
-    {"CRASH",      func_crash},
-    {"INVALID_CMD",func_invalid},
-};
-
 
 /* ---------- helpers ---------- */
+static inline char cmd_upper(char c)
+{
+    return (c >= 'a' && c <= 'z') ? (char)(c - ('a' - 'A')) : c;
+}
+
+/* Case-insensitive match of a console token against an upper-case word */
+static int cmd_token_is(const char *tok, const char *ref)
+{
+    while (*tok && cmd_upper(*tok) == *ref)
+    {
+        tok++;
+        ref++;
+    }
+    return (*tok == '\0') && (*ref == '\0');
+}
+
+/* Case-insensitive FNV-1a; must match tools/cmdgen/gen_cmd_hash.py */
+static uint32_t cmd_hash_name(const char *s)
+{
+    uint32_t h = CMD_HASH_SEED;
+    while (*s)
+    {
+        h = (h ^ (uint8_t)cmd_upper(*s++)) * 0x01000193u;
+    }
+    return h;
+}
+
+/* O(1) console lookup: one hash pass + one confirming compare */
+static CMD_ID cmd_lookup(const char *name)
+{
+    if (name == NULL)
+        return INVALID_CMD;
+
+    uint32_t h = cmd_hash_name(name);
+    uint8_t d = cmd_hash_disp[h & (CMD_HASH_BUCKETS - 1u)];
+    uint8_t id = cmd_hash_slot[((h >> 16) ^ d) & (CMD_HASH_SLOTS - 1u)];
+    if (id == CMD_HASH_EMPTY)
+        return INVALID_CMD;
+
+    const char *ref = cmd_table[id].cmd_name;
+    while (*name && cmd_upper(*name) == *ref)
+    {
+        name++;
+        ref++;
+    }
+    return (*name == '\0' && *ref == '\0') ? (CMD_ID)id : INVALID_CMD;
+}
+
 static int is_valid_input(char c)
 {
 
@@ -243,29 +429,16 @@ void process_cmd(void)
         /* CMD compare BEGIN */
         const char *delim = " "; // only accept " " for separate parameters
         char *token;
-        char cmd_head[10];
         char *cmd_para[5];
         int para_count = 0;
 
-        print("\r\nTokens:\n\r");
+        TRACE_INFO("\r\nTokens:\n\r");
 
         // First call to get the first token: CMD_HEAD
         token = strtok(cmd_buff, delim);
-        str_to_upper_inplace(token);
-        print("first token is %s\r\n", token);
-        // Check token in CMD_table
-        CmdHandler cmd_handler;
-        int cmd_idx = 0;
-        while (cmd_idx != INVALID_CMD)
-        {
-            if (strcmp(token, cmd_table[cmd_idx].cmd_name) == 0)
-            {
-                strcpy(cmd_head, token);
-                cmd_handler = cmd_table[cmd_idx].handler;
-                break;
-            }
-            cmd_idx++;
-        }
+        TRACE_INFO("first token is %s\r\n", token ? token : "");
+        // Check token in CMD_table (case-insensitive)
+        CMD_ID cmd_idx = cmd_lookup(token);
         if (cmd_idx == INVALID_CMD)
         {
             print("Invalid CMD !\r\n");
@@ -275,10 +448,11 @@ void process_cmd(void)
             return;
         }
 
+        CmdHandler cmd_handler = cmd_table[cmd_idx].handler;
         token = strtok(NULL, delim);
         while (token != NULL)
         {
-            print("next token is %s\r\n", token);
+            TRACE_INFO("next token is %s\r\n", token);
             // Subsequent calls with NULL to get the next tokens: CMD_PARA
             cmd_para[para_count++] = token;
             token = strtok(NULL, delim);
@@ -296,32 +470,35 @@ void process_cmd(void)
     return;
 }
 
-void handle_binary_cmd(uint8_t *payload, uint8_t length)
+/* CMD byte and arg length of one binary command against bin_cmd_table */
+static int bin_cmd_check(const uint8_t *payload, uint16_t length)
 {
+    if (length == 0)
+        return -1;
+
     uint8_t cmd_id = payload[0];
-    uint8_t para_count = length - 1;
+    uint16_t arg_len = length - 1;
 
     if (cmd_id >= INVALID_CMD)
     {
-        print("Binary CMD invalid: %d\r\n", cmd_id);
-        return;
+        TRACE_ERROR("Binary CMD invalid: %d\r\n", cmd_id);
+        return -1;
     }
 
-    char *argv[5];
-    char temp[5][16];
-
-    if (cmd_id == UART_TX)
+    const BinCmdEntry *entry = &bin_cmd_table[cmd_id];
+    if (arg_len < entry->arg_len_min || arg_len > entry->arg_len_max)
     {
-        argv[0] = (char *)&payload[1];
-        cmd_table[cmd_id].handler(para_count, argv);
-        return;
+        TRACE_ERROR("Binary CMD %d: bad arg length %d\r\n", cmd_id, arg_len);
+        return -2;
     }
+    return 0;
+}
 
-    for (int i = 0; i < para_count; i++)
-    {
-        sprintf(temp[i], "%d", payload[1 + i]);
-        argv[i] = temp[i];
-    }
+int handle_binary_cmd(const uint8_t *payload, uint16_t length)
+{
+    int rc = bin_cmd_check(payload, length);
+    if (rc != 0)
+        return rc;
 
-    cmd_table[cmd_id].handler(para_count, argv);
+    return bin_cmd_table[payload[0]].handler(&payload[1], length - 1);
 }
@@ -0,0 +1,130 @@
+/*
+ * cmd_dispatch.c
+ *
+ * Binary command dispatcher task (see cmd_dispatch.h).
+ */
+#include "cmd_dispatch.h"
+
+#include "main.h"
+#include "cmsis_os2.h"
+#include "FreeRTOS.h"
+#include "task.h"
+#include "message_buffer.h"
+#include "semphr.h"
+#include "cmd.h"
+
+/* A message buffer allows one writer at a time, and no FreeRTOS call may
+ * run inside a critical section, so producers are split in two:
+ *  - ISR posts: the UART1/UART3 and RX DMA IRQs share one NVIC priority
+ *    and never nest, so they write g_isr_buf one after the other
+ *  - task posts (RX tasks, ARQ link tasks): serialized by g_task_lock
+ * Each side keeps its own drop counter, the task is woken by notification. */
+static MessageBufferHandle_t g_isr_buf = NULL;
+static MessageBufferHandle_t g_task_buf = NULL;
+static SemaphoreHandle_t g_task_lock = NULL;
+static volatile uint32_t g_dropped_isr = 0U;
+static volatile uint32_t g_dropped_task = 0U;
+
+static osThreadId_t g_dispatch_task_handle;
+
+static const osThreadAttr_t g_dispatch_task_attr = {
+    .name = "cmdDispatch",
+    .priority = (osPriority_t) osPriorityAboveNormal,
+    .stack_size = 256 * 4
+};
+
+static void cmd_dispatch_task(void *argument)
+{
+    (void) argument;
+
+    uint8_t payload[CMD_DISPATCH_MAX_PAYLOAD];
+
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+        size_t len;
+        do
+        {
+            len = xMessageBufferReceive(g_isr_buf, payload, sizeof(payload), 0);
+            if (len > 0U)
+                handle_binary_cmd(payload, (uint16_t) len);
+
+            size_t n = xMessageBufferReceive(g_task_buf, payload, sizeof(payload), 0);
+            if (n > 0U)
+                handle_binary_cmd(payload, (uint16_t) n);
+            len += n;
+        } while (len > 0U);
+    }
+}
+
+void cmd_dispatch_start(void)
+{
+#if (CMD_DISPATCH_TASK_ENABLE != 0)
+    if (g_dispatch_task_handle != NULL)
+        return;
+
+    g_isr_buf = xMessageBufferCreate(CMD_DISPATCH_BUF_SIZE);
+    g_task_buf = xMessageBufferCreate(CMD_DISPATCH_BUF_SIZE);
+    g_task_lock = xSemaphoreCreateMutex();
+    if ((g_isr_buf == NULL) || (g_task_buf == NULL) || (g_task_lock == NULL))
+        return;
+
+    // Producers check g_dispatch_task_handle: publish it last
+    g_dispatch_task_handle = osThreadNew(cmd_dispatch_task, NULL, &g_dispatch_task_attr);
+#endif
+}
+
+int cmd_dispatch_post(const uint8_t *payload, uint16_t len)
+{
+    uint8_t in_isr = (__get_IPSR() != 0U);
+
+    if ((len == 0U) || (len > CMD_DISPATCH_MAX_PAYLOAD))
+    {
+        if (in_isr)
+            g_dropped_isr++;
+        else
+            g_dropped_task++;
+        return -1;
+    }
+
+    if (g_dispatch_task_handle == NULL)
+    {
+        // Dispatcher disabled or not started yet (pre-scheduler loop)
+        handle_binary_cmd(payload, len);
+        return 0;
+    }
+
+    size_t sent;
+    if (in_isr)
+    {
+        BaseType_t woken = pdFALSE;
+        sent = xMessageBufferSendFromISR(g_isr_buf, payload, len, &woken);
+        if (sent == len)
+            vTaskNotifyGiveFromISR((TaskHandle_t) g_dispatch_task_handle, &woken);
+        else
+            g_dropped_isr++;
+        portYIELD_FROM_ISR(woken);
+    }
+    else
+    {
+        // Held only for the copy; never waits for buffer space
+        xSemaphoreTake(g_task_lock, portMAX_DELAY);
+        sent = xMessageBufferSend(g_task_buf, payload, len, 0);
+        if (sent != len)
+            g_dropped_task++;
+        xSemaphoreGive(g_task_lock);
+        if (sent == len)
+            xTaskNotifyGive((TaskHandle_t) g_dispatch_task_handle);
+    }
+
+    if (sent != len)
+        return -1;
+
+    return 0;
+}
+
+uint32_t cmd_dispatch_dropped(void)
+{
+    return g_dropped_isr + g_dropped_task;
+}
@@ -0,0 +1,66 @@
+/*
+ * cobs.c
+ *
+ * Consistent Overhead Byte Stuffing encode/decode.
+ */
+#include "cobs.h"
+
+#include <string.h>   // memmove
+
+size_t cobs_encode(const uint8_t *src, size_t len, uint8_t *dst)
+{
+    size_t code_idx = 0;    // where the current block's code byte goes
+    size_t out = 1;
+    uint8_t code = 1;
+
+    for (size_t i = 0; i < len; i++)
+    {
+        if (src[i] == 0)
+        {
+            dst[code_idx] = code;
+            code_idx = out++;
+            code = 1;
+            continue;
+        }
+
+        dst[out++] = src[i];
+        code++;
+        if (code == 0xFF)
+        {
+            // 254 non-zero bytes: close the block without an implied zero
+            dst[code_idx] = code;
+            code_idx = out++;
+            code = 1;
+        }
+    }
+    dst[code_idx] = code;
+
+    return out;
+}
+
+int cobs_decode(const uint8_t *src, size_t len, uint8_t *dst)
+{
+    size_t in = 0;
+    size_t out = 0;
+
+    while (in < len)
+    {
+        uint8_t code = src[in++];
+        if (code == 0)
+            return -1;
+
+        size_t run = (size_t)(code - 1);
+        if (run > len - in)
+            return -1;
+
+        // dst never runs ahead of src, so in-place decoding is safe
+        memmove(&dst[out], &src[in], run);
+        out += run;
+        in += run;
+
+        if (code != 0xFF && in < len)
+            dst[out++] = 0;
+    }
+
+    return (int)out;
+}
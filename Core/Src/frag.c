@@ -0,0 +1,157 @@
+/*
+ * frag.c
+ *
+ * Fragmentation / reassembly of bulk payloads (see frag.h).
+ */
+#include "frag.h"
+
+#include <string.h>
+
+#include "cmd.h"
+
+_Static_assert(INVALID_CMD < FRAG_CMD, "FRAG_CMD overlaps CMD_ID");
+
+/* ---------- sender ---------- */
+void frag_tx_init(FragTx *t, uint8_t xfer_id, const uint8_t *data, uint16_t len,
+        uint16_t max_payload)
+{
+    t->data = data;
+    t->total = len;
+    t->off = 0;
+    t->chunk = (max_payload > FRAG_HDR_LEN) ? (uint16_t)(max_payload - FRAG_HDR_LEN) : 1U;
+    t->xfer_id = xfer_id;
+}
+
+uint16_t frag_tx_next(FragTx *t, uint8_t *payload)
+{
+    if (t->off >= t->total)
+        return 0;
+
+    uint16_t n = t->total - t->off;
+    if (n > t->chunk)
+        n = t->chunk;
+
+    payload[0] = FRAG_CMD;
+    payload[1] = t->xfer_id;
+    payload[2] = (uint8_t)(t->off & 0xFF);
+    payload[3] = (uint8_t)(t->off >> 8);
+    payload[4] = (uint8_t)(t->total & 0xFF);
+    payload[5] = (uint8_t)(t->total >> 8);
+    memcpy(&payload[FRAG_HDR_LEN], &t->data[t->off], n);
+
+    t->off += n;
+    return (uint16_t)(FRAG_HDR_LEN + n);
+}
+
+/* ---------- receiver ---------- */
+void frag_rx_init(FragRx *r, uint8_t *pool, uint16_t buf_size, uint8_t count,
+        FragDoneFn done, void *ctx)
+{
+    memset(r, 0, sizeof(*r));
+    if (count > FRAG_POOL_MAX)
+        count = FRAG_POOL_MAX;
+
+    for (uint8_t i = 0; i < count; i++)
+    {
+        r->blocks[i].data = &pool[(uint32_t)i * buf_size];
+        r->blocks[i].state = FRAG_BLOCK_FREE;
+    }
+    r->count = count;
+    r->buf_size = buf_size;
+    r->done = done;
+    r->ctx = ctx;
+}
+
+static void frag_abort(FragRx *r)
+{
+    if (r->cur != NULL)
+    {
+        r->cur->state = FRAG_BLOCK_FREE;
+        r->cur = NULL;
+        r->aborted++;
+    }
+}
+
+static FragBlock *frag_take_free(FragRx *r)
+{
+    for (uint8_t i = 0; i < r->count; i++)
+    {
+        if (r->blocks[i].state == FRAG_BLOCK_FREE)
+        {
+            r->blocks[i].state = FRAG_BLOCK_FILLING;
+            return &r->blocks[i];
+        }
+    }
+    return NULL;
+}
+
+int frag_rx_feed(FragRx *r, const uint8_t *payload, uint16_t len)
+{
+    if ((len < FRAG_HDR_LEN) || (payload[0] != FRAG_CMD))
+        return -1;
+
+    uint8_t xfer_id = payload[1];
+    uint16_t off = (uint16_t)(payload[2] | (payload[3] << 8));
+    uint16_t total = (uint16_t)(payload[4] | (payload[5] << 8));
+    uint16_t n = len - FRAG_HDR_LEN;
+
+    if ((r->cur != NULL) && (xfer_id == r->cur->xfer_id) && (total == r->total)
+            && ((uint32_t)off + n <= r->cur->len))
+    {
+        // Already have these bytes: a duplicated or resent fragment
+        r->duplicates++;
+        return 0;
+    }
+
+    if (off == 0U)
+    {
+        // Start of a transfer; anything still in progress is abandoned
+        frag_abort(r);
+        if ((total == 0U) || (total > r->buf_size))
+        {
+            r->aborted++;
+            return -1;
+        }
+        r->cur = frag_take_free(r);
+        if (r->cur == NULL)
+        {
+            r->no_buffer++;
+            return -1;
+        }
+        r->cur->xfer_id = xfer_id;
+        r->cur->len = 0;
+        r->total = total;
+    }
+    else if ((r->cur == NULL) || (xfer_id != r->cur->xfer_id)
+            || (total != r->total) || (off != r->cur->len))
+    {
+        // Out of order, or tail of a transfer we never started
+        frag_abort(r);
+        return -1;
+    }
+
+    if ((uint32_t)off + n > r->total)
+    {
+        frag_abort(r);
+        return -1;
+    }
+
+    memcpy(&r->cur->data[off], &payload[FRAG_HDR_LEN], n);
+    r->cur->len = (uint16_t)(off + n);
+
+    if (r->cur->len < r->total)
+        return 0;
+
+    FragBlock *blk = r->cur;
+    r->cur = NULL;
+    r->completed++;
+    blk->state = FRAG_BLOCK_OWNED;
+    r->done(r->ctx, blk);
+    return 1;
+}
+
+void frag_release(FragRx *r, FragBlock *blk)
+{
+    (void)r;
+    blk->state = FRAG_BLOCK_FREE;
+}
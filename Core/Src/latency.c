@@ -3,8 +3,12 @@
 #include "cmsis_os2.h"
 #include "console.h"
 #include "load_task.h"
+#include "ring_stats.h"
+#include "spsc_ring.h"
+#include "telemetry.h"
 
-#define LATENCY_RING_SIZE 512U
+#define LATENCY_RING_SIZE 512U      // power of two (spsc_ring.h)
+#define LATENCY_DRAIN_BATCH 8U      // samples popped per ring access
 #define LATENCY_STATS_WINDOW 200U
 
 typedef struct
@@ -28,10 +32,20 @@ typedef struct
     uint32_t exec_sum;
 } LatencyStats;
 
-static volatile LatencySample g_ring[LATENCY_RING_SIZE];
-static volatile uint16_t g_head = 0U;
-static volatile uint16_t g_tail = 0U;
-static volatile uint32_t g_overwrite_count = 0U;
+typedef struct
+{
+    uint32_t count;
+    uint16_t exec_min;
+    uint16_t exec_max;
+    uint32_t exec_sum;
+} LatencyProbeStats;
+
+/* TIM3 ISR -> logging task. DROP_OLDEST: a slow log keeps the newest
+ * samples; overwritten ones show up as rb_overwrite in the stats line. */
+SPSC_RING_DEFINE(LatencyRing, latency_ring, LatencySample)
+
+static LatencySample g_ring_slots[LATENCY_RING_SIZE];
+static LatencyRing g_ring;
 
 static TIM_HandleTypeDef *g_tim = NULL;
 static UART_HandleTypeDef *g_log_uart = NULL;
@@ -39,8 +53,44 @@ static UART_HandleTypeDef *g_log_uart = NULL;
 static volatile uint32_t g_seq = 0U;
 static volatile uint16_t g_prev_latency_ticks = 0U;
 
+static volatile LatencyProbeStats g_probe;
+
 static osThreadId_t g_logging_task_handle;
 
+#if (TELEMETRY_BINARY != 0)
+/* Binary counterparts of the latency_log_start line and the CSV row;
+ * latency_us / exec_us are derived on the host from tick_hz. */
+typedef __PACKED_STRUCT
+{
+    uint32_t tick_hz;
+} LatencyStartRecord;
+
+typedef __PACKED_STRUCT
+{
+    uint32_t seq;
+    uint32_t systick_ms;
+    uint8_t load_active;
+    uint16_t latency_ticks;
+    uint16_t exec_ticks;
+    int16_t latency_delta_ticks;
+} LatencySampleRecord;
+
+static const TelemType g_start_type = {
+    .name = "lat_start",
+    .fields = "tick_hz:I",
+    .size = sizeof(LatencyStartRecord)
+};
+
+static const TelemType g_sample_type = {
+    .name = "lat_sample",
+    .fields = "seq:I,systick_ms:I,load_active:B,latency_ticks:H,exec_ticks:H,latency_delta_ticks:h",
+    .size = sizeof(LatencySampleRecord)
+};
+
+static int g_start_id = -1;
+static int g_sample_id = -1;
+#endif
+
 static const osThreadAttr_t g_logging_task_attr = {
     .name = "latLogTask",
     .priority = (osPriority_t) osPriorityNormal,
@@ -62,34 +112,23 @@ static uint32_t latency_get_timer_clk_hz(TIM_HandleTypeDef *htim)
     return pclk;
 }
 
-static void latency_push_from_isr(const LatencySample *sample)
+/* TIM3 ticks from entry_cnt to exit_cnt, across at most one reload */
+static uint16_t latency_elapsed_ticks(uint16_t entry_cnt, uint16_t exit_cnt, uint16_t arr)
 {
-    uint16_t next_head = (uint16_t) ((g_head + 1U) % LATENCY_RING_SIZE);
-
-    if (next_head == g_tail)
+    if (exit_cnt >= entry_cnt)
     {
-        g_tail = (uint16_t) ((g_tail + 1U) % LATENCY_RING_SIZE);
-        g_overwrite_count++;
+        return (uint16_t) (exit_cnt - entry_cnt);
     }
 
-    g_ring[g_head] = *sample;
-    g_head = next_head;
+    return (uint16_t) (exit_cnt + (arr + 1U) - entry_cnt);
 }
 
-static uint8_t latency_pop(LatencySample *sample)
+static void latency_probe_reset(void)
 {
-    uint8_t has_data;
-
-    __disable_irq();
-    has_data = (g_head != g_tail) ? 1U : 0U;
-    if (has_data != 0U)
-    {
-        *sample = g_ring[g_tail];
-        g_tail = (uint16_t) ((g_tail + 1U) % LATENCY_RING_SIZE);
-    }
-    __enable_irq();
-
-    return has_data;
+    g_probe.count = 0U;
+    g_probe.exec_min = 0xFFFFU;
+    g_probe.exec_max = 0U;
+    g_probe.exec_sum = 0U;
 }
 
 static void latency_stats_init(LatencyStats *stats)
@@ -146,20 +185,50 @@ static void latency_logging_task(void *argument)
     print("# latency_log_start,timer=%s,tick_hz=%lu\r\n",
           (g_tim->Instance == TIM3) ? "TIM3" : "UNKNOWN",
           tick_hz);
+#if (TELEMETRY_BINARY != 0)
+    telemetry_init(g_log_uart);
+    g_start_id = telemetry_register(&g_start_type);
+    g_sample_id = telemetry_register(&g_sample_type);
+
+    LatencyStartRecord start = { .tick_hz = tick_hz };
+    (void) telemetry_send(g_start_id, &start, sizeof(start));
+#else
     print("seq,systick_ms,load_active,latency_ticks,latency_us,exec_ticks,exec_us,latency_delta_ticks\r\n");
+#endif
+
+    LatencySample batch[LATENCY_DRAIN_BATCH];
+    uint16_t batch_len = 0U;
+    uint16_t batch_pos = 0U;
 
     for (;;)
     {
-        LatencySample sample;
-
-        if (latency_pop(&sample) == 0U)
+        if (batch_pos == batch_len)
         {
-            osDelay(10U);
-            continue;
+            latency_ring_sample(&g_ring);
+            batch_len = latency_ring_read(&g_ring, batch, LATENCY_DRAIN_BATCH);
+            batch_pos = 0U;
+            if (batch_len == 0U)
+            {
+                osDelay(10U);
+                continue;
+            }
         }
 
+        LatencySample sample = batch[batch_pos++];
+
         latency_stats_update(&stats, &sample);
 
+#if (TELEMETRY_BINARY != 0)
+        LatencySampleRecord rec = {
+            .seq = sample.seq,
+            .systick_ms = sample.systick_ms,
+            .load_active = sample.load_active,
+            .latency_ticks = sample.latency_ticks,
+            .exec_ticks = sample.exec_ticks,
+            .latency_delta_ticks = sample.latency_delta_ticks
+        };
+        (void) telemetry_send(g_sample_id, &rec, sizeof(rec));
+#else
         uint32_t latency_us_x1000 = (uint32_t) (((uint64_t) sample.latency_ticks * 1000000000ULL) / tick_hz);
         uint32_t exec_us_x1000 = (uint32_t) (((uint64_t) sample.exec_ticks * 1000000000ULL) / tick_hz);
 
@@ -174,12 +243,13 @@ static void latency_logging_task(void *argument)
               exec_us_x1000 / 1000U,
               exec_us_x1000 % 1000U,
               sample.latency_delta_ticks);
+#endif
 
         if (stats.count >= LATENCY_STATS_WINDOW)
         {
             uint32_t latency_avg_x1000 = (stats.latency_sum * 1000U) / stats.count;
             uint32_t exec_avg_x1000 = (stats.exec_sum * 1000U) / stats.count;
-            uint32_t overwrite_snapshot = g_overwrite_count;
+            uint32_t overwrite_snapshot = latency_ring_dropped(&g_ring);
 
             print("# stats,window=%lu,load_active=%u,latency_min=%u,latency_max=%u,latency_avg=%lu.%03lu,exec_min=%u,exec_max=%u,exec_avg=%lu.%03lu,rb_overwrite=%lu\r\n",
                   stats.count,
@@ -195,6 +265,30 @@ static void latency_logging_task(void *argument)
                   overwrite_snapshot);
 
             latency_stats_init(&stats);
+
+#if (TELEMETRY_BINARY != 0)
+            /* Lets a host that attached mid-run pick up the layouts */
+            telemetry_announce();
+            (void) telemetry_send(g_start_id, &start, sizeof(start));
+#endif
+
+            LatencyProbeStats probe;
+            __disable_irq();
+            probe = g_probe;
+            latency_probe_reset();
+            __enable_irq();
+
+            if (probe.count > 0U)
+            {
+                uint32_t probe_avg_x1000 = (probe.exec_sum * 1000U) / probe.count;
+
+                print("# isr_probe,count=%lu,exec_min=%u,exec_max=%u,exec_avg=%lu.%03lu\r\n",
+                      probe.count,
+                      probe.exec_min,
+                      probe.exec_max,
+                      probe_avg_x1000 / 1000U,
+                      probe_avg_x1000 % 1000U);
+            }
         }
     }
 }
@@ -203,11 +297,11 @@ void latency_init(TIM_HandleTypeDef *timer_handle, UART_HandleTypeDef *log_uart)
 {
     g_tim = timer_handle;
     g_log_uart = log_uart;
-    g_head = 0U;
-    g_tail = 0U;
-    g_overwrite_count = 0U;
+    (void) latency_ring_init(&g_ring, g_ring_slots, LATENCY_RING_SIZE, SPSC_RING_DROP_OLDEST);
+    (void) ring_stats_attach_spsc("latency", &g_ring.ring);
     g_seq = 0U;
     g_prev_latency_ticks = 0U;
+    latency_probe_reset();
 }
 
 void latency_on_tim_period_elapsed_isr(TIM_HandleTypeDef *htim)
@@ -230,18 +324,11 @@ void latency_on_tim_period_elapsed_isr(TIM_HandleTypeDef *htim)
     sample.latency_delta_ticks = (int16_t) ((int32_t) entry_cnt - (int32_t) g_prev_latency_ticks);
 
     uint16_t exit_cnt = __HAL_TIM_GET_COUNTER(htim);
-    if (exit_cnt >= entry_cnt)
-    {
-        sample.exec_ticks = (uint16_t) (exit_cnt - entry_cnt);
-    }
-    else
-    {
-        sample.exec_ticks = (uint16_t) (exit_cnt + (arr + 1U) - entry_cnt);
-    }
+    sample.exec_ticks = latency_elapsed_ticks(entry_cnt, exit_cnt, arr);
 
     g_prev_latency_ticks = entry_cnt;
 
-    latency_push_from_isr(&sample);
+    (void) latency_ring_push(&g_ring, &sample);
 }
 
 void latency_start_logging_task(void)
@@ -251,3 +338,36 @@ void latency_start_logging_task(void)
         g_logging_task_handle = osThreadNew(latency_logging_task, NULL, &g_logging_task_attr);
     }
 }
+
+uint16_t latency_probe_enter(void)
+{
+    if (g_tim == NULL)
+    {
+        return 0U;
+    }
+
+    return (uint16_t) __HAL_TIM_GET_COUNTER(g_tim);
+}
+
+void latency_probe_exit(uint16_t entry_cnt)
+{
+    if (g_tim == NULL)
+    {
+        return;
+    }
+
+    uint16_t exit_cnt = __HAL_TIM_GET_COUNTER(g_tim);
+    uint16_t exec = latency_elapsed_ticks(entry_cnt, exit_cnt, __HAL_TIM_GET_AUTORELOAD(g_tim));
+
+    /* Probed ISRs share NVIC priority 3 with TIM3, so updates never nest. */
+    if (exec < g_probe.exec_min)
+    {
+        g_probe.exec_min = exec;
+    }
+    if (exec > g_probe.exec_max)
+    {
+        g_probe.exec_max = exec;
+    }
+    g_probe.exec_sum += exec;
+    g_probe.count++;
+}
@@ -0,0 +1,96 @@
+/*
+ * link_stats.c
+ *
+ * Per-port RX link health counters (see link_stats.h).
+ */
+#include "link_stats.h"
+
+#include <string.h>
+
+#include "main.h"
+#include "telemetry.h"
+
+typedef struct
+{
+    const PacketParser *parser;
+    const PacketCobsParser *cobs;
+    const BipBuf *bip;
+    const volatile uint32_t *dma_anomaly;
+} LinkStatsSource;
+
+static LinkStatsSource g_src[LINK_STATS_PORTS];
+
+#define LINK_STATS_FIELDS(p, end)                           \
+    p "frames_ok:I," p "csum_err:I," p "len_err:I,"         \
+    p "rb_overrun:I," p "dma_anomaly:I," p "resync:I,"      \
+    p "dropped_bytes:I" end
+
+static const TelemType g_stats_type = {
+    .name = "link_stats",
+    .fields = LINK_STATS_FIELDS("u1_", ",") LINK_STATS_FIELDS("u3_", ""),
+    .size = sizeof(LinkStats) * LINK_STATS_PORTS
+};
+
+static int g_stats_id = -1;
+
+void link_stats_attach(uint8_t port, const PacketParser *parser,
+        const PacketCobsParser *cobs, const BipBuf *bip,
+        const volatile uint32_t *dma_anomaly)
+{
+    if (port >= LINK_STATS_PORTS)
+        return;
+
+    g_src[port].parser = parser;
+    g_src[port].cobs = cobs;
+    g_src[port].bip = bip;
+    g_src[port].dma_anomaly = dma_anomaly;
+}
+
+void link_stats_snapshot(LinkStats *out)
+{
+    memset(out, 0, sizeof(LinkStats) * LINK_STATS_PORTS);
+
+    // Counters are written by the RX ISR: mask it for a consistent set
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    for (uint8_t i = 0; i < LINK_STATS_PORTS; i++)
+    {
+        const LinkStatsSource *s = &g_src[i];
+        LinkStats *o = &out[i];
+
+        if (s->parser != NULL)
+        {
+            o->frames_ok += s->parser->frames_ok;
+            o->csum_err += s->parser->csum_err;
+            o->len_err += s->parser->len_err;
+            o->resync = s->parser->resync_count;
+            o->dropped_bytes = s->parser->dropped_bytes;
+        }
+        if (s->cobs != NULL)
+        {
+            o->frames_ok += s->cobs->frames_ok;
+            o->csum_err += s->cobs->csum_err;
+            o->len_err += s->cobs->len_err;
+        }
+        if (s->bip != NULL)
+            o->rb_overrun = s->bip->dropped;
+        if (s->dma_anomaly != NULL)
+            o->dma_anomaly = *s->dma_anomaly;
+    }
+
+    __set_PRIMASK(primask);
+}
+
+void link_stats_telemetry_init(void)
+{
+    g_stats_id = telemetry_register(&g_stats_type);
+}
+
+int link_stats_report(void)
+{
+    LinkStats snap[LINK_STATS_PORTS];
+
+    link_stats_snapshot(snap);
+    return telemetry_send(g_stats_id, snap, sizeof(snap));
+}
@@ -27,12 +27,20 @@
 #include <stdarg.h> // Required for variable argument handling
 #include <stdlib.h>
 #include "console.h"
-#include "uart_rb.h"
 #include "packet.h"
 #include "cmd.h"
 #include "uart_test.h"
 #include "watchdog.h"
 #include "experiments.h"
+#include "cmd_dispatch.h"
+#include "uart_rx.h"
+#include "uart_rx_task.h"
+#include "arq_link.h"
+#include "frag.h"
+#include "packet_tx.h"
+#include "telemetry.h"
+#include "link_stats.h"
+#include "ring_stats.h"
 
 #if (EXPERIMENT_PHASE2_ENABLE != 0)
 #include "phase2_pi.h"
@@ -54,8 +62,28 @@
 /* USER CODE BEGIN PD */
 
 /* Avoid UART TX/printf inside ISR by default (can cause watchdog resets). */
-#ifndef UART_IDLE_DEBUG_PRINT
-#define UART_IDLE_DEBUG_PRINT 0
+#ifndef UART_RX_EVENT_DEBUG_PRINT
+#define UART_RX_EVENT_DEBUG_PRINT 0
+#endif
+
+/* UART_RX_ZERO_COPY / UART_LINK_COBS / UART_RX_TASK: RX path switches, see uart_rx.h */
+
+/* UART1/UART3 PacketParser frame capacity: the largest CMD + PAYLOAD the
+ * dispatcher accepts (BATCH frames), in v2 framing */
+#define UART_LINK_FRAME_CAP PKT_V2_FRAME_SIZE(CMD_DISPATCH_MAX_PAYLOAD)
+
+/* 1: FRAG_CMD frames on UART1/UART3 are reassembled (frag.h) (default)
+ * 0: they reach the dispatcher and are rejected as unknown commands */
+#ifndef UART_LINK_FRAG
+#define UART_LINK_FRAG 1
+#endif
+
+/* Reassembly pool per port: largest bulk transfer and buffers in flight */
+#ifndef UART_LINK_FRAG_BUF_SIZE
+#define UART_LINK_FRAG_BUF_SIZE 512U
+#endif
+#ifndef UART_LINK_FRAG_POOL
+#define UART_LINK_FRAG_POOL 2U
 #endif
 
 /* USER CODE END PD */
@@ -132,47 +160,93 @@ volatile uint16_t uart3_len = 0;
 volatile uint8_t uart1_ready = 0;
 volatile uint8_t uart3_ready = 0;
 
-static RingBuffer rb_uart1;
-static RingBuffer rb_uart3;
+static BipBuf bip_uart1;
+static BipBuf bip_uart3;
+static uint8_t bip_uart1_buf[UART_RX_BIP_SIZE];
+static uint8_t bip_uart3_buf[UART_RX_BIP_SIZE];
 
 static PacketParser parser1;
 static PacketParser parser3;
+static uint8_t parser1_buf[UART_LINK_FRAME_CAP];
+static uint8_t parser3_buf[UART_LINK_FRAME_CAP];
+
+static PacketCobsParser cobs1;
+static PacketCobsParser cobs3;
+
+/* DMA buffer -> (ring) -> parser path of each port */
+static UartRxPort uart1_rx;
+static UartRxPort uart3_rx;
 
-/* Helper: drain ring buffer to parser
- * max_bytes = 0 for unlimited drain in main loop
- * use a small cap (e.g., 32) when called from interrupt context */
-static inline void drain_rb_parser(RingBuffer *rb, PacketParser *parser, uint16_t max_bytes)
+/* Frame handler context of each port */
+typedef struct
 {
-    uint8_t ch;
-    uint16_t count = 0;
-    while (rb_pop(rb, &ch))
+    uint8_t port;               // 1 or 3
+#if (ARQ_ENABLE != 0)
+    ArqLink arq;
+#endif
+#if (UART_LINK_FRAG != 0)
+    FragRx frag;
+    uint8_t frag_pool[UART_LINK_FRAG_POOL * UART_LINK_FRAG_BUF_SIZE];
+#endif
+} UartLink;
+
+static UartLink uart1_link = { .port = 1 };
+static UartLink uart3_link = { .port = 3 };
+
+/* In-order CMD + PAYLOAD of a UART1/UART3 link: bulk fragments go to the
+ * port's reassembler, everything else runs in the command dispatcher task.
+ * Called from the RX path, or from the ARQ link task for v2 frames. */
+static void uart_link_on_payload(void *ctx, const uint8_t *payload, uint16_t len)
+{
+    UartLink *link = (UartLink *)ctx;
+#if (UART_LINK_FRAG != 0)
+    if ((len > 0U) && (payload[0] == FRAG_CMD))
     {
-        packet_parser_feed(parser, ch);
-        if (max_bytes && (++count >= max_bytes))
-            break;
+        frag_rx_feed(&link->frag, payload, len);
+        return;
     }
+#endif
+    (void)link;
+    cmd_dispatch_post(payload, len);
 }
 
-void uart_init_dma(void)
+/* Completed bulk transfer. Nothing on the board consumes bulk data yet:
+ * FragRx counts it and the buffer goes straight back to the pool. */
+#if (UART_LINK_FRAG != 0)
+static void uart_link_on_block(void *ctx, FragBlock *blk)
 {
-    print("********** Start uart_init_dma... **********\r\n");
-    HAL_UART_Receive_DMA(&huart1, uart1_rx_buf, RX_BUF_SIZE);
-    print("UART1 DMA RX started\r\n");
-
-    HAL_UART_Receive_DMA(&huart3, uart3_rx_buf, RX_BUF_SIZE);
-    print("UART3 DMA RX started\r\n");
+    UartLink *link = (UartLink *)ctx;
+    frag_release(&link->frag, blk);
+}
+#endif
 
-    __HAL_UART_ENABLE_IT(&huart1, UART_IT_IDLE);
-    print("UART1 IDLE enabled\r\n");
+/* Completed UART1/UART3 frames. With ARQ_ENABLE, v2 frames go to the port's
+ * ARQ link, which hands them back in order through uart_link_on_payload();
+ * v1 frames bypass the link and only carry commands (one writer per FragRx). */
+static void uart_link_on_frame(void *ctx, const PacketFrame *frame)
+{
+    UartLink *link = (UartLink *)ctx;
+#if (ARQ_ENABLE != 0)
+    if (frame->version == 2U)
+    {
+        arq_link_post_rx(&link->arq, frame);
+        return;
+    }
+    cmd_dispatch_post(frame->payload, frame->len);
+#else
+    uart_link_on_payload(link, frame->payload, frame->len);
+#endif
+}
 
-    __HAL_UART_ENABLE_IT(&huart3, UART_IT_IDLE);
-    print("UART3 IDLE enabled\r\n");
+void uart_init_dma(void)
+{
+    print("********** Start uart_init_dma... **********\r\n");
+    // Circular DMA with HT, TC and IDLE events (HAL_UARTEx_RxEventCallback)
+    HAL_UARTEx_ReceiveToIdle_DMA(&huart1, uart1_rx_buf, RX_BUF_SIZE);
+    print("UART1 DMA RX (to idle) started\r\n");
 
-//    __HAL_DMA_ENABLE_IT(huart1.hdmarx, DMA_IT_HT);
-//    __HAL_DMA_ENABLE_IT(huart1.hdmarx, DMA_IT_TC);
-//
-//    __HAL_DMA_ENABLE_IT(huart3.hdmarx, DMA_IT_HT);
-//    __HAL_DMA_ENABLE_IT(huart3.hdmarx, DMA_IT_TC);
+    HAL_UARTEx_ReceiveToIdle_DMA(&huart3, uart3_rx_buf, RX_BUF_SIZE);
+    print("UART3 DMA RX (to idle) started\r\n");
 
     print("**********End of uart_init_dma **********\r\n");
 }
@@ -184,98 +258,55 @@ void uart_send(UART_HandleTypeDef *huart, const char *msg)
     HAL_UART_Transmit(huart, (uint8_t*) msg, strlen(msg), HAL_MAX_DELAY);
 }
 
-/* ---------- IDLE callback (no TX) ---------- */
-void HAL_UART_IDLE_Callback(UART_HandleTypeDef *huart)
+/* ---------- RX event callback (no TX) ---------- */
+static UartRxPort *uart_rx_port_of(UART_HandleTypeDef *huart)
 {
-  #if (UART_IDLE_DEBUG_PRINT != 0)
-    print("\r\n ===== HAL_UART_IDLE_Callback by %d  =====\r\n\r\n",
-                huart->Instance == USART1 ? 1 : 3);
-  #endif
-    __HAL_UART_CLEAR_IDLEFLAG(huart);
-    // Use pure circular DMA: compute current write position and process only new bytes
-    uint16_t cur_pos = RX_BUF_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx);
-    static uint16_t last_pos_uart1 = 0;
-    static uint16_t last_pos_uart3 = 0;
-
-    if (cur_pos > RX_BUF_SIZE)
-        return;
-
     if (huart->Instance == USART1)
+        return &uart1_rx;
+    if (huart->Instance == USART3)
+        return &uart3_rx;
+    return NULL;
+}
+
+static void uart_rx_event_handle(UART_HandleTypeDef *huart, uint16_t pos)
+{
+  #if (UART_RX_EVENT_DEBUG_PRINT != 0)
+    print("\r\n ===== HAL_UARTEx_RxEventCallback by %d, type %lu, pos %u  =====\r\n\r\n",
+                huart->Instance == USART1 ? 1 : 3,
+                (unsigned long)HAL_UARTEx_GetRxEventType(huart), pos);
+  #endif
+    UartRxPort *port = uart_rx_port_of(huart);
+    if (port != NULL)
     {
-        uint16_t last = last_pos_uart1;
-        if (cur_pos != last)
-        {
-            if (cur_pos > last)
-            {
-                for (uint16_t i = last; i < cur_pos; i++)
-                    rb_push(&rb_uart1, uart1_rx_buf[i]);
-            }
-            else
-            {
-                for (uint16_t i = last; i < RX_BUF_SIZE; i++)
-                    rb_push(&rb_uart1, uart1_rx_buf[i]);
-                for (uint16_t i = 0; i < cur_pos; i++)
-                    rb_push(&rb_uart1, uart1_rx_buf[i]);
-            }
-            last_pos_uart1 = cur_pos;
-            // Drain a small batch in ISR context to improve responsiveness
-            drain_rb_parser(&rb_uart1, &parser1, 32);
-        }
-    }
-    else if (huart->Instance == USART3)
-    {
-        uint16_t last = last_pos_uart3;
-        if (cur_pos != last)
-        {
-            if (cur_pos > last)
-            {
-                for (uint16_t i = last; i < cur_pos; i++)
-                    rb_push(&rb_uart3, uart3_rx_buf[i]);
-            }
-            else
-            {
-                for (uint16_t i = last; i < RX_BUF_SIZE; i++)
-                    rb_push(&rb_uart3, uart3_rx_buf[i]);
-                for (uint16_t i = 0; i < cur_pos; i++)
-                    rb_push(&rb_uart3, uart3_rx_buf[i]);
-            }
-            last_pos_uart3 = cur_pos;
-            // Drain a small batch in ISR context to improve responsiveness
-            drain_rb_parser(&rb_uart3, &parser3, 32);
-        }
+        uart_rx_on_event(port, pos, (uint16_t)__HAL_DMA_GET_COUNTER(huart->hdmarx));
     }
 }
 
-//void HAL_UART_IDLE_Callback(UART_HandleTypeDef *huart)
-//{
-//    print("\r\n ===== HAL_UART_IDLE_Callback by %d  =====\r\n\r\n",
-//            huart->Instance == USART1 ? 1 : 3);
-//    __HAL_UART_CLEAR_IDLEFLAG(huart);
-//
-//    uint16_t cnt = RX_BUF_SIZE - __HAL_DMA_GET_COUNTER(huart->hdmarx);
-//    static uint16_t cur_uart1_rx_buf_idx = 0UL;
-//    static uint16_t cur_uart3_rx_buf_idx = 0UL;
-//
-//    if (cnt == 0)
-//        return;
-//
-//    if (huart->Instance == USART1)
-//    {
-//        for (; cur_uart1_rx_buf_idx < cnt; cur_uart1_rx_buf_idx++)
-//        {
-//            rb_push(&rb_uart1, uart1_rx_buf[cur_uart1_rx_buf_idx]);
-//        }
-//        HAL_UART_Receive_DMA(huart, uart1_rx_buf, RX_BUF_SIZE);
-//    }
-//    else if (huart->Instance == USART3)
-//    {
-//        for (; cur_uart3_rx_buf_idx < cnt; cur_uart3_rx_buf_idx++)
-//        {
-//            rb_push(&rb_uart3, uart3_rx_buf[cur_uart3_rx_buf_idx]);
-//        }
-//        HAL_UART_Receive_DMA(huart, uart3_rx_buf, RX_BUF_SIZE);
-//    }
-//}
+/* Half transfer, transfer complete or IDLE of UART1/UART3 reception */
+void HAL_UARTEx_RxEventCallback(UART_HandleTypeDef *huart, uint16_t Size)
+{
+  #if (EXPERIMENT_PHASE1_ENABLE != 0)
+    /* ISR exec time, reported by the Phase1 logging task as "# isr_probe" */
+    uint16_t probe_cnt = latency_probe_enter();
+    uart_rx_event_handle(huart, Size);
+    latency_probe_exit(probe_cnt);
+  #else
+    uart_rx_event_handle(huart, Size);
+  #endif
+}
+
+/* A UART error (framing, noise, overrun) aborts a DMA reception in HAL:
+ * start it again, the DMA restarts at the beginning of the buffer */
+void HAL_UART_ErrorCallback(UART_HandleTypeDef *huart)
+{
+    UartRxPort *port = uart_rx_port_of(huart);
+    // TX errors land here too; only a stopped reception is restarted
+    if ((port == NULL) || (huart->RxState != HAL_UART_STATE_READY))
+        return;
+
+    uart_rx_restart(port);
+    HAL_UARTEx_ReceiveToIdle_DMA(huart, port->dma_buf, port->dma_size);
+}
 
 /* USER CODE END 0 */
 
@@ -316,6 +347,12 @@ int main(void)
   MX_TIM3_Init();
   /* USER CODE BEGIN 2 */
     console_init(&huart2);
+    telemetry_init(&huart2);
+    /* Reply record types, registered once here rather than lazily from the
+     * dispatcher task while latency.c may be announcing the table */
+    cmd_telemetry_init();
+    link_stats_telemetry_init();
+    ring_stats_telemetry_init();
 
     /* Level 3: check reset reason early (after console is ready). */
     System_Check_Reset_Reason();
@@ -333,10 +370,40 @@ int main(void)
 
     uart_init_dma();
     // Initialize ring buffers and streaming parsers for UART1/3
-    rb_init(&rb_uart1);
-    rb_init(&rb_uart3);
-    packet_parser_init(&parser1);
-    packet_parser_init(&parser3);
+    bipbuf_init(&bip_uart1, bip_uart1_buf, sizeof(bip_uart1_buf));
+    bipbuf_init(&bip_uart3, bip_uart3_buf, sizeof(bip_uart3_buf));
+    packet_parser_init_buf(&parser1, parser1_buf, sizeof(parser1_buf));
+    packet_parser_init_buf(&parser3, parser3_buf, sizeof(parser3_buf));
+    packet_parser_set_resync(&parser1, 1);
+    packet_parser_set_resync(&parser3, 1);
+    packet_cobs_init(&cobs1);
+    packet_cobs_init(&cobs3);
+#if (UART_LINK_FRAG != 0)
+    frag_rx_init(&uart1_link.frag, uart1_link.frag_pool, UART_LINK_FRAG_BUF_SIZE,
+            UART_LINK_FRAG_POOL, uart_link_on_block, &uart1_link);
+    frag_rx_init(&uart3_link.frag, uart3_link.frag_pool, UART_LINK_FRAG_BUF_SIZE,
+            UART_LINK_FRAG_POOL, uart_link_on_block, &uart3_link);
+#endif
+#if (ARQ_ENABLE != 0)
+    arq_link_set_deliver(&uart1_link.arq, uart_link_on_payload, &uart1_link);
+    arq_link_set_deliver(&uart3_link.arq, uart_link_on_payload, &uart3_link);
+#endif
+    packet_parser_set_handler(&parser1, uart_link_on_frame, &uart1_link);
+    packet_parser_set_handler(&parser3, uart_link_on_frame, &uart3_link);
+    packet_cobs_set_handler(&cobs1, uart_link_on_frame, &uart1_link);
+    packet_cobs_set_handler(&cobs3, uart_link_on_frame, &uart3_link);
+    uart_rx_port_init(&uart1_rx, uart1_rx_buf, RX_BUF_SIZE, &bip_uart1, &parser1, &cobs1);
+    uart_rx_port_init(&uart3_rx, uart3_rx_buf, RX_BUF_SIZE, &bip_uart3, &parser3, &cobs3);
+    uart_rx_set_dma_counter(&uart1_rx, &huart1.hdmarx->Instance->CNDTR);
+    uart_rx_set_dma_counter(&uart3_rx, &huart3.hdmarx->Instance->CNDTR);
+    link_stats_attach(0, &parser1, &cobs1, &bip_uart1, &uart1_rx.dma_anomaly);
+    link_stats_attach(1, &parser3, &cobs3, &bip_uart3, &uart3_rx.dma_anomaly);
+    ring_stats_attach_bip("uart1_bip", &bip_uart1);
+    ring_stats_attach_bip("uart3_bip", &bip_uart3);
+#if (SPSC_RING_STATS != 0)
+    ring_stats_attach("uart1_dma", RX_BUF_SIZE, &uart1_rx.dma_stats);
+    ring_stats_attach("uart3_dma", RX_BUF_SIZE, &uart3_rx.dma_stats);
+#endif
 
   #if (EXPERIMENT_PHASE1_ENABLE != 0)
     latency_init(&htim3, &huart2);
@@ -361,6 +428,9 @@ int main(void)
 //        // CMD_STICKY
 //        uart_test_run(UART_TEST_CMD_STICKY);
 //
+//        // CMD_BATCH
+//        uart_test_run(UART_TEST_CMD_BATCH);
+//
 //        // UART_TEST_CONTINUOUS_STREAM
 //        uart_test_run(UART_TEST_CONTINUOUS_STREAM);
 
@@ -375,10 +445,6 @@ int main(void)
       /* Level 1: keep feeding watchdog in the main processing loop. */
       Watchdog_Refresh();
 
-        // Unbounded drain in main loop for steady parsing
-//        drain_rb_parser(&rb_uart1, &parser1, 0);
-//        drain_rb_parser(&rb_uart3, &parser3, 0);
-
         if (uart1_ready)
         {
 
@@ -441,6 +507,21 @@ int main(void)
 
   /* USER CODE BEGIN RTOS_THREADS */
   /* add threads, ... */
+  cmd_dispatch_start();
+
+  #if (UART_RX_TASK != 0)
+  uart_rx_task_start(&uart1_rx, "rxUart1");
+  uart_rx_task_start(&uart3_rx, "rxUart3");
+  #endif
+
+  #if (ARQ_ENABLE != 0)
+  arq_link_start(&uart1_link.arq, "arqUart1", &huart1, UART_LINK_COBS);
+  arq_link_start(&uart3_link.arq, "arqUart3", &huart3, UART_LINK_COBS);
+  #if (UART_TEST_ARQ != 0)
+  uart_test_arq_start(&uart3_link.arq, &uart1_link.arq);
+  #endif
+  #endif
+
   #if (EXPERIMENT_PHASE1_ENABLE != 0)
   load_task_start();
   latency_start_logging_task();
@@ -834,6 +915,12 @@ static void MX_GPIO_Init(void)
 
 /* USER CODE BEGIN 4 */
 
+/* UART1/UART3 TX DMA done: continue the packet_tx ring */
+void HAL_UART_TxCpltCallback(UART_HandleTypeDef *huart)
+{
+    packet_tx_on_tx_complete(huart);
+}
+
 void HAL_UART_RxCpltCallback(UART_HandleTypeDef *huart)
 {
 
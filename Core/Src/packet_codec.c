@@ -0,0 +1,749 @@
+/*
+ * packet_codec.c
+ *
+ * HAL-free packet codec (see packet_codec.h).
+ */
+#include "packet_codec.h"
+
+#include <string.h>   // memcpy, memset, memchr
+#include <stddef.h>   // NULL
+#include "crc16.h"  // crc16_ccitt()
+#include "cobs.h"   // cobs_encode(), cobs_decode()
+#include "pkt_scan.h"   // pkt_find_header(), pkt_sum8()
+
+#define TRACE_MODULE PACKET
+#include "trace.h"
+
+#if (TRACE_LEVEL_PACKET < TRACE_LEVEL_DEBUG)
+/* Below DEBUG the codec and parser must not format anything: any direct
+ * print()/printf-family call left in this file fails to compile. */
+#pragma GCC poison print printf sprintf snprintf vsnprintf
+#endif
+
+/* Per-frame hex dumps (build/parse) */
+#if (TRACE_LEVEL_PACKET >= TRACE_LEVEL_DEBUG)
+#define PKT_TRACE_FRAME(buf, len, msg) print_packet((buf), (len), (msg))
+#else
+#define PKT_TRACE_FRAME(buf, len, msg) ((void)0)
+#endif
+
+void packet_parser_init(PacketParser *p)
+{
+    packet_parser_init_buf(p, p->buf_default, sizeof(p->buf_default));
+}
+
+void packet_parser_init_buf(PacketParser *p, uint8_t *buf, uint16_t cap)
+{
+    p->state = PKT_WAIT_HEADER; // Start by waiting for the header
+    p->buf = buf;
+    p->cap = cap;
+    p->idx = 0;                 // Reset buffer index
+    p->payload_len = 0;         // Reset payload length
+    p->version = 1;
+    p->seq = 0;
+    memset(p->buf, 0, p->cap);  // Optionally clear the buffer
+    p->resync = 0;
+    p->resync_count = 0;
+    p->dropped_bytes = 0;
+    p->recovered_frames = 0;
+    p->inplace = 1;
+    p->inplace_frames = 0;
+    p->frames_ok = 0;
+    p->csum_err = 0;
+    p->len_err = 0;
+    p->handler = packet_default_handler;
+    p->handler_ctx = NULL;
+}
+
+void packet_parser_set_resync(PacketParser *p, uint8_t enable)
+{
+    p->resync = enable ? 1 : 0;
+}
+
+void packet_parser_set_inplace(PacketParser *p, uint8_t enable)
+{
+    p->inplace = enable ? 1 : 0;
+}
+
+void packet_parser_set_handler(PacketParser *p, PacketFrameHandler handler, void *ctx)
+{
+    p->handler = (handler != NULL) ? handler : packet_default_handler;
+    p->handler_ctx = ctx;
+}
+
+
+/* ----------------------
+ * Hex dump utility
+ * ---------------------- */
+void print_packet(uint8_t *buf, uint16_t len, const char *msg)
+{
+    TRACE_DEBUG("%s (%d bytes): ", msg, len);
+    for (uint16_t i = 0; i < len; i++)
+    {
+        TRACE_DEBUG("%02X ", buf[i]);
+    }
+    TRACE_DEBUG("\r\n");
+}
+
+/* ----------------------
+ * Build packet
+ * ---------------------- */
+uint8_t build_packet(uint8_t *buf, CMD_ID cmd_enum, uint8_t *params,
+        uint8_t param_len)
+{
+    uint8_t idx = 0;
+    buf[idx++] = CMD_HEADER;
+
+    uint8_t payload_len = 1 + param_len; // cmd_id + params
+    buf[idx++] = payload_len;
+
+    buf[idx++] = cmd_enum;
+
+    if (param_len > 0 && params != NULL)
+    {
+        memcpy(&buf[idx], params, param_len);
+        idx += param_len;
+    }
+
+    buf[idx] = pkt_sum8(0, buf, idx);
+    idx++;
+
+    PKT_TRACE_FRAME(buf, idx, "Built Packet");
+    return idx;
+}
+
+uint16_t build_packet_v2(uint8_t *buf, uint8_t seq, CMD_ID cmd_enum,
+        const uint8_t *params, uint16_t param_len)
+{
+    uint16_t idx = 0;
+    uint16_t payload_len = 1 + param_len; // cmd_id + params
+
+    buf[idx++] = CMD_HEADER_V2;
+    buf[idx++] = (uint8_t)(payload_len & 0xFF);
+    buf[idx++] = (uint8_t)(payload_len >> 8);
+    buf[idx++] = seq;
+    buf[idx++] = cmd_enum;
+
+    if (param_len > 0 && params != NULL)
+    {
+        memcpy(&buf[idx], params, param_len);
+        idx += param_len;
+    }
+
+    uint16_t crc = crc16_ccitt(CRC16_CCITT_INIT, buf, idx);
+    buf[idx++] = (uint8_t)(crc & 0xFF);
+    buf[idx++] = (uint8_t)(crc >> 8);
+
+    PKT_TRACE_FRAME(buf, idx, "Built Packet v2");
+    return idx;
+}
+
+/* ----------------------
+ * Parse packet
+ * ---------------------- */
+static int parse_packet_v2(uint8_t *buf, uint16_t len)
+{
+    if (len < PKT_V2_OVERHEAD + 1)
+        return -1;
+
+    uint16_t payload_len = (uint16_t)(buf[1] | (buf[2] << 8));
+    if (payload_len + PKT_V2_OVERHEAD != len)
+        return -3;
+
+    uint16_t crc = crc16_ccitt(CRC16_CCITT_INIT, buf, len - 2);
+    if (crc != (uint16_t)(buf[len - 2] | (buf[len - 1] << 8)))
+        return -4;
+
+    PKT_TRACE_FRAME(buf, len, "Parse Packet v2");
+    return 0;
+}
+
+int parse_packet(uint8_t *buf, uint16_t len)
+{
+    if (len < 3)
+        return -1;
+
+    if (buf[0] == CMD_HEADER_V2)
+        return parse_packet_v2(buf, len);
+
+    if (buf[0] != CMD_HEADER)
+        return -2;
+
+    uint8_t payload_len = buf[1];
+    if (payload_len + 3 != len)
+        return -3;
+
+    // HEADER + LENGTH + CMD + PAYLOAD
+    if (pkt_sum8(0, buf, len - 1U) != buf[len - 1])
+        return -4;
+
+    PKT_TRACE_FRAME(buf, len, "Parse Packet");
+    return 0;
+}
+
+/* ----------------------
+ * Streaming parser
+ * ---------------------- */
+
+/* Result of pushing one byte through the state machine */
+enum
+{
+    PKT_STEP_NONE = 0,
+    PKT_STEP_FRAME,     // valid frame dispatched
+    PKT_STEP_ERROR      // frame rejected, bytes still in p->buf[0..idx)
+};
+
+#if (TRACE_LEVEL_PACKET >= TRACE_LEVEL_DEBUG)
+static const char *const pkt_state_name[] = {
+    "PKT_WAIT_HEADER",
+    "PKT_WAIT_LEN",
+    "PKT_WAIT_LEN_HI",
+    "PKT_WAIT_SEQ",
+    "PKT_WAIT_PAYLOAD",
+    "PKT_WAIT_CSUM",
+};
+#endif
+
+static void packet_parser_restart(PacketParser *p)
+{
+    p->state = PKT_WAIT_HEADER;
+    p->idx = 0;
+}
+
+static void packet_parser_start(PacketParser *p, uint8_t header)
+{
+    p->buf[0] = header;
+    p->idx = 1;
+    p->version = (header == CMD_HEADER_V2) ? 2 : 1;
+    p->state = PKT_WAIT_LEN;
+}
+
+/* Bytes in front of CMD: HEADER + LENGTH (v1) or HEADER + LEN16 + SEQ (v2) */
+static uint16_t packet_hdr_len(const PacketParser *p)
+{
+    return (p->version == 2) ? 4 : 2;
+}
+
+/* Bytes around CMD + PAYLOAD */
+static uint16_t packet_overhead(const PacketParser *p)
+{
+    return (p->version == 2) ? PKT_V2_OVERHEAD : PKT_V1_OVERHEAD;
+}
+
+/* Whole frame size once LENGTH is known (32-bit: v2 LEN + 6 may not fit) */
+static uint32_t packet_frame_len(const PacketParser *p)
+{
+    return (uint32_t)p->payload_len + packet_overhead(p);
+}
+
+/* LENGTH must cover at least the CMD byte and the frame must fit into p->buf.
+ * Compared as LEN <= cap - overhead, so a v2 LEN of 0xFFFA..0xFFFF cannot
+ * wrap around to a small frame size. */
+static int packet_len_valid(const PacketParser *p)
+{
+    uint16_t overhead = packet_overhead(p);
+    return (p->payload_len != 0) && (p->cap >= overhead)
+            && (p->payload_len <= (uint16_t)(p->cap - overhead));
+}
+
+/* Deliver a frame that already passed parse_packet() */
+static void packet_dispatch(PacketFrameHandler handler, void *ctx, uint8_t *buf)
+{
+    PacketFrame frame;
+
+    if (buf[0] == CMD_HEADER_V2)
+    {
+        frame.version = 2;
+        frame.seq = buf[3];
+        frame.payload = &buf[4];
+        frame.len = (uint16_t)(buf[1] | (buf[2] << 8));
+    }
+    else
+    {
+        frame.version = 1;
+        frame.seq = 0;
+        frame.payload = &buf[2];
+        frame.len = buf[1];
+    }
+
+    handler(ctx, &frame);
+}
+
+/* Length of the frame starting at hdr if all of it is in hdr[0..avail)
+ * and its LENGTH is acceptable (same limits as the buffered path), else 0 */
+static uint16_t packet_frame_in(const PacketParser *p, const uint8_t *hdr, size_t avail)
+{
+    uint16_t payload_len;
+    uint32_t frame_len;
+
+    if (hdr[0] == CMD_HEADER_V2)
+    {
+        if (avail < 3U)
+            return 0;
+        payload_len = (uint16_t)(hdr[1] | (hdr[2] << 8));
+        frame_len = (uint32_t)payload_len + PKT_V2_OVERHEAD;
+    }
+    else
+    {
+        if (avail < 2U)
+            return 0;
+        payload_len = hdr[1];
+        frame_len = (uint32_t)payload_len + PKT_V1_OVERHEAD;
+    }
+
+    if ((payload_len == 0U) || (frame_len > p->cap) || (frame_len > avail))
+        return 0;
+    return (uint16_t)frame_len;
+}
+
+/* Frame fully buffered: validate and dispatch.
+ * On success the parser goes back to header search; on error the buffered
+ * bytes are left in place for packet_parser_on_error(). */
+static int packet_parser_finish(PacketParser *p)
+{
+    int ret = parse_packet(p->buf, p->idx);
+    if (ret == 0)
+    {
+        p->frames_ok++;
+        packet_dispatch(p->handler, p->handler_ctx, p->buf);
+        packet_parser_restart(p);
+    }
+    else if (ret == -4)
+    {
+        p->csum_err++;
+    }
+    else if (ret == -3)
+    {
+        p->len_err++;
+    }
+
+    return ret;
+}
+
+static int packet_parser_step(PacketParser *p, uint8_t byte)
+{
+    switch (p->state)
+    {
+
+    case PKT_WAIT_HEADER:
+        if (byte == CMD_HEADER || byte == CMD_HEADER_V2)
+            packet_parser_start(p, byte);
+        break;
+
+    case PKT_WAIT_LEN:
+        p->buf[p->idx++] = byte;
+        p->payload_len = byte;
+        if (p->version == 2)
+        {
+            p->state = PKT_WAIT_LEN_HI;
+            break;
+        }
+        if (!packet_len_valid(p))
+        {
+            p->len_err++;
+            return PKT_STEP_ERROR;
+        }
+        p->state = PKT_WAIT_PAYLOAD;
+        break;
+
+    case PKT_WAIT_LEN_HI:
+        p->buf[p->idx++] = byte;
+        p->payload_len |= (uint16_t)byte << 8;
+        if (!packet_len_valid(p))
+        {
+            p->len_err++;
+            return PKT_STEP_ERROR;
+        }
+        p->state = PKT_WAIT_SEQ;
+        break;
+
+    case PKT_WAIT_SEQ:
+        p->buf[p->idx++] = byte;
+        p->seq = byte;
+        p->state = PKT_WAIT_PAYLOAD;
+        break;
+
+    case PKT_WAIT_PAYLOAD:
+        p->buf[p->idx++] = byte;
+        if (p->idx == packet_hdr_len(p) + p->payload_len)
+            p->state = PKT_WAIT_CSUM;
+        break;
+
+    case PKT_WAIT_CSUM:
+        p->buf[p->idx++] = byte;
+        if (p->idx < packet_frame_len(p))
+            break;  // v2: CRC low byte, wait for the high byte
+        return (packet_parser_finish(p) == 0) ? PKT_STEP_FRAME : PKT_STEP_ERROR;
+    }
+
+    return PKT_STEP_NONE;
+}
+
+/* Rescan a rejected frame for the next CMD_HEADER candidate and replay the
+ * bytes from there. A candidate that fails again is skipped the same way,
+ * so the loop always makes progress. Returns the number of frames recovered.
+ * Works in place: the unscanned tail is moved to the front of p->buf and
+ * replayed from index 0, so each replayed byte is rewritten onto itself
+ * and large parser buffers need no stack copy. */
+static uint16_t packet_parser_resync(PacketParser *p)
+{
+    uint8_t *buf = p->buf;
+    uint16_t n = p->idx;
+    uint16_t pos = 1;   // skip the header byte of the rejected frame
+    uint16_t recovered = 0;
+
+    packet_parser_restart(p);
+    p->resync_count++;
+    p->dropped_bytes++;
+
+    while (pos < n)
+    {
+        const uint8_t *hdr = pkt_find_header(&buf[pos], n - pos);
+        if (hdr == NULL)
+        {
+            p->dropped_bytes += n - pos;
+            break;
+        }
+
+        uint16_t start = (uint16_t)(hdr - buf);
+        p->dropped_bytes += start - pos;
+
+        // Candidate to the front: replayed byte i is stored back at buf[i]
+        n -= start;
+        memmove(buf, &buf[start], n);
+
+        for (pos = 0; pos < n; pos++)
+        {
+            int r = packet_parser_step(p, buf[pos]);
+            if (r == PKT_STEP_FRAME)
+            {
+                recovered++;
+                pos++;
+                break;
+            }
+            if (r == PKT_STEP_ERROR)
+            {
+                // Candidate rejected too: drop its header, keep scanning
+                packet_parser_restart(p);
+                p->resync_count++;
+                p->dropped_bytes++;
+                pos = 1;
+                break;
+            }
+        }
+    }
+
+    p->recovered_frames += recovered;
+    return recovered;
+}
+
+/* Rejected frame: rescan in resync mode, otherwise drop everything buffered */
+static uint16_t packet_parser_on_error(PacketParser *p)
+{
+    if (p->resync)
+        return packet_parser_resync(p);
+
+    packet_parser_restart(p);
+    return 0;
+}
+
+void packet_parser_feed(PacketParser *p, uint8_t byte)
+{
+    TRACE_DEBUG("case %d: %s\r\n", p->state, pkt_state_name[p->state]);
+    if (packet_parser_step(p, byte) == PKT_STEP_ERROR)
+    {
+        packet_parser_on_error(p);
+    }
+}
+
+uint16_t packet_parser_feed_buf(PacketParser *p, const uint8_t *data, size_t len)
+{
+    const uint8_t *end = data + len;
+    uint16_t frames = 0;
+
+    while (data < end)
+    {
+        switch (p->state)
+        {
+
+        case PKT_WAIT_HEADER:
+        {
+            // Skip junk between frames with library scans
+            const uint8_t *hdr = pkt_find_header(data, (size_t)(end - data));
+            if (hdr == NULL)
+                return frames;
+
+            if (p->inplace)
+            {
+                // Whole frame in this chunk: validate and dispatch it where
+                // it is. Anything else (incomplete, bad) takes the buffered
+                // path below, which also does the error accounting.
+                uint16_t n = packet_frame_in(p, hdr, (size_t)(end - hdr));
+                if ((n != 0U) && (parse_packet((uint8_t *)hdr, n) == 0))
+                {
+                    p->frames_ok++;
+                    p->inplace_frames++;
+                    packet_dispatch(p->handler, p->handler_ctx, (uint8_t *)hdr);
+                    frames++;
+                    data = hdr + n;
+                    break;
+                }
+            }
+
+            packet_parser_start(p, *hdr);
+            data = hdr + 1;
+            break;
+        }
+
+        case PKT_WAIT_PAYLOAD:
+        {
+            // Copy as much of the remaining CMD+PAYLOAD as this chunk holds
+            size_t need = (size_t)(packet_hdr_len(p) + p->payload_len - p->idx);
+            size_t avail = (size_t)(end - data);
+            size_t n = (need < avail) ? need : avail;
+
+            memcpy(&p->buf[p->idx], data, n);
+            p->idx += (uint16_t)n;
+            data += n;
+            if (n == need)
+                p->state = PKT_WAIT_CSUM;
+            break;
+        }
+
+        default:
+        {
+            // Short header/trailer fields go through the byte state machine
+            int r = packet_parser_step(p, *data++);
+            if (r == PKT_STEP_FRAME)
+                frames++;
+            else if (r == PKT_STEP_ERROR)
+                frames += packet_parser_on_error(p);
+            break;
+        }
+        }
+    }
+
+    return frames;
+}
+
+uint16_t packet_parser_feed_dma(PacketParser *p, const uint8_t *dma_buf,
+        uint16_t buf_size, uint16_t last_pos, uint16_t cur_pos)
+{
+    uint16_t frames = 0;
+
+    if (last_pos >= buf_size)
+        last_pos = 0;
+    if (cur_pos >= buf_size)
+        cur_pos = 0;
+
+    if (cur_pos >= last_pos)
+    {
+        frames += packet_parser_feed_buf(p, &dma_buf[last_pos], cur_pos - last_pos);
+    }
+    else
+    {
+        // Wrapped: tail of the buffer first, then the head
+        frames += packet_parser_feed_buf(p, &dma_buf[last_pos], buf_size - last_pos);
+        frames += packet_parser_feed_buf(p, dma_buf, cur_pos);
+    }
+
+    return frames;
+}
+
+/* ----------------------
+ * COBS framing
+ * ---------------------- */
+void packet_cobs_init(PacketCobsParser *c)
+{
+    c->idx = 0;
+    c->overflow = 0;
+    c->handler = packet_default_handler;
+    c->handler_ctx = NULL;
+    c->frames_ok = 0;
+    c->csum_err = 0;
+    c->len_err = 0;
+}
+
+void packet_cobs_set_handler(PacketCobsParser *c, PacketFrameHandler handler, void *ctx)
+{
+    c->handler = (handler != NULL) ? handler : packet_default_handler;
+    c->handler_ctx = ctx;
+}
+
+uint16_t packet_cobs_encode(uint8_t *out, const uint8_t *frame, uint16_t len)
+{
+    size_t n = cobs_encode(frame, len, out);
+    out[n++] = COBS_DELIMITER;
+    return (uint16_t)n;
+}
+
+/* Delimiter seen: decode in place, validate and dispatch.
+ * Returns parse_packet() result, or -1 for an empty/undecodable frame. */
+static int packet_cobs_finish(PacketCobsParser *c)
+{
+    int ret = -1;
+
+    if (c->overflow)
+    {
+        c->len_err++;
+    }
+    else if (c->idx > 0)
+    {
+        int n = cobs_decode(c->buf, c->idx, c->buf);
+        if (n > 0)
+        {
+            ret = parse_packet(c->buf, (uint16_t)n);
+            if (ret == 0)
+            {
+                c->frames_ok++;
+                packet_dispatch(c->handler, c->handler_ctx, c->buf);
+            }
+            else if (ret == -3)
+            {
+                c->len_err++;
+            }
+            else
+            {
+                c->csum_err++;
+            }
+        }
+        else
+        {
+            c->csum_err++;
+        }
+    }
+    c->idx = 0;
+    c->overflow = 0;
+
+    return ret;
+}
+
+uint16_t packet_cobs_feed_buf(PacketCobsParser *c, const uint8_t *data, size_t len)
+{
+    const uint8_t *end = data + len;
+    uint16_t frames = 0;
+
+    while (data < end)
+    {
+        const uint8_t *delim = memchr(data, COBS_DELIMITER, (size_t)(end - data));
+        size_t run = (size_t)(((delim != NULL) ? delim : end) - data);
+
+        // Too long for buf: drop the rest of this frame up to the delimiter
+        if (c->overflow || run > sizeof(c->buf) - c->idx)
+        {
+            c->overflow = 1;
+        }
+        else
+        {
+            memcpy(&c->buf[c->idx], data, run);
+            c->idx += (uint16_t)run;
+        }
+
+        if (delim == NULL)
+            break;
+
+        if (packet_cobs_finish(c) == 0)
+            frames++;
+        data = delim + 1;
+    }
+
+    return frames;
+}
+
+uint16_t packet_cobs_feed_dma(PacketCobsParser *c, const uint8_t *dma_buf,
+        uint16_t buf_size, uint16_t last_pos, uint16_t cur_pos)
+{
+    uint16_t frames = 0;
+
+    if (last_pos >= buf_size)
+        last_pos = 0;
+    if (cur_pos >= buf_size)
+        cur_pos = 0;
+
+    if (cur_pos >= last_pos)
+    {
+        frames += packet_cobs_feed_buf(c, &dma_buf[last_pos], cur_pos - last_pos);
+    }
+    else
+    {
+        frames += packet_cobs_feed_buf(c, &dma_buf[last_pos], buf_size - last_pos);
+        frames += packet_cobs_feed_buf(c, dma_buf, cur_pos);
+    }
+
+    return frames;
+}
+
+/* ---------- command batch ---------- */
+uint16_t packet_batch_append(uint8_t *buf, uint16_t cap, uint16_t pos,
+        uint8_t cmd, const uint8_t *args, uint8_t args_len)
+{
+    uint16_t sub_len = 1U + args_len;
+
+    if ((sub_len > 0xFFU) || ((uint32_t)pos + 1U + sub_len > cap))
+        return 0;
+
+    buf[pos] = (uint8_t)sub_len;
+    buf[pos + 1U] = cmd;
+    if (args_len > 0U)
+        memcpy(&buf[pos + 2U], args, args_len);
+    return (uint16_t)(pos + 1U + sub_len);
+}
+
+static void packet_batch_fail(PacketBatchStatus *st, uint8_t idx, int err)
+{
+    st->fail_mask |= 1UL << idx;
+    if (st->first_fail == 0xFFU)
+    {
+        st->first_fail = idx;
+        st->first_err = (int8_t)err;
+    }
+}
+
+int packet_batch_run(const uint8_t *data, uint16_t len, PacketBatchFn check,
+        PacketBatchFn exec, void *ctx, PacketBatchStatus *st)
+{
+    PacketBatchStatus local;
+    uint16_t pos = 0;
+    uint8_t n = 0;
+
+    if (st == NULL)
+        st = &local;
+    memset(st, 0, sizeof(*st));
+    st->first_fail = 0xFFU;
+
+    // Pass 1: length chain and per-command check, nothing executed yet
+    while (pos < len)
+    {
+        uint8_t sub_len = data[pos];
+        if ((sub_len == 0U) || (n >= PKT_BATCH_MAX_CMDS)
+                || ((uint32_t)pos + 1U + sub_len > len))
+            return -1;
+
+        int rc = check(ctx, &data[pos + 1U], sub_len);
+        if (rc != 0)
+            packet_batch_fail(st, n, rc);
+        pos += 1U + sub_len;
+        n++;
+    }
+    if (n == 0U)
+        return -1;
+
+    st->count = n;
+    if (st->fail_mask != 0U)
+        return -2;
+
+    // Pass 2: execute in order
+    pos = 0;
+    for (uint8_t i = 0; i < n; i++)
+    {
+        uint8_t sub_len = data[pos];
+        int rc = exec(ctx, &data[pos + 1U], sub_len);
+        if (rc == 0)
+            st->ok++;
+        else
+            packet_batch_fail(st, i, rc);
+        pos += 1U + sub_len;
+    }
+
+    return (st->fail_mask != 0U) ? -3 : 0;
+}
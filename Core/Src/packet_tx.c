@@ -0,0 +1,222 @@
+/*
+ * packet_tx.c
+ *
+ * Asynchronous packet transmit through a TX DMA ring (see packet_tx.h).
+ */
+#include "packet_tx.h"
+
+#include <string.h>
+
+#include "packet.h"
+#include "crc16.h"
+
+static PacketTx *g_ports[PKT_TX_MAX_PORTS];
+
+/* ---------- ring writer ---------- */
+
+/* Write position inside a frame being built; never passes tx->tail */
+typedef struct
+{
+    PacketTx *tx;
+    uint16_t pos;
+    uint8_t sum;    // v1 checksum
+    uint16_t crc;   // v2 CRC
+} PktTxWriter;
+
+static uint16_t packet_tx_used(const PacketTx *tx, uint16_t head)
+{
+    uint16_t tail = tx->tail;
+    return (head >= tail) ? (uint16_t)(head - tail) : (uint16_t)(tx->size - tail + head);
+}
+
+/* v1: sum8 fused with the copy */
+static void packet_tx_put_v1(PktTxWriter *w, const uint8_t *src, uint16_t len)
+{
+    PacketTx *tx = w->tx;
+    uint8_t sum = w->sum;
+
+    while (len > 0U)
+    {
+        uint16_t room = tx->size - w->pos;
+        uint16_t n = (len < room) ? len : room;
+        uint8_t *dst = &tx->ring[w->pos];
+
+        for (uint16_t i = 0; i < n; i++)
+        {
+            uint8_t b = src[i];
+            dst[i] = b;
+            sum += b;
+        }
+
+        src += n;
+        len -= n;
+        w->pos = (uint16_t)((w->pos + n) % tx->size);
+    }
+
+    w->sum = sum;
+}
+
+/* v2: slice-by-4 CRC fused with the copy */
+static void packet_tx_put_v2(PktTxWriter *w, const uint8_t *src, uint16_t len)
+{
+    PacketTx *tx = w->tx;
+
+    while (len > 0U)
+    {
+        uint16_t room = tx->size - w->pos;
+        uint16_t n = (len < room) ? len : room;
+
+        w->crc = crc16_ccitt_copy(w->crc, &tx->ring[w->pos], src, n);
+
+        src += n;
+        len -= n;
+        w->pos = (uint16_t)((w->pos + n) % tx->size);
+    }
+}
+
+static void packet_tx_put_raw(PktTxWriter *w, uint8_t b)
+{
+    w->tx->ring[w->pos] = b;
+    w->pos = (uint16_t)((w->pos + 1U) % w->tx->size);
+}
+
+/* ---------- DMA side ---------- */
+
+/* Start the next contiguous chunk if DMA is idle. Interrupts masked. */
+static void packet_tx_kick(PacketTx *tx)
+{
+    if ((tx->dma_len != 0U) || (tx->head == tx->tail))
+        return;
+
+    uint16_t tail = tx->tail;
+    uint16_t n = (tx->head > tail) ? (uint16_t)(tx->head - tail) : (uint16_t)(tx->size - tail);
+
+    if (HAL_UART_Transmit_DMA(tx->huart, &tx->ring[tail], n) == HAL_OK)
+        tx->dma_len = n;
+    else
+        tx->dma_errors++;   // retried on the next commit
+}
+
+void packet_tx_on_tx_complete(UART_HandleTypeDef *huart)
+{
+    for (uint8_t i = 0; i < PKT_TX_MAX_PORTS; i++)
+    {
+        PacketTx *tx = g_ports[i];
+        if ((tx == NULL) || (tx->huart != huart))
+            continue;
+
+        tx->tail = (uint16_t)((tx->tail + tx->dma_len) % tx->size);
+        tx->dma_len = 0;
+        packet_tx_kick(tx);
+        return;
+    }
+}
+
+/* Publish the frame written up to w->pos and start DMA if idle */
+static void packet_tx_commit(PacketTx *tx, uint16_t end, uint16_t len)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    tx->head = end;
+    tx->frames++;
+    tx->bytes += len;
+    packet_tx_kick(tx);
+    __set_PRIMASK(primask);
+}
+
+/* ---------- public APIs ---------- */
+void packet_tx_init(PacketTx *tx, UART_HandleTypeDef *huart, uint8_t *ring, uint16_t size)
+{
+    memset(tx, 0, sizeof(*tx));
+    tx->huart = huart;
+    tx->ring = ring;
+    tx->size = size;
+
+    for (uint8_t i = 0; i < PKT_TX_MAX_PORTS; i++)
+    {
+        if ((g_ports[i] == NULL) || (g_ports[i]->huart == huart))
+        {
+            g_ports[i] = tx;
+            break;
+        }
+    }
+}
+
+static uint32_t packet_tx_iov_len(const PktIoVec *iov, uint8_t iovcnt)
+{
+    uint32_t len = 0;
+    for (uint8_t i = 0; i < iovcnt; i++)
+        len += iov[i].len;
+    return len;
+}
+
+/* Reserve frame_len bytes at head; returns 0 if the ring has no room */
+static int packet_tx_reserve(PacketTx *tx, PktTxWriter *w, uint32_t frame_len)
+{
+    uint16_t head = tx->head;
+    if (packet_tx_used(tx, head) + frame_len > (uint32_t)(tx->size - 1U))
+    {
+        tx->full++;
+        return 0;
+    }
+
+    w->tx = tx;
+    w->pos = head;
+    return 1;
+}
+
+int packet_tx_send_v1(PacketTx *tx, CMD_ID cmd, const PktIoVec *iov, uint8_t iovcnt)
+{
+    uint32_t payload_len = 1U + packet_tx_iov_len(iov, iovcnt);
+    uint32_t frame_len = payload_len + PKT_V1_OVERHEAD;
+    if ((payload_len > 0xFFU) || (frame_len > (uint32_t)(tx->size - 1U)))
+        return -2;
+
+    PktTxWriter w;
+    if (!packet_tx_reserve(tx, &w, frame_len))
+        return -1;
+
+    uint8_t hdr[3] = { CMD_HEADER, (uint8_t) payload_len, (uint8_t) cmd };
+    w.sum = 0;
+    packet_tx_put_v1(&w, hdr, sizeof(hdr));
+    for (uint8_t i = 0; i < iovcnt; i++)
+        packet_tx_put_v1(&w, iov[i].base, iov[i].len);
+    packet_tx_put_raw(&w, w.sum);
+
+    packet_tx_commit(tx, w.pos, (uint16_t) frame_len);
+    return (int) frame_len;
+}
+
+int packet_tx_send_v2(PacketTx *tx, uint8_t seq, CMD_ID cmd, const PktIoVec *iov, uint8_t iovcnt)
+{
+    uint32_t payload_len = 1U + packet_tx_iov_len(iov, iovcnt);
+    uint32_t frame_len = payload_len + PKT_V2_OVERHEAD;
+    if (frame_len > (uint32_t)(tx->size - 1U))
+        return -2;
+
+    PktTxWriter w;
+    if (!packet_tx_reserve(tx, &w, frame_len))
+        return -1;
+
+    uint8_t hdr[5] = {
+        CMD_HEADER_V2,
+        (uint8_t)(payload_len & 0xFF),
+        (uint8_t)(payload_len >> 8),
+        seq,
+        (uint8_t) cmd,
+    };
+    w.crc = CRC16_CCITT_INIT;
+    packet_tx_put_v2(&w, hdr, sizeof(hdr));
+    for (uint8_t i = 0; i < iovcnt; i++)
+        packet_tx_put_v2(&w, iov[i].base, iov[i].len);
+    packet_tx_put_raw(&w, (uint8_t)(w.crc & 0xFF));
+    packet_tx_put_raw(&w, (uint8_t)(w.crc >> 8));
+
+    packet_tx_commit(tx, w.pos, (uint16_t) frame_len);
+    return (int) frame_len;
+}
+
+uint16_t packet_tx_pending(const PacketTx *tx)
+{
+    return packet_tx_used(tx, tx->head);
+}
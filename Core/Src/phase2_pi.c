@@ -15,6 +15,7 @@
 #include "cmsis_os2.h"
 #include "main.h"
 #include "console.h"
+#include "telemetry.h"
 #include "watchdog.h"
 
 #include "FreeRTOS.h"
@@ -46,6 +47,54 @@ static volatile uint8_t g_high_waiting = 0U;
 static volatile uint32_t g_low_hold_ms = (uint32_t) LOW_HOLD_MS;
 static volatile uint32_t g_medium_spin_factor = (uint32_t) MEDIUM_SPIN_FACTOR;
 
+#if (TELEMETRY_BINARY != 0)
+/* Binary counterparts of the CFG line and the CSV row */
+typedef __PACKED_STRUCT
+{
+    uint8_t pi_mode;
+    uint8_t realistic;
+    uint16_t low_hold_ms;
+    uint16_t low_hold_jitter_ms;
+    uint16_t high_start_jitter_ms;
+    uint16_t medium_spin_factor;
+    uint16_t medium_spin_min;
+    uint16_t medium_spin_max;
+    uint16_t low_critical_steps;
+    uint16_t low_critical_factor;
+    uint16_t iteration_count;
+    uint16_t stats_window;
+    uint16_t medium_pause_ticks;
+} Phase2CfgRecord;
+
+typedef __PACKED_STRUCT
+{
+    uint16_t iter;
+    uint8_t mode;
+    uint32_t high_wait_ticks;
+    uint32_t low_hold_ticks;
+    uint32_t medium_spin_count;
+} Phase2RowRecord;
+
+_Static_assert(ITERATION_COUNT <= 0xFFFF, "Phase2RowRecord.iter is 16-bit");
+
+static const TelemType g_cfg_type = {
+    .name = "p2_cfg",
+    .fields = "pi_mode:B,realistic:B,low_hold_ms:H,low_hold_jitter_ms:H,"
+              "high_start_jitter_ms:H,medium_spin_factor:H,medium_spin_min:H,"
+              "medium_spin_max:H,low_critical_steps:H,low_critical_factor:H,"
+              "iteration_count:H,stats_window:H,medium_pause_ticks:H",
+    .size = sizeof(Phase2CfgRecord)
+};
+
+static const TelemType g_row_type = {
+    .name = "p2_row",
+    .fields = "iter:H,mode:B,high_wait_ticks:I,low_hold_ticks:I,medium_spin_count:I",
+    .size = sizeof(Phase2RowRecord)
+};
+
+static int g_row_id = -1;
+#endif
+
 /* Simple PRNG (xorshift32) to add small jitter without pulling in libc rand(). */
 static uint32_t g_rng_state = 2463534242UL;
 
@@ -214,6 +263,27 @@ static void high_task(void *argument)
 
     /* Emit one-time configuration line (not a CSV row). */
     Watchdog_Refresh();
+#if (TELEMETRY_BINARY != 0)
+    int cfg_id = telemetry_register(&g_cfg_type);
+    g_row_id = telemetry_register(&g_row_type);
+
+    Phase2CfgRecord cfg = {
+        .pi_mode = (uint8_t) PI_MODE,
+        .realistic = (uint8_t) PHASE2_REALISTIC_PROFILE,
+        .low_hold_ms = (uint16_t) LOW_HOLD_MS,
+        .low_hold_jitter_ms = (uint16_t) LOW_HOLD_JITTER_MS,
+        .high_start_jitter_ms = (uint16_t) HIGH_START_JITTER_MS,
+        .medium_spin_factor = (uint16_t) MEDIUM_SPIN_FACTOR,
+        .medium_spin_min = (uint16_t) MEDIUM_SPIN_FACTOR_MIN,
+        .medium_spin_max = (uint16_t) MEDIUM_SPIN_FACTOR_MAX,
+        .low_critical_steps = (uint16_t) LOW_CRITICAL_SPIN_STEPS,
+        .low_critical_factor = (uint16_t) LOW_CRITICAL_SPIN_FACTOR,
+        .iteration_count = (uint16_t) ITERATION_COUNT,
+        .stats_window = (uint16_t) STATS_WINDOW,
+        .medium_pause_ticks = (uint16_t) MEDIUM_PAUSE_EVERY_TICKS
+    };
+    (void) telemetry_send(cfg_id, &cfg, sizeof(cfg));
+#else
     print(
         "CFG,"
         "pi_mode=%u,"
@@ -249,6 +319,7 @@ static void high_task(void *argument)
 
     /* CSV header: print exactly once at experiment start. */
     print("iter,mode,high_wait_ticks,low_hold_ticks,medium_spin_count\r\n");
+#endif
 
     Watchdog_Refresh();
 
@@ -319,12 +390,23 @@ static void high_task(void *argument)
         uint32_t low_hold_ticks = (uint32_t) (g_low_unlock_tick - g_low_lock_tick);
         uint32_t medium_spin_count = (uint32_t) g_medium_spin_count;
 
+#if (TELEMETRY_BINARY != 0)
+        Phase2RowRecord row = {
+            .iter = (uint16_t) g_iter,
+            .mode = (uint8_t) PI_MODE,
+            .high_wait_ticks = high_wait_ticks,
+            .low_hold_ticks = low_hold_ticks,
+            .medium_spin_count = medium_spin_count
+        };
+        (void) telemetry_send(g_row_id, &row, sizeof(row));
+#else
         print("%lu,%u,%lu,%lu,%lu\r\n",
               (unsigned long) g_iter,
               (unsigned int) PI_MODE,
               (unsigned long) high_wait_ticks,
               (unsigned long) low_hold_ticks,
               (unsigned long) medium_spin_count);
+#endif
 
           /* Printing is blocking; refresh again after TX work. */
           Watchdog_Refresh();
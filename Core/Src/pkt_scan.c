@@ -0,0 +1,142 @@
+/*
+ * pkt_scan.c
+ *
+ * Header search and 8-bit sum kernels (see pkt_scan.h).
+ */
+#include "pkt_scan.h"
+
+#include <string.h>   // memchr
+#include "packet_codec.h"   // CMD_HEADER, CMD_HEADER_V2
+
+#define SWAR_ONES   0x01010101UL
+#define SWAR_HIGHS  0x80808080UL
+#define SWAR_LANES  0x00FF00FFUL
+
+/* Words are loaded from byte buffers: tell GCC the access may alias */
+typedef uint32_t __attribute__((__may_alias__)) pkt_word_t;
+
+/* Non-zero iff one of the 4 bytes of x is zero */
+#define SWAR_HAS_ZERO(x)  (((x) - SWAR_ONES) & ~(x) & SWAR_HIGHS)
+
+static inline int pkt_is_aligned(const uint8_t *p)
+{
+    return ((uintptr_t)p & (sizeof(pkt_word_t) - 1U)) == 0U;
+}
+
+/* ----------------------
+ * Header search
+ * ---------------------- */
+
+/* The v2 search is bounded by the first hit so each byte is scanned once */
+const uint8_t *pkt_find2_scalar(const uint8_t *data, size_t len, uint8_t a, uint8_t b)
+{
+    const uint8_t *pa = memchr(data, a, len);
+    size_t limit = (pa != NULL) ? (size_t)(pa - data) : len;
+    const uint8_t *pb = memchr(data, b, limit);
+
+    return (pb != NULL) ? pb : pa;
+}
+
+const uint8_t *pkt_find2_swar(const uint8_t *data, size_t len, uint8_t a, uint8_t b)
+{
+    const uint8_t *end = data + len;
+
+    // Head: up to 3 bytes until word aligned
+    while ((data < end) && !pkt_is_aligned(data))
+    {
+        if ((*data == a) || (*data == b))
+            return data;
+        data++;
+    }
+
+    const uint32_t ka = SWAR_ONES * a;
+    const uint32_t kb = SWAR_ONES * b;
+    while ((size_t)(end - data) >= sizeof(pkt_word_t))
+    {
+        uint32_t w = *(const pkt_word_t *)data;
+        uint32_t xa = w ^ ka;
+        uint32_t xb = w ^ kb;
+        if ((SWAR_HAS_ZERO(xa) | SWAR_HAS_ZERO(xb)) != 0U)
+            break;  // hit in this word, located by the byte loop below
+        data += sizeof(pkt_word_t);
+    }
+
+    // Word with a hit, or the tail
+    for (; data < end; data++)
+    {
+        if ((*data == a) || (*data == b))
+            return data;
+    }
+    return NULL;
+}
+
+const uint8_t *pkt_find_header(const uint8_t *data, size_t len)
+{
+#if (PKT_USE_SWAR != 0)
+    return pkt_find2_swar(data, len, CMD_HEADER, CMD_HEADER_V2);
+#else
+    return pkt_find2_scalar(data, len, CMD_HEADER, CMD_HEADER_V2);
+#endif
+}
+
+/* ----------------------
+ * 8-bit sum
+ * ---------------------- */
+uint8_t pkt_sum8_scalar(uint8_t init, const uint8_t *data, size_t len)
+{
+    uint8_t sum = init;
+    for (size_t i = 0; i < len; i++)
+        sum += data[i];
+    return sum;
+}
+
+/* Lane limit: 2 x 0xFF per word, 128 words stay below 0x10000 */
+#define SWAR_SUM_BLOCK_WORDS  128U
+
+uint8_t pkt_sum8_swar(uint8_t init, const uint8_t *data, size_t len)
+{
+    uint8_t sum = init;
+    const uint8_t *end = data + len;
+
+    while ((data < end) && !pkt_is_aligned(data))
+        sum += *data++;
+
+    size_t words = (size_t)(end - data) / sizeof(pkt_word_t);
+    while (words > 0U)
+    {
+        size_t n = (words < SWAR_SUM_BLOCK_WORDS) ? words : SWAR_SUM_BLOCK_WORDS;
+        const pkt_word_t *wp = (const pkt_word_t *)data;
+        uint32_t acc = 0;
+
+        words -= n;
+        data += n * sizeof(pkt_word_t);
+        for (; n >= 2U; n -= 2U, wp += 2)
+        {
+            uint32_t w0 = wp[0];
+            uint32_t w1 = wp[1];
+            acc += (w0 & SWAR_LANES) + ((w0 >> 8) & SWAR_LANES);
+            acc += (w1 & SWAR_LANES) + ((w1 >> 8) & SWAR_LANES);
+        }
+        if (n != 0U)
+        {
+            uint32_t w0 = wp[0];
+            acc += (w0 & SWAR_LANES) + ((w0 >> 8) & SWAR_LANES);
+        }
+
+        // Fold the two 16-bit lanes; only the low 8 bits matter
+        sum += (uint8_t)(acc + (acc >> 16));
+    }
+
+    while (data < end)
+        sum += *data++;
+    return sum;
+}
+
+uint8_t pkt_sum8(uint8_t init, const uint8_t *data, size_t len)
+{
+#if (PKT_USE_SWAR != 0)
+    return pkt_sum8_swar(init, data, len);
+#else
+    return pkt_sum8_scalar(init, data, len);
+#endif
+}
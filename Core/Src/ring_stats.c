@@ -0,0 +1,166 @@
+/*
+ * ring_stats.c
+ *
+ * Ring buffer fill level statistics (see ring_stats.h).
+ */
+#include "ring_stats.h"
+
+#include <string.h>
+
+#include "main.h"
+#include "telemetry.h"
+
+typedef struct
+{
+    const char *name;
+    uint16_t size;
+    const SpscRing *ring;   // at most one of ring / bip, NULL for a plain buffer
+    const BipBuf *bip;
+    SpscRingStats *stats;   // NULL with SPSC_RING_STATS = 0
+} RingStatsSource;
+
+static RingStatsSource g_src[RING_STATS_MAX];
+static uint8_t g_count = 0;
+
+/* ring = registration order; the console output names them */
+typedef __PACKED_STRUCT
+{
+    uint8_t ring;
+    uint16_t size;
+    uint16_t used;
+    uint16_t high_water;
+    uint32_t overflows;
+    uint32_t dropped;
+    uint32_t hist[SPSC_RING_HIST_BINS];
+} RingStatsRecord;
+
+static const TelemType g_stats_type = {
+    .name = "ring_stats",
+    .fields = "ring:B,size:H,used:H,high_water:H,overflows:I,dropped:I,"
+              "h0:I,h1:I,h2:I,h3:I,h4:I,h5:I,h6:I,h7:I",
+    .size = sizeof(RingStatsRecord)
+};
+
+static int g_stats_id = -1;
+
+static int ring_stats_add(const char *name, uint16_t size, const SpscRing *ring,
+        const BipBuf *bip, SpscRingStats *stats)
+{
+    if (g_count >= RING_STATS_MAX)
+        return -1;
+
+    g_src[g_count].name = name;
+    g_src[g_count].size = size;
+    g_src[g_count].ring = ring;
+    g_src[g_count].bip = bip;
+    g_src[g_count].stats = stats;
+    return g_count++;
+}
+
+int ring_stats_attach_spsc(const char *name, SpscRing *ring)
+{
+#if (SPSC_RING_STATS != 0)
+    return ring_stats_add(name, ring->size, ring, NULL, &ring->stats);
+#else
+    return ring_stats_add(name, ring->size, ring, NULL, NULL);
+#endif
+}
+
+int ring_stats_attach_bip(const char *name, BipBuf *bip)
+{
+#if (SPSC_RING_STATS != 0)
+    return ring_stats_add(name, bip->size, NULL, bip, &bip->stats);
+#else
+    return ring_stats_add(name, bip->size, NULL, bip, NULL);
+#endif
+}
+
+int ring_stats_attach(const char *name, uint16_t size, SpscRingStats *stats)
+{
+    return ring_stats_add(name, size, NULL, NULL, stats);
+}
+
+uint8_t ring_stats_snapshot(RingStats *out)
+{
+    memset(out, 0, sizeof(RingStats) * RING_STATS_MAX);
+
+    // Producers run in ISRs: mask them for a consistent set
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    for (uint8_t i = 0; i < g_count; i++)
+    {
+        const RingStatsSource *s = &g_src[i];
+        RingStats *o = &out[i];
+
+        o->name = s->name;
+        o->size = s->size;
+        if (s->ring != NULL)
+        {
+            o->used = spsc_ring_used(s->ring);
+            o->dropped = s->ring->dropped;
+        }
+        if (s->bip != NULL)
+        {
+            o->used = bipbuf_used(s->bip);
+            o->dropped = s->bip->dropped;
+        }
+        if (s->stats != NULL)
+        {
+            o->high_water = s->stats->high_water;
+            o->overflows = s->stats->overflows;
+            memcpy(o->hist, s->stats->hist, sizeof(o->hist));
+        }
+    }
+
+    __set_PRIMASK(primask);
+    return g_count;
+}
+
+void ring_stats_reset(void)
+{
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+
+    for (uint8_t i = 0; i < g_count; i++)
+    {
+        SpscRingStats *st = g_src[i].stats;
+        if (st == NULL)
+            continue;
+        st->high_water = 0;
+        st->overflows = 0;
+        memset(st->hist, 0, sizeof(st->hist));
+    }
+
+    __set_PRIMASK(primask);
+}
+
+void ring_stats_telemetry_init(void)
+{
+    g_stats_id = telemetry_register(&g_stats_type);
+}
+
+int ring_stats_report(void)
+{
+    RingStats snap[RING_STATS_MAX];
+    int rc = 0;
+
+    uint8_t n = ring_stats_snapshot(snap);
+    for (uint8_t i = 0; i < n; i++)
+    {
+        RingStatsRecord rec = {
+            .ring = i,
+            .size = snap[i].size,
+            .used = snap[i].used,
+            .high_water = snap[i].high_water,
+            .overflows = snap[i].overflows,
+            .dropped = snap[i].dropped
+        };
+        memcpy(rec.hist, snap[i].hist, sizeof(rec.hist));
+
+        int r = telemetry_send(g_stats_id, &rec, sizeof(rec));
+        if ((r != 0) && (rc == 0))
+            rc = r;
+    }
+    return rc;
+}
@@ -47,7 +47,6 @@
 /* Private function prototypes -----------------------------------------------*/
 /* USER CODE BEGIN PFP */
 extern void print(const char *fmt, ...);
-extern void HAL_UART_IDLE_Callback(UART_HandleTypeDef *huart);
 
 
 /* USER CODE END PFP */
@@ -200,12 +199,7 @@ void TIM6_DAC_LPTIM1_IRQHandler(void)
 void USART1_IRQHandler(void)
 {
   /* USER CODE BEGIN USART1_IRQn 0 */
-  if (__HAL_UART_GET_FLAG(&huart1, UART_FLAG_IDLE))
-  {
-	  __HAL_UART_CLEAR_IDLEFLAG(&huart1); // Clear IDLE flag
-//	  print("USART1_IRQHandler !!!\r\n");
-	  HAL_UART_IDLE_Callback(&huart1); // Call our handler
-  }
+
   /* USER CODE END USART1_IRQn 0 */
   HAL_UART_IRQHandler(&huart1);
   /* USER CODE BEGIN USART1_IRQn 1 */
@@ -233,13 +227,7 @@ void USART2_IRQHandler(void)
 void USART3_4_LPUART1_IRQHandler(void)
 {
   /* USER CODE BEGIN USART3_4_LPUART1_IRQn 0 */
-  if (__HAL_UART_GET_FLAG(&huart3, UART_FLAG_IDLE))
-  {
-	  __HAL_UART_CLEAR_IDLEFLAG(&huart3); // Clear IDLE flag
-//	  print("USART3_4_LPUART1_IRQHandler !!!\r\n");
 
-	  HAL_UART_IDLE_Callback(&huart3); // Call our handler
-  }
   /* USER CODE END USART3_4_LPUART1_IRQn 0 */
   HAL_UART_IRQHandler(&huart3);
   /* USER CODE BEGIN USART3_4_LPUART1_IRQn 1 */
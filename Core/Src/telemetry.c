@@ -0,0 +1,118 @@
+/*
+ * telemetry.c
+ *
+ * Binary measurement records over the console UART (see telemetry.h).
+ */
+#include "telemetry.h"
+
+#include <string.h>
+
+#include "main.h"
+#include "packet.h"
+
+_Static_assert(INVALID_CMD < TELEM_CMD_BASE, "TELEM_CMD range overlaps CMD_ID");
+
+static UART_HandleTypeDef *telem_uart = NULL;
+static const TelemType *telem_types[TELEM_MAX_TYPES];
+static volatile uint8_t telem_count = 0;   // published after the slot is filled
+
+static void telem_tx(uint8_t cmd, const uint8_t *data, uint8_t len)
+{
+    uint8_t frame[PKT_V1_FRAME_SIZE(1U + TELEM_MAX_RECORD)];
+
+    if (telem_uart == NULL)
+        return;
+
+    uint8_t n = build_packet(frame, (CMD_ID)cmd, (uint8_t *)data, len);
+    uart_send_bytes(telem_uart, frame, n);
+}
+
+/* Packed size of a "name:T,..." field list, 0 if malformed */
+static uint16_t telem_fields_size(const char *fields)
+{
+    uint16_t size = 0;
+
+    while (*fields != '\0')
+    {
+        const char *colon = strchr(fields, ':');
+        if ((colon == NULL) || (colon == fields))
+            return 0;
+
+        switch (colon[1])
+        {
+        case 'B': case 'b': size += 1U; break;
+        case 'H': case 'h': size += 2U; break;
+        case 'I': case 'i': size += 4U; break;
+        default: return 0;
+        }
+
+        fields = &colon[2];
+        if (*fields == ',')
+            fields++;
+        else if (*fields != '\0')
+            return 0;
+    }
+    return size;
+}
+
+static void telem_send_schema(uint8_t id)
+{
+    const TelemType *t = telem_types[id];
+    uint8_t buf[TELEM_MAX_RECORD];
+    size_t name_len = strlen(t->name);
+    size_t fields_len = strlen(t->fields);
+
+    buf[0] = id;
+    memcpy(&buf[1], t->name, name_len);
+    buf[1 + name_len] = '|';
+    memcpy(&buf[2 + name_len], t->fields, fields_len);
+    telem_tx(TELEM_CMD_SCHEMA, buf, (uint8_t)(2U + name_len + fields_len));
+}
+
+void telemetry_init(void *uart_handle)
+{
+    telem_uart = (UART_HandleTypeDef *)uart_handle;
+}
+
+int telemetry_register(const TelemType *t)
+{
+    uint16_t size = telem_fields_size(t->fields);
+    if ((size == 0U) || (size != t->size) || (size > TELEM_MAX_RECORD)
+            || (2U + strlen(t->name) + strlen(t->fields) > TELEM_MAX_RECORD))
+        return -2;
+
+    /* Types are registered from several tasks (and before the scheduler),
+     * while telemetry_announce() / telemetry_send() walk the table without
+     * a lock: take the id and fill its slot before publishing the count.
+     * PRIMASK rather than taskENTER_CRITICAL(), which leaves interrupts
+     * masked when used before the scheduler starts. */
+    uint32_t primask = __get_PRIMASK();
+    __disable_irq();
+    if (telem_count >= TELEM_MAX_TYPES)
+    {
+        __set_PRIMASK(primask);
+        return -1;
+    }
+    uint8_t id = telem_count;
+    telem_types[id] = t;
+    telem_count = id + 1U;
+    __set_PRIMASK(primask);
+
+    telem_send_schema(id);
+    return id;
+}
+
+int telemetry_send(int id, const void *record, uint8_t len)
+{
+    if ((id < 0) || (id >= telem_count) || (len != telem_types[id]->size))
+        return -1;
+
+    telem_tx((uint8_t)(TELEM_CMD_BASE + id), (const uint8_t *)record, len);
+    return 0;
+}
+
+void telemetry_announce(void)
+{
+    for (uint8_t id = 0; id < telem_count; id++)
+        telem_send_schema(id);
+}
@@ -0,0 +1,285 @@
+/*
+ * uart_rx.c
+ *
+ * UART1/UART3 RX path (see uart_rx.h).
+ */
+#include "uart_rx.h"
+
+#include <string.h>
+
+/* Feed received bytes to the parser of the configured framing */
+static inline void uart_link_feed(UartRxPort *port, const uint8_t *data, uint16_t len)
+{
+    UART_RX_PROF_BEGIN(UART_RX_STAGE_PARSE);
+#if (UART_LINK_COBS != 0)
+    packet_cobs_feed_buf(port->cobs, data, len);
+#else
+    packet_parser_feed_buf(port->parser, data, len);
+#endif
+    UART_RX_PROF_END(UART_RX_STAGE_PARSE);
+}
+
+void uart_rx_port_init(UartRxPort *port, uint8_t *dma_buf, uint16_t dma_size,
+        BipBuf *bip, PacketParser *parser, PacketCobsParser *cobs)
+{
+    port->dma_buf = dma_buf;
+    port->dma_size = dma_size;
+    port->last_pos = 0;
+    port->bip = bip;
+    port->parser = parser;
+    port->cobs = cobs;
+    port->dma_anomaly = 0;
+    port->notify = NULL;
+    port->notify_ctx = NULL;
+    port->seq = 0;
+    port->rx_head = 0;
+    port->restart_head = 0;
+    port->restarts = 0;
+    port->task_restarts = 0;
+    port->task_pos = 0;
+    port->task_done = 0;
+    port->lapped = 0;
+    port->dma_cndtr = NULL;
+#if (SPSC_RING_STATS != 0)
+    spsc_stats_init(&port->dma_stats, dma_size);
+#endif
+}
+
+/* Contiguous regions are fed to the parser where they lie: frames that
+ * are whole inside a region are dispatched without a copy. */
+void uart_rx_drain(UartRxPort *port, uint16_t max_bytes)
+{
+    uint16_t count = 0;
+
+    bipbuf_sample(port->bip);
+    for (;;)
+    {
+        uint16_t n;
+        const uint8_t *data = bipbuf_peek(port->bip, &n);
+        if (data == NULL)
+            break;
+        if (max_bytes != 0U)
+        {
+            if (count >= max_bytes)
+                break;
+            if (n > max_bytes - count)
+                n = (uint16_t)(max_bytes - count);
+        }
+
+        uart_link_feed(port, data, n);
+        bipbuf_release(port->bip, n);
+        count += n;
+    }
+}
+
+/* Bytes from position a forward to position b in the circular buffer */
+static inline uint16_t uart_rx_dist(const UartRxPort *port, uint16_t a, uint16_t b)
+{
+    return (b >= a) ? (uint16_t)(b - a) : (uint16_t)(port->dma_size - a + b);
+}
+
+#if (UART_RX_ZERO_COPY == 0)
+/* Copy the bytes DMA wrote from last to cur_pos into the BipBuf */
+static void uart_rx_push(UartRxPort *port, uint16_t last, uint16_t cur_pos)
+{
+    // One reservation per event: the chunk stays contiguous even when
+    // the DMA write position wrapped. Without contiguous room it is
+    // stored split, like a plain ring (the parser copies split frames).
+    const uint8_t *dma_buf = port->dma_buf;
+    UART_RX_PROF_BEGIN(UART_RX_STAGE_PUSH);
+    uint16_t head = (cur_pos > last) ? (uint16_t)(cur_pos - last) : (uint16_t)(port->dma_size - last);
+    uint16_t wrap = (cur_pos > last) ? 0U : cur_pos;
+    uint8_t *dst = bipbuf_reserve(port->bip, (uint16_t)(head + wrap));
+    if (dst != NULL)
+    {
+        memcpy(dst, &dma_buf[last], head);
+        memcpy(&dst[head], dma_buf, wrap);
+        bipbuf_commit(port->bip, (uint16_t)(head + wrap));
+    }
+    else
+    {
+        bipbuf_write(port->bip, &dma_buf[last], head);
+        bipbuf_write(port->bip, dma_buf, wrap);
+    }
+    UART_RX_PROF_END(UART_RX_STAGE_PUSH);
+}
+#endif
+
+void uart_rx_set_notify(UartRxPort *port, void (*notify)(void *ctx), void *ctx)
+{
+    // ctx first: the ISR may run between the two stores
+    port->notify_ctx = ctx;
+    SPSC_STORE_REL(&port->notify, notify);
+}
+
+void uart_rx_set_dma_counter(UartRxPort *port, const volatile uint32_t *cndtr)
+{
+    port->dma_cndtr = cndtr;
+}
+
+#if (UART_RX_ZERO_COPY != 0)
+/* Bytes of the n ending at head that the DMA has overwritten by now: it
+ * reaches the oldest once it is more than dma_size - n bytes past head.
+ * Its lead is what the ISR published since head plus the live counter's
+ * distance from the last event. 0 without a counter. */
+static uint32_t uart_rx_overwritten(UartRxPort *port, uint32_t head, uint32_t n)
+{
+    const volatile uint32_t *cndtr = port->dma_cndtr;
+    uint32_t seq, now, ahead;
+    uint16_t pos, remaining;
+
+    if (cndtr == NULL)
+        return 0;
+    do
+    {
+        seq = SPSC_LOAD_ACQ(&port->seq);
+        now = port->rx_head;
+        pos = port->last_pos;
+        remaining = (uint16_t)*cndtr;
+    } while (seq != SPSC_LOAD_ACQ(&port->seq));
+
+    ahead = now - head;
+    if (remaining <= port->dma_size)
+    {
+        uint16_t live = (uint16_t)(port->dma_size - remaining);
+        if (live == port->dma_size)
+            live = 0;
+        ahead += uart_rx_dist(port, pos, live);
+    }
+    if (ahead <= port->dma_size - n)
+        return 0;
+    ahead -= port->dma_size - n;
+    return (ahead < n) ? ahead : n;
+}
+#endif
+
+void uart_rx_service(UartRxPort *port)
+{
+#if (UART_RX_ZERO_COPY != 0)
+    uint32_t seq, head, restart_head;
+    uint16_t pos, restarts;
+
+    // Consistent snapshot: retry if an RX event or restart came in between
+    do
+    {
+        seq = SPSC_LOAD_ACQ(&port->seq);
+        head = port->rx_head;
+        pos = port->last_pos;
+        restart_head = port->restart_head;
+        restarts = port->restarts;
+    } while (seq != SPSC_LOAD_ACQ(&port->seq));
+
+    uint16_t last = port->task_pos;
+    uint32_t done = port->task_done;
+    if (restarts != port->task_restarts)
+    {
+        // The DMA started over at 0; bytes of the old lap are gone
+        port->task_restarts = restarts;
+        last = 0;
+        done = restart_head;
+    }
+
+    uint32_t n = head - done;
+    if (n >= port->dma_size)
+    {
+        // The task ran a whole buffer late: the DMA overwrote the oldest
+        // bytes, resume at the newest event (the parser resyncs)
+        port->lapped += n;
+        last = pos;
+    }
+    else if (n != 0U)
+    {
+        // The DMA kept writing after the event: skip the oldest bytes it
+        // already overwrote, the parser resyncs on the rest
+        uint32_t lost = uart_rx_overwritten(port, head, n);
+        if (lost != 0U)
+        {
+            port->lapped += lost;
+            last = (uint16_t)((last + lost) % port->dma_size);
+        }
+        if (lost < n)
+        {
+            UART_RX_PROF_BEGIN(UART_RX_STAGE_PARSE);
+  #if (UART_LINK_COBS != 0)
+            packet_cobs_feed_dma(port->cobs, port->dma_buf, port->dma_size, last, pos);
+  #else
+            packet_parser_feed_dma(port->parser, port->dma_buf, port->dma_size, last, pos);
+  #endif
+            UART_RX_PROF_END(UART_RX_STAGE_PARSE);
+
+            // Overwritten while being parsed: the frame CRC rejects what it hit
+            uint32_t late = uart_rx_overwritten(port, head, n);
+            if (late > lost)
+                port->lapped += late - lost;
+        }
+        last = pos;
+    }
+
+    port->task_pos = last;
+    SPSC_STORE_REL(&port->task_done, head);
+#else
+    uart_rx_drain(port, 0);
+#endif
+}
+
+void uart_rx_on_event(UartRxPort *port, uint16_t pos, uint16_t dma_remaining)
+{
+    if ((pos > port->dma_size) || (dma_remaining > port->dma_size))
+    {
+        port->dma_anomaly++;
+        return;
+    }
+    // Transfer complete reports dma_size: the DMA is back at 0
+    if (pos == port->dma_size)
+        pos = 0;
+
+    uint16_t last = port->last_pos;
+    uint16_t n = uart_rx_dist(port, last, pos);
+
+#if (SPSC_RING_STATS != 0)
+    uint16_t live = (uint16_t)(port->dma_size - dma_remaining);
+    if (live == port->dma_size)
+        live = 0;
+  #if (UART_RX_ZERO_COPY != 0)
+    // Everything not parsed yet, the RX task's backlog included
+    uint32_t used = (port->rx_head + n) - SPSC_LOAD_ACQ(&port->task_done);
+  #else
+    uint32_t used = n;
+  #endif
+    used += uart_rx_dist(port, pos, live);
+    spsc_stats_put(&port->dma_stats, used, port->dma_size);
+    spsc_stats_sample(&port->dma_stats, used);
+#endif
+
+    if (n == 0U)
+        return;
+
+#if (UART_RX_ZERO_COPY != 0)
+    port->rx_head += n;
+#else
+    uart_rx_push(port, last, pos);
+#endif
+    port->last_pos = pos;
+    SPSC_STORE_REL(&port->seq, port->seq + 1U);
+
+    void (*notify)(void *ctx) = SPSC_LOAD_ACQ(&port->notify);
+    if (notify != NULL)
+    {
+        notify(port->notify_ctx);
+        return;
+    }
+#if (UART_RX_ZERO_COPY != 0)
+    uart_rx_service(port);
+#else
+    uart_rx_drain(port, UART_RX_ISR_DRAIN);
+#endif
+}
+
+void uart_rx_restart(UartRxPort *port)
+{
+    port->last_pos = 0;
+    port->restart_head = port->rx_head;
+    port->restarts++;
+    SPSC_STORE_REL(&port->seq, port->seq + 1U);
+    port->dma_anomaly++;
+}
@@ -0,0 +1,49 @@
+/*
+ * uart_rx_task.c
+ *
+ * Per-port RX task (see uart_rx_task.h).
+ */
+#include "uart_rx_task.h"
+
+#include "FreeRTOS.h"
+#include "task.h"
+
+/* Above the command dispatcher and ARQ link tasks it feeds: a zero-copy
+ * port has to be parsed before the DMA laps its buffer */
+static const osThreadAttr_t g_rx_task_attr_template = {
+    .priority = (osPriority_t) osPriorityHigh,
+    .stack_size = 256 * 4   // frame handler: arq_link_post_rx() message copy
+};
+
+/* RX event hook, ISR context */
+static void uart_rx_task_notify(void *ctx)
+{
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR((TaskHandle_t) ctx, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+
+static void uart_rx_task(void *argument)
+{
+    UartRxPort *port = (UartRxPort *) argument;
+
+    /* Take over from the ISR before touching the parser: until the hook is
+     * set, RX events still parse in interrupt context. An event that read
+     * the old (NULL) hook has finished by the time this call returns, since
+     * it preempts this task. */
+    uart_rx_set_notify(port, uart_rx_task_notify, xTaskGetCurrentTaskHandle());
+
+    for (;;)
+    {
+        // First pass: whatever arrived before the hook was set
+        uart_rx_service(port);
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    }
+}
+
+osThreadId_t uart_rx_task_start(UartRxPort *port, const char *name)
+{
+    osThreadAttr_t attr = g_rx_task_attr_template;
+    attr.name = name;
+    return osThreadNew(uart_rx_task, port, &attr);
+}
@@ -8,20 +8,29 @@
 #include "console.h"
 #include "packet.h"
 #include "cmd.h"
+#include "packet_tx.h"
 #include <string.h>
 #include <stdio.h>
 
 #define TEST_PKT_MAX 64
 
+#define TEST_TX_FRAMES    500
+#define TEST_TX_RING_SIZE 256
+
 static UART_HandleTypeDef *test_huart;
 static RingBuffer test_rb;
+static uint8_t test_rb_buf[RB_SIZE];
 static PacketParser test_parser;
 
+static PacketTx test_tx;
+static uint8_t test_tx_ring[TEST_TX_RING_SIZE];
+
 void uart_test_init(UART_HandleTypeDef *huart)
 {
     test_huart = huart;
-    rb_init(&test_rb);
+    rb_init(&test_rb, test_rb_buf, sizeof(test_rb_buf), SPSC_RING_REJECT_NEWEST);
     packet_parser_init(&test_parser);
+    packet_tx_init(&test_tx, huart, test_tx_ring, sizeof(test_tx_ring));
 
     print("UART test module initialized\n");
 }
@@ -29,13 +38,63 @@ void uart_test_init(UART_HandleTypeDef *huart)
 /* Feed data into RingBuffer to simulate DMA/IDLE reception */
 void uart_test_feed_data(uint8_t *data, uint16_t len)
 {
-    for (uint16_t i = 0; i < len; i++)
-        rb_push(&test_rb, data[i]);
+    rb_write(&test_rb, data, len);
 
     // Simulate the parser processing continuously
-    uint8_t ch;
-    while (rb_pop(&test_rb, &ch))
-        packet_parser_feed(&test_parser, ch);
+    uint8_t chunk[16];
+    uint16_t n;
+    do
+    {
+        n = rb_read(&test_rb, chunk, sizeof(chunk));
+        packet_parser_feed_buf(&test_parser, chunk, n);
+    } while (n == sizeof(chunk));
+}
+
+/* Send TEST_TX_FRAMES UART_TX frames (2 payload segments) both ways and
+ * report frames/s. "spins" counts loop passes the CPU had free while the
+ * DMA path waited for ring space, i.e. time the blocking path burns. */
+static void uart_test_tx_throughput(void)
+{
+    static const uint8_t tag[] = "TX";
+    uint8_t body[16];
+    uint8_t params[sizeof(tag) + sizeof(body)];
+    uint8_t packet[TEST_PKT_MAX];
+
+    for (uint8_t i = 0; i < sizeof(body); i++)
+        body[i] = (uint8_t)('a' + i);
+
+    // Blocking: copy params, build, checksum loop, HAL_UART_Transmit
+    uint32_t t0 = HAL_GetTick();
+    for (int i = 0; i < TEST_TX_FRAMES; i++)
+    {
+        memcpy(params, tag, sizeof(tag));
+        memcpy(params + sizeof(tag), body, sizeof(body));
+        uint8_t len = build_packet(packet, UART_TX, params, sizeof(params));
+        uart_send_bytes(test_huart, packet, len);
+    }
+    uint32_t t_block = HAL_GetTick() - t0;
+
+    // DMA ring: scatter-gather build, CPU free while the UART drains
+    const PktIoVec iov[] = {
+        { tag, sizeof(tag) },
+        { body, sizeof(body) },
+    };
+    uint32_t spins = 0;
+    t0 = HAL_GetTick();
+    for (int i = 0; i < TEST_TX_FRAMES; i++)
+    {
+        while (packet_tx_send_v1(&test_tx, UART_TX, iov, 2) < 0)
+            spins++;
+    }
+    while (packet_tx_pending(&test_tx) != 0U)
+        spins++;
+    uint32_t t_dma = HAL_GetTick() - t0;
+
+    print("blocking : %d frames in %lu ms (%lu frames/s)\r\n", TEST_TX_FRAMES,
+            t_block, t_block ? (TEST_TX_FRAMES * 1000UL) / t_block : 0UL);
+    print("dma ring : %d frames in %lu ms (%lu frames/s), free spins %lu, full %lu\r\n",
+            TEST_TX_FRAMES, t_dma, t_dma ? (TEST_TX_FRAMES * 1000UL) / t_dma : 0UL,
+            spins, test_tx.full);
 }
 
 /* -------------------- Test Cases -------------------- */
@@ -85,6 +144,51 @@ void uart_test_run(UART_TestCase test_case)
         }
         break;
 
+    case UART_TEST_MIXED_VERSIONS:
+        print("\r\n=== UART_TEST_MIXED_VERSIONS (v1 + v2 frames) ===\r\n");
+        // LED_ON (v1) + SET_LED (v2, seq 1) + UART_TX (v2, seq 2)
+        len = build_packet(packet, LED_ON, NULL, 0);
+        len += build_packet_v2(packet+len, 1, SET_LED, (uint8_t[]){1}, 1);
+        {
+            uint8_t tx_msg[] = "v2!\r\n";
+            len += build_packet_v2(packet+len, 2, UART_TX, tx_msg, sizeof(tx_msg));
+        }
+        uart_send_bytes(test_huart, packet, len);
+        break;
+
+    case UART_TEST_COBS_FRAMES:
+        print("\r\n=== UART_TEST_COBS_FRAMES (0x00 delimited) ===\r\n");
+        // LED_ON + SET_LED, each frame COBS encoded and delimited
+        {
+            uint8_t frame[TEST_PKT_MAX];
+            uint8_t flen = build_packet(frame, LED_ON, NULL, 0);
+            len = packet_cobs_encode(packet, frame, flen);
+            flen = build_packet(frame, SET_LED, (uint8_t[]){1}, 1);
+            len += packet_cobs_encode(packet+len, frame, flen);
+        }
+        uart_send_bytes(test_huart, packet, len);
+        break;
+
+    case UART_TEST_CMD_BATCH:
+        print("\r\n=== UART_TEST_CMD_BATCH (STICKY commands in one frame) ===\r\n");
+        // LED_ON + SET_LED + UART_TX as sub-commands of one BATCH frame;
+        // the reply is a "batch_status" telemetry record on the console
+        {
+            uint8_t batch[TEST_PKT_MAX - PKT_V1_OVERHEAD - 1];
+            uint8_t tx_msg[] = "Hi!\r\n";
+            uint16_t n = packet_batch_append(batch, sizeof(batch), 0, LED_ON, NULL, 0);
+            n = packet_batch_append(batch, sizeof(batch), n, SET_LED, (uint8_t[]){1}, 1);
+            n = packet_batch_append(batch, sizeof(batch), n, UART_TX, tx_msg, sizeof(tx_msg));
+            len = build_packet(packet, BATCH, batch, (uint8_t)n);
+        }
+        uart_send_bytes(test_huart, packet, len);
+        break;
+
+    case UART_TEST_TX_THROUGHPUT:
+        print("\r\n=== UART_TEST_TX_THROUGHPUT (blocking vs DMA ring) ===\r\n");
+        uart_test_tx_throughput();
+        break;
+
     default:
         print("\r\nUnknown test case\r\n");
         break;
@@ -92,3 +196,64 @@ void uart_test_run(UART_TestCase test_case)
 }
 
 
+
+#if (ARQ_ENABLE != 0)
+/* -------------------- ARQ loopback -------------------- */
+typedef struct
+{
+    ArqLink *tx;
+    ArqLink *rx;
+} UartTestArq;
+
+static UartTestArq test_arq;
+
+static const osThreadAttr_t test_arq_task_attr = {
+    .name = "arqTest",
+    .priority = (osPriority_t) osPriorityNormal,
+    .stack_size = 256 * 4
+};
+
+static void uart_test_arq_task(void *argument)
+{
+    UartTestArq *t = (UartTestArq *) argument;
+    const ArqStats *tx = arq_link_stats(t->tx);
+    const ArqStats *rx = arq_link_stats(t->rx);
+    uint32_t full = 0;
+
+    osDelay(100);   // let both link tasks start
+    print("\r\n=== UART_TEST_ARQ (%d commands through arq_link_send) ===\r\n",
+            UART_TEST_ARQ_CMDS);
+
+    uint32_t base = rx->delivered;
+    uint32_t base_bytes = rx->delivered_bytes;
+    uint32_t t0 = HAL_GetTick();
+    for (int i = 0; i < UART_TEST_ARQ_CMDS; i++)
+    {
+        uint8_t cmd = (i & 1) ? LED_OFF : LED_ON;
+        while (arq_link_send(t->tx, &cmd, 1, 100) == -1)
+            full++;
+    }
+
+    // Stats are written by the link tasks; a stale read only delays the exit
+    while (((rx->delivered - base) < (uint32_t) UART_TEST_ARQ_CMDS)
+            && ((HAL_GetTick() - t0) < 10000U))
+        osDelay(10);
+    uint32_t ms = HAL_GetTick() - t0;
+    uint32_t bytes = rx->delivered_bytes - base_bytes;
+
+    print("arq: delivered %lu/%d in %lu ms (%lu B/s), queue full %lu\r\n",
+            rx->delivered - base, UART_TEST_ARQ_CMDS, ms,
+            ms ? (bytes * 1000UL) / ms : 0UL, full);
+    print("arq: tx retransmits=%lu timeouts=%lu nacks_rx=%lu, rx dup=%lu nacks_tx=%lu\r\n",
+            tx->retransmits, tx->timeouts, tx->nacks_rx, rx->dup_rx, rx->nacks_tx);
+
+    osThreadExit();
+}
+
+void uart_test_arq_start(ArqLink *tx, ArqLink *rx)
+{
+    test_arq.tx = tx;
+    test_arq.rx = rx;
+    osThreadNew(uart_test_arq_task, &test_arq, &test_arq_task_attr);
+}
+#endif
@@ -0,0 +1,296 @@
+/*
+ * arq_sim.cpp
+ *
+ * Host harness for the ARQ engine (Core/Src/arq.c, compiled unchanged):
+ * two endpoints joined by a simulated UART byte pipe per direction.
+ *
+ *  - the line serializes bytes at the baud rate (10 bits per byte), then
+ *    adds a fixed one-way delay
+ *  - each frame is dropped with probability --loss, and every byte is hit
+ *    by bit errors at --ber (the receiver's PacketParser rejects it)
+ *  - the receiving side runs the firmware PacketParser over the bytes and
+ *    hands v2 frames to arq_on_frame(); arq_poll() runs every --tick ms,
+ *    like the FreeRTOS timer in arq_link.c
+ *
+ * A saturating sender pushes numbered UART_TX commands through arq_send()
+ * whenever the window has room; the receiver checks that they arrive
+ * exactly once and in order. The sweep reports goodput against window
+ * size for each loss rate.
+ *
+ *   ./arq_sim [--frames N] [--baud B] [--delay MS] [--rto MS] [--tick MS]
+ *             [--payload BYTES] [--ber X] [--seed S]
+ */
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "host_args.hpp"
+#include "arq.h"
+#include "cmd.h"
+
+/* arq.c / packet_codec.c reference these; no command table on the host */
+extern "C" void packet_default_handler(void *ctx, const PacketFrame *frame)
+{
+    (void)ctx;
+    (void)frame;
+}
+
+namespace
+{
+
+struct Options
+{
+    uint32_t frames = 2000;     // commands to deliver per run
+    uint32_t baud = 115200;
+    uint32_t delay_ms = 10;     // one-way propagation / turnaround delay
+    uint32_t rto_ms = 0;        // 0: derived from the round trip
+    uint32_t tick_ms = 10;      // arq_poll() period (ARQ_LINK_TICK_MS)
+    uint32_t payload = 32;      // CMD + PAYLOAD bytes per command
+    double ber = 0;             // bit error rate on top of frame loss
+    uint32_t seed = 1;
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--frames", o.frames),
+        host_args::opt("--baud", o.baud),
+        host_args::opt("--delay", o.delay_ms),
+        host_args::opt("--rto", o.rto_ms),
+        host_args::opt("--tick", o.tick_ms),
+        host_args::opt("--payload", o.payload),
+        host_args::opt("--ber", o.ber),
+        host_args::opt("--seed", o.seed),
+    });
+    o.payload = std::min<uint32_t>(std::max<uint32_t>(o.payload, 5), ARQ_MAX_PAYLOAD);
+    o.tick_ms = std::max<uint32_t>(o.tick_ms, 1);
+    return o;
+}
+
+/* One direction of the UART: bytes leave back to back at the baud rate and
+ * arrive delay later; drop / corruption is decided per frame at send time */
+class Pipe
+{
+public:
+    Pipe(const Options &o, double loss, std::mt19937 &rng)
+        : us_per_byte_(10e6 / o.baud), delay_us_(o.delay_ms * 1000.0), loss_(loss),
+          ber_(o.ber), rng_(rng) {}
+
+    void send(double now_us, const uint8_t *frame, uint16_t len)
+    {
+        std::vector<uint8_t> bytes(frame, frame + len);
+        if (ber_ > 0)
+        {
+            std::bernoulli_distribution flip(ber_);
+            for (uint8_t &b : bytes)
+                for (int bit = 0; bit < 8; bit++)
+                    if (flip(rng_))
+                        b ^= static_cast<uint8_t>(1U << bit);
+        }
+        bool drop = std::bernoulli_distribution(loss_)(rng_);
+
+        double t = std::max(now_us, line_free_us_);
+        for (uint8_t b : bytes)
+        {
+            t += us_per_byte_;
+            if (!drop)
+                q_.push_back({t + delay_us_, b});
+        }
+        line_free_us_ = t;
+    }
+
+    /* Bytes that have arrived by now */
+    size_t receive(double now_us, uint8_t *out, size_t cap)
+    {
+        size_t n = 0;
+        while (!q_.empty() && (q_.front().at_us <= now_us) && (n < cap))
+        {
+            out[n++] = q_.front().byte;
+            q_.pop_front();
+        }
+        return n;
+    }
+
+    /* Transmitter done with everything handed to it (HAL_UART_Transmit returned) */
+    bool tx_idle(double now_us) const { return line_free_us_ <= now_us; }
+
+private:
+    struct InFlight
+    {
+        double at_us;
+        uint8_t byte;
+    };
+
+    double us_per_byte_;
+    double delay_us_;
+    double loss_;
+    double ber_;
+    std::mt19937 &rng_;
+    std::deque<InFlight> q_;
+    double line_free_us_ = 0;
+};
+
+/* One side of the link: an Arq instance and the parser feeding it */
+struct Endpoint
+{
+    Arq arq;
+    PacketParser parser;
+    Pipe *tx = nullptr;
+    double now_us = 0;
+
+    // Delivery check (receiver only)
+    uint32_t expect = 0;
+    uint32_t out_of_order = 0;
+
+    static void tx_fn(void *ctx, const uint8_t *frame, uint16_t len)
+    {
+        Endpoint *e = static_cast<Endpoint *>(ctx);
+        e->tx->send(e->now_us, frame, len);
+    }
+
+    static void deliver_fn(void *ctx, const uint8_t *payload, uint16_t len)
+    {
+        Endpoint *e = static_cast<Endpoint *>(ctx);
+        uint32_t n = 0;
+        if (len >= 5)
+            std::memcpy(&n, &payload[1], sizeof(n));
+        if ((len < 5) || (n != e->expect))
+            e->out_of_order++;
+        e->expect++;
+    }
+
+    static void on_frame(void *ctx, const PacketFrame *frame)
+    {
+        Endpoint *e = static_cast<Endpoint *>(ctx);
+        if (frame->version == 2)
+            arq_on_frame(&e->arq, frame, static_cast<uint32_t>(e->now_us / 1000));
+    }
+
+    void init(uint8_t window, uint32_t rto_ms, Pipe *out)
+    {
+        tx = out;
+        arq_init(&arq, window, rto_ms, tx_fn, deliver_fn, this);
+        packet_parser_init(&parser);
+        packet_parser_set_handler(&parser, on_frame, this);
+    }
+
+    void poll_rx(Pipe &in)
+    {
+        uint8_t buf[64];
+        size_t n;
+        while ((n = in.receive(now_us, buf, sizeof(buf))) > 0)
+            packet_parser_feed_buf(&parser, buf, n);
+    }
+};
+
+struct Result
+{
+    double seconds;
+    double goodput_bps;     // delivered CMD + PAYLOAD bits per second
+    double line_share;      // goodput / raw line rate (8 data bits per 10)
+    uint32_t retransmits;
+    uint32_t timeouts;
+    uint32_t nacks;
+    uint32_t out_of_order;
+    bool done;
+};
+
+Result run(const Options &o, uint8_t window, double loss, uint32_t rto_ms)
+{
+    std::mt19937 rng(o.seed);
+    Pipe a_to_b(o, loss, rng), b_to_a(o, loss, rng);
+    Endpoint a, b;
+    a.init(window, rto_ms, &a_to_b);
+    b.init(window, rto_ms, &b_to_a);
+
+    std::vector<uint8_t> cmd(o.payload);
+    uint32_t sent = 0;
+    const double step_us = 100;
+    const double limit_us = 3600e6;
+    double next_tick_us = 0;
+    double t = 0;
+
+    while ((b.expect < o.frames) && (t < limit_us))
+    {
+        a.now_us = b.now_us = t;
+        uint32_t now_ms = static_cast<uint32_t>(t / 1000);
+
+        a.poll_rx(b_to_a);
+        b.poll_rx(a_to_b);
+
+        // Saturating source: keep the window full. A frame is handed over only
+        // once the UART is free, as the blocking HAL_UART_Transmit() in
+        // arq_link_tx() would
+        while ((sent < o.frames) && (arq_window_free(&a.arq) > 0U) && a_to_b.tx_idle(t))
+        {
+            cmd[0] = UART_TX;
+            std::memcpy(&cmd[1], &sent, sizeof(sent));
+            for (uint32_t k = 5; k < o.payload; k++)
+                cmd[k] = static_cast<uint8_t>(sent + k);
+            if (arq_send(&a.arq, cmd.data(), static_cast<uint16_t>(o.payload), now_ms) != 0)
+                break;
+            sent++;
+        }
+
+        if (t >= next_tick_us)
+        {
+            arq_poll(&a.arq, now_ms);
+            arq_poll(&b.arq, now_ms);
+            next_tick_us += o.tick_ms * 1000.0;
+        }
+        t += step_us;
+    }
+
+    Result r;
+    r.seconds = t / 1e6;
+    r.goodput_bps = b.arq.stats.delivered_bytes * 8.0 / r.seconds;
+    r.line_share = r.goodput_bps / (o.baud * 0.8);
+    r.retransmits = a.arq.stats.retransmits;
+    r.timeouts = a.arq.stats.timeouts;
+    r.nacks = a.arq.stats.nacks_rx;
+    r.out_of_order = b.out_of_order;
+    r.done = (b.expect >= o.frames);
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const Options opt = parse_args(argc, argv);
+    const double losses[] = {0.0, 0.01, 0.05, 0.10, 0.20};
+
+    // Round trip of one data frame + its ACK, plus one poll tick of slack
+    double frame_ms = (opt.payload + PKT_V2_OVERHEAD) * 10e3 / opt.baud;
+    double ack_ms = (3 + PKT_V2_OVERHEAD) * 10e3 / opt.baud;
+    uint32_t rto = opt.rto_ms ? opt.rto_ms
+            : static_cast<uint32_t>(frame_ms + ack_ms + 2 * opt.delay_ms + opt.tick_ms + 1);
+
+    std::printf("%u commands of %u B, %u baud, delay %u ms one way, RTO %u ms, tick %u ms",
+            opt.frames, opt.payload, opt.baud, opt.delay_ms, rto, opt.tick_ms);
+    if (opt.ber > 0)
+        std::printf(", BER %.0e", opt.ber);
+    std::printf("\nstop-and-wait bound (window 1, no loss): %.1f%% of the line\n\n",
+            100.0 * frame_ms / (frame_ms + ack_ms + 2 * opt.delay_ms));
+
+    std::printf("%5s %6s %12s %8s %8s %8s %6s\n", "loss", "window", "goodput", "line",
+            "retx", "timeouts", "nacks");
+    int rc = 0;
+    for (double loss : losses)
+    {
+        for (uint8_t w = 1; w <= ARQ_WINDOW_MAX; w <<= 1)
+        {
+            Result r = run(opt, w, loss, rto);
+            std::printf("%4.0f%% %6u %8.1f kb/s %7.1f%% %8u %8u %6u%s\n", loss * 100, w,
+                    r.goodput_bps / 1000, r.line_share * 100, r.retransmits, r.timeouts,
+                    r.nacks, (r.done && r.out_of_order == 0) ? "" : "  FAIL");
+            rc |= !(r.done && r.out_of_order == 0);
+        }
+        std::printf("\n");
+    }
+    return rc;
+}
@@ -0,0 +1,454 @@
+"""Generate the command tables from the schema in Core/Inc/cmd_list.h.
+
+One run writes every file derived from the X(ID, handler, console,
+CMD_ARGS(...)) entries:
+
+    Core/Inc/cmd_hash.h          console name lookup (gen_cmd_hash.py)
+    Core/Inc/cmd_table.h         console + binary dispatch tables, CmdArgs_*
+                                 structs, typed argument decoding
+    tools/packet/cmd_encoder.py  host encoders for the binary commands
+
+The firmware decoders read every argument at a fixed offset (the layout is
+known at generation time) and the tables are indexed by CMD_ID, so a new
+command adds no lookup or decode cost to the existing ones.
+
+Examples:
+    python tools/cmdgen/gen_cmd.py
+    python tools/cmdgen/gen_cmd.py --check      # exit 1 if outputs are stale
+"""
+
+import argparse
+import os
+import re
+import sys
+
+import gen_cmd_hash
+
+REPO = gen_cmd_hash.REPO
+CMD_LIST_H = gen_cmd_hash.CMD_LIST_H
+CMD_HASH_H = gen_cmd_hash.CMD_HASH_H
+CMD_TABLE_H = os.path.join(REPO, "Core", "Inc", "cmd_table.h")
+CMD_ENCODER_PY = os.path.join(REPO, "tools", "packet", "cmd_encoder.py")
+
+CON_AUTO = "CMD_CON_AUTO"
+BIN_ARGS_MAX = 255      # BinCmdEntry.arg_len_max is 8-bit
+
+# type -> (size, C type, struct code, min, max)
+TYPES = {
+    "u8":  (1, "uint8_t",  "B", 0, 0xFF),
+    "i8":  (1, "int8_t",   "b", -0x80, 0x7F),
+    "u16": (2, "uint16_t", "H", 0, 0xFFFF),
+    "i16": (2, "int16_t",  "h", -0x8000, 0x7FFF),
+    "u32": (4, "uint32_t", "I", 0, 0xFFFFFFFF),
+    "i32": (4, "int32_t",  "i", -0x80000000, 0x7FFFFFFF),
+    "bytes": (None, None, None, None, None),
+}
+
+ENTRY_RE = re.compile(
+    r"\bX\(\s*(\w+)\s*,\s*(\w+)\s*,\s*(\w+)\s*,\s*CMD_ARGS\(([^)]*)\)\s*\)")
+
+
+class Arg:
+    def __init__(self, type_, name):
+        self.type = type_
+        self.name = name
+        self.size, self.ctype, self.code, self.lo, self.hi = TYPES[type_]
+
+
+class Cmd:
+    def __init__(self, index, ident, handler, console, args):
+        self.index = index
+        self.id = ident
+        self.handler = handler
+        self.console = console
+        self.args = args
+        self.fixed = sum(a.size for a in args if a.type != "bytes")
+        self.tail = bool(args) and args[-1].type == "bytes"
+        self.len_min = self.fixed + (1 if self.tail else 0)
+        self.len_max = BIN_ARGS_MAX if self.tail else self.fixed
+
+
+def read_schema(path):
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    text = re.sub(r"/\*.*?\*/|//[^\n]*", "", text, flags=re.S)
+
+    cmds = []
+    for i, (ident, handler, console, arg_text) in enumerate(ENTRY_RE.findall(text)):
+        args = []
+        for item in filter(None, (s.strip() for s in arg_text.split(","))):
+            parts = item.split()
+            if len(parts) != 2 or parts[0] not in TYPES:
+                raise ValueError("%s: bad argument '%s'" % (ident, item))
+            args.append(Arg(*parts))
+        names = [a.name for a in args]
+        if len(set(names)) != len(names):
+            raise ValueError("%s: duplicate argument name" % ident)
+        if any(a.type == "bytes" for a in args[:-1]):
+            raise ValueError("%s: 'bytes' must be the last argument" % ident)
+        cmd = Cmd(i, ident, handler, console, args)
+        if cmd.len_min > BIN_ARGS_MAX:
+            raise ValueError("%s: arguments exceed %d bytes" % (ident, BIN_ARGS_MAX))
+        cmds.append(cmd)
+
+    # Every X(...) entry must have matched the full schema form
+    if len(cmds) != len(gen_cmd_hash.read_cmd_list(path)):
+        raise ValueError("malformed X(...) entry in %s" % path)
+    return cmds
+
+
+# ---------- Core/Inc/cmd_table.h ----------
+def _c_load(arg, off):
+    if arg.size == 1:
+        raw = "args[%d]" % off
+    elif arg.size == 2:
+        raw = "args[%d] | (args[%d] << 8)" % (off, off + 1)
+    else:
+        raw = ("(uint32_t)args[%d] | ((uint32_t)args[%d] << 8)"
+               " | ((uint32_t)args[%d] << 16) | ((uint32_t)args[%d] << 24)"
+               % (off, off + 1, off + 2, off + 3))
+    if arg.type.startswith("i"):
+        return "(%s)(u%s)(%s)" % (arg.ctype, arg.ctype, raw)
+    return "(%s)(%s)" % (arg.ctype, raw)
+
+
+def _c_struct(cmd):
+    lines = ["typedef struct", "{"]
+    for a in cmd.args:
+        if a.type == "bytes":
+            lines.append("    const uint8_t *%s;" % a.name)
+            lines.append("    uint16_t %s_len;" % a.name)
+        else:
+            lines.append("    %s %s;" % (a.ctype, a.name))
+    lines.append("} CmdArgs_%s;" % cmd.id)
+    return "\n".join(lines)
+
+
+def _c_bin_decoder(cmd):
+    out = ["static int %s_bin(const uint8_t *args, uint16_t len)" % cmd.handler, "{"]
+    if not cmd.args:
+        out += ["    (void)args; (void)len;", "    return %s();" % cmd.handler, "}"]
+        return "\n".join(out)
+
+    out.append("    CmdArgs_%s a;" % cmd.id)
+    if not cmd.tail:
+        out.append("    (void)len;")
+    off = 0
+    for a in cmd.args:
+        if a.type == "bytes":
+            out.append("    a.%s = &args[%d];" % (a.name, off))
+            out.append("    a.%s_len = %s;" % (a.name, "len" if off == 0 else "(uint16_t)(len - %du)" % off))
+        else:
+            out.append("    a.%s = %s;" % (a.name, _c_load(a, off)))
+            off += a.size
+    out += ["    return %s(&a);" % cmd.handler, "}"]
+    return "\n".join(out)
+
+
+def _c_int(v):
+    return "(-0x7FFFFFFF - 1)" if v == -0x80000000 else str(v)
+
+
+def _c_count(n):
+    return "no parameters" if n == 0 else "%d parameter%s" % (n, "" if n == 1 else "s")
+
+
+def _c_con_decoder(cmd):
+    n = len(cmd.args)
+    out = ["static void %s_con(int para_count, char **para)" % cmd.handler, "{"]
+    if not cmd.args:
+        out.append("    (void)para;")
+    out += [
+        "    if (para_count != %d)" % n,
+        "    {",
+        '        print("error: %s takes %s\\r\\n");' % (cmd.id, _c_count(n)),
+        "        return;",
+        "    }",
+    ]
+    if not cmd.args:
+        out += ["    %s();" % cmd.handler, "}"]
+        return "\n".join(out)
+
+    out.append("    CmdArgs_%s a;" % cmd.id)
+    ints = [a for a in cmd.args if a.type != "bytes"]
+    if ints:
+        out.append("    int32_t v;")
+    for i, a in enumerate(cmd.args):
+        if a.type == "bytes":
+            out.append("    a.%s = (const uint8_t *)para[%d];" % (a.name, i))
+            out.append("    a.%s_len = (uint16_t)strlen(para[%d]);" % (a.name, i))
+            continue
+        if a.type == "u32":
+            parse = "cmd_con_u32(para[%d], &a.%s)" % (i, a.name)
+            out += ["    if (%s != 0)" % parse]
+        else:
+            out += ["    if (cmd_con_int(para[%d], %s, %s, &v) != 0)" % (i, _c_int(a.lo), _c_int(a.hi))]
+        out += [
+            "    {",
+            '        print("error: %s: bad %s \'%%s\' (%s)\\r\\n", para[%d]);' % (cmd.id, a.name, a.type, i),
+            "        return;",
+            "    }",
+        ]
+        if a.type != "u32":
+            out.append("    a.%s = (%s)v;" % (a.name, a.ctype))
+    out += ["    %s(&a);" % cmd.handler, "}"]
+    return "\n".join(out)
+
+
+def _c_proto(cmd):
+    if cmd.args:
+        return "static int %s(const CmdArgs_%s *a);" % (cmd.handler, cmd.id)
+    return "static int %s(void);" % cmd.handler
+
+
+def render_table_h(cmds):
+    structs = [_c_struct(c) for c in cmds if c.args]
+    protos = [_c_proto(c) for c in cmds]
+    customs = sorted({c.console for c in cmds if c.console != CON_AUTO})
+    asserts = ['_Static_assert(%s == %d, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");'
+               % (c.id, c.index) for c in cmds]
+    bins = [_c_bin_decoder(c) for c in cmds]
+    cons = [_c_con_decoder(c) for c in cmds if c.console == CON_AUTO]
+    width = max(len(c.id) for c in cmds) + 3
+    text_rows = ['    {"%s",%s%s},' % (c.id, " " * (width - len(c.id) - 2),
+                                      c.handler + "_con" if c.console == CON_AUTO else c.console)
+                 for c in cmds]
+    bin_rows = ["    [%s]%s= {%d, %d, %s_bin}," % (c.id, " " * (width - len(c.id) - 2),
+                                                 c.len_min, c.len_max, c.handler) for c in cmds]
+
+    return """/*
+ * cmd_table.h
+ *
+ *  GENERATED by tools/cmdgen/gen_cmd.py from cmd_list.h - do not edit.
+ *  Included once by cmd.c: CmdArgs_* structs, argument decoding and the
+ *  console / binary dispatch tables indexed by CMD_ID.
+ *
+ *  Binary args are little-endian at fixed offsets; the length is checked
+ *  against bin_cmd_table before the decoder runs.
+ */
+
+#ifndef INC_CMD_TABLE_H_
+#define INC_CMD_TABLE_H_
+
+#include <stdint.h>
+#include <string.h>
+
+#include "cmd.h"
+
+%s
+
+_Static_assert(INVALID_CMD == %d, "cmd_table.h is stale: run tools/cmdgen/gen_cmd.py");
+
+/* ---------- argument structs ---------- */
+%s
+
+/* ---------- handlers (cmd.c) ---------- */
+%s
+%s
+
+/* ---------- binary decoders ---------- */
+%s
+
+/* ---------- console decoders ---------- */
+%s
+
+/* ---------- tables ---------- */
+/* Console table, indexed by CMD_ID */
+static const CmdEntry cmd_table[] = {
+%s
+    {"INVALID_CMD",%sfunc_invalid},
+};
+
+/* Binary table (packet links), indexed by CMD_ID: {arg_len_min, arg_len_max, decoder} */
+static const BinCmdEntry bin_cmd_table[INVALID_CMD] = {
+%s
+};
+
+#endif /* INC_CMD_TABLE_H_ */
+""" % ("\n".join(asserts), len(cmds),
+       "\n\n".join(structs),
+       "\n".join(protos),
+       "\n".join("void %s(int para_count, char **para);" % f for f in customs + ["func_invalid"]),
+       "\n\n".join(bins),
+       "\n\n".join(cons),
+       "\n".join(text_rows), " " * (width - len("INVALID_CMD") - 2),
+       "\n".join(bin_rows))
+
+
+# ---------- tools/packet/cmd_encoder.py ----------
+def render_encoder_py(cmds):
+    ids = "\n".join('    "%s": 0x%02X,' % (c.id, c.index) for c in cmds)
+    schema = "\n".join('    "%s": [%s],' % (c.id, ", ".join('("%s", "%s")' % (a.name, a.type) for a in c.args))
+                       for c in cmds)
+    limits = "\n".join('    "%s": (%d, %d),' % (c.id, c.len_min, c.len_max) for c in cmds)
+    funcs = []
+    for c in cmds:
+        params = ", ".join(a.name for a in c.args)
+        funcs.append('def %s(%s):\n    """%s payload: CMD 0x%02X%s."""\n    return encode("%s"%s)\n'
+                     % (c.id.lower(), params, c.id, c.index,
+                        "".join(", %s %s" % (a.type, a.name) for a in c.args),
+                        c.id, "".join(", " + a.name for a in c.args)))
+
+    return '''"""Binary command encoders for the UART1/UART3 packet links.
+
+GENERATED by tools/cmdgen/gen_cmd.py from Core/Inc/cmd_list.h - do not edit.
+Layouts match the firmware decoders in Core/Inc/cmd_table.h.
+
+Payload = CMD byte + little-endian args; frame() wraps it in a v1 / v2
+packet (packet_codec.py reference encoders).
+
+Examples:
+    python tools/packet/cmd_encoder.py PWM_ON 50 1000
+    python tools/packet/cmd_encoder.py --v2 --seq 3 UART_TX hello
+    python tools/packet/cmd_encoder.py --list
+
+    import cmd_encoder as ce
+    ser.write(ce.frame(ce.pwm_on(50, 1000)))
+"""
+
+import argparse
+import struct
+import sys
+
+CMD_IDS = {
+%s
+}
+INVALID_CMD = 0x%02X
+
+# CMD -> [(arg, type)], wire order
+SCHEMA = {
+%s
+}
+
+# CMD -> (arg_len_min, arg_len_max), as bin_cmd_table
+ARG_LIMITS = {
+%s
+}
+
+_CODES = {"u8": "B", "i8": "b", "u16": "H", "i16": "h", "u32": "I", "i32": "i"}
+
+
+def encode(name, *values):
+    """CMD + args payload for command name."""
+    args = SCHEMA[name]
+    if len(values) != len(args):
+        raise TypeError("%%s takes %%d arguments" %% (name, len(args)))
+    out = bytearray([CMD_IDS[name]])
+    for (arg, type_), value in zip(args, values):
+        if type_ == "bytes":
+            out += value.encode() if isinstance(value, str) else bytes(value)
+        else:
+            try:
+                out += struct.pack("<" + _CODES[type_], value)
+            except struct.error as exc:
+                raise ValueError("%%s: %%s out of range for %%s" %% (name, arg, type_)) from exc
+    lo, hi = ARG_LIMITS[name]
+    if not lo <= len(out) - 1 <= hi:
+        raise ValueError("%%s: %%d arg bytes, expected %%d..%%d" %% (name, len(out) - 1, lo, hi))
+    return bytes(out)
+
+
+def decode(payload):
+    """(name, {arg: value}) of a payload, as the firmware decodes it."""
+    names = {v: k for k, v in CMD_IDS.items()}
+    name = names.get(payload[0])
+    if name is None:
+        raise ValueError("unknown CMD 0x%%02X" %% payload[0])
+    lo, hi = ARG_LIMITS[name]
+    if not lo <= len(payload) - 1 <= hi:
+        raise ValueError("%%s: bad arg length %%d" %% (name, len(payload) - 1))
+    values = {}
+    off = 1
+    for arg, type_ in SCHEMA[name]:
+        if type_ == "bytes":
+            values[arg] = bytes(payload[off:])
+            break
+        fmt = struct.Struct("<" + _CODES[type_])
+        values[arg] = fmt.unpack_from(payload, off)[0]
+        off += fmt.size
+    return name, values
+
+
+def frame(payload, v2=False, seq=0):
+    """v1 (default) or v2 packet around a payload."""
+    import packet_codec
+
+    if v2:
+        return packet_codec.encode_v2_ref(seq, payload[0], payload[1:])
+    return packet_codec.encode_v1_ref(payload[0], payload[1:])
+
+
+%s
+
+def main():
+    parser = argparse.ArgumentParser(description="Encode a binary command frame")
+    parser.add_argument("cmd", nargs="?", help="command name, e.g. PWM_ON")
+    parser.add_argument("args", nargs="*", help="arguments (ints: decimal or 0x..; bytes: text)")
+    parser.add_argument("--v2", action="store_true")
+    parser.add_argument("--seq", type=int, default=0)
+    parser.add_argument("--list", action="store_true", help="list commands and layouts")
+    args = parser.parse_args()
+
+    if args.list or not args.cmd:
+        for name, fields in SCHEMA.items():
+            print("0x%%02X %%-12s %%s" %% (CMD_IDS[name], name, " ".join("%%s:%%s" %% f for f in fields)))
+        return 0
+
+    name = args.cmd.upper()
+    if name not in SCHEMA:
+        print("unknown command %%s" %% args.cmd, file=sys.stderr)
+        return 1
+    values = [v if t == "bytes" else int(v, 0) for (_, t), v in zip(SCHEMA[name], args.args)]
+    if len(values) != len(args.args):
+        print("%%s takes %%d arguments" %% (name, len(SCHEMA[name])), file=sys.stderr)
+        return 1
+    wire = frame(encode(name, *values), args.v2, args.seq)
+    print(" ".join("%%02X" %% b for b in wire))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
+''' % (ids, len(cmds), schema, limits, "\n\n".join(funcs))
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("-i", "--input", default=CMD_LIST_H, help="X-macro command schema")
+    ap.add_argument("--check", action="store_true", help="only verify the outputs are up to date")
+    args = ap.parse_args(argv)
+
+    cmds = read_schema(args.input)
+    if not cmds:
+        sys.exit("no X(...) entries found in %s" % args.input)
+
+    names = [c.id for c in cmds]
+    outputs = {
+        CMD_HASH_H: gen_cmd_hash.render(names, *gen_cmd_hash.build(names)),
+        CMD_TABLE_H: render_table_h(cmds),
+        CMD_ENCODER_PY: render_encoder_py(cmds),
+    }
+
+    stale = []
+    for path, text in outputs.items():
+        try:
+            with open(path, encoding="utf-8", newline="") as f:
+                current = f.read()
+        except OSError:
+            current = None
+        if current == text:
+            continue
+        stale.append(path)
+        if not args.check:
+            with open(path, "w", encoding="utf-8", newline="\n") as f:
+                f.write(text)
+
+    for path in stale:
+        print("%s %s" % ("stale:" if args.check else "wrote:", os.path.relpath(path, REPO)))
+    if not stale:
+        print("%d commands, outputs up to date" % len(cmds))
+    return 1 if (args.check and stale) else 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
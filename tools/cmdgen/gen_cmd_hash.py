@@ -0,0 +1,176 @@
+"""Generate Core/Inc/cmd_hash.h: a minimal perfect hash over the console
+command names listed in Core/Inc/cmd_list.h.
+
+The lookup in cmd.c hashes the typed token once (case folded on the fly),
+picks a slot through a per-bucket displacement and confirms with a single
+case-insensitive compare, so lookup cost does not grow with the table.
+
+Hash (must match cmd_hash_name() in Core/Src/cmd.c):
+    h = seed; for each char c: h = (h ^ upper(c)) * 0x01000193   (32-bit)
+    bucket = h & (BUCKETS - 1)
+    slot   = ((h >> 16) ^ disp[bucket]) & (SLOTS - 1)
+
+Normally run through gen_cmd.py, which regenerates every table derived
+from cmd_list.h; use this script directly for --synthetic benchmarks.
+
+Examples:
+    python tools/cmdgen/gen_cmd_hash.py
+    python tools/cmdgen/gen_cmd_hash.py --synthetic 128 -o /tmp/cmd_hash.h
+"""
+
+import argparse
+import os
+import re
+import sys
+
+REPO = os.path.abspath(os.path.join(os.path.dirname(__file__), "..", ".."))
+CMD_LIST_H = os.path.join(REPO, "Core", "Inc", "cmd_list.h")
+CMD_HASH_H = os.path.join(REPO, "Core", "Inc", "cmd_hash.h")
+
+FNV_PRIME = 0x01000193
+EMPTY = 0xFF
+
+
+def pow2_at_least(n):
+    p = 1
+    while p < n:
+        p <<= 1
+    return p
+
+
+def name_hash(name, seed):
+    h = seed
+    for ch in name.upper().encode("ascii"):
+        h = ((h ^ ch) * FNV_PRIME) & 0xFFFFFFFF
+    return h
+
+
+def read_cmd_list(path):
+    with open(path, encoding="utf-8") as f:
+        text = f.read()
+    text = re.sub(r"/\*.*?\*/|//[^\n]*", "", text, flags=re.S)
+    return re.findall(r"\bX\(\s*(\w+)\s*,", text)
+
+
+def build(names, max_seed=1 << 16):
+    """Return (seed, buckets, slots, disp, table) or raise if none found."""
+    if len(set(n.upper() for n in names)) != len(names):
+        raise ValueError("duplicate command names (case-insensitive)")
+    if len(names) >= EMPTY:
+        raise ValueError("too many commands for 8-bit slot table")
+
+    slots = pow2_at_least(len(names))
+    buckets = pow2_at_least(max(1, len(names) // 2))
+
+    for seed in range(1, max_seed):
+        hashes = [name_hash(n, seed) for n in names]
+        groups = [[] for _ in range(buckets)]
+        for idx, h in enumerate(hashes):
+            groups[h & (buckets - 1)].append(idx)
+
+        table = [EMPTY] * slots
+        disp = [0] * buckets
+        ok = True
+        # Place the largest buckets first while the table is still sparse
+        for b in sorted(range(buckets), key=lambda b: -len(groups[b])):
+            members = groups[b]
+            if not members:
+                continue
+            for d in range(slots):
+                pos = [((hashes[i] >> 16) ^ d) & (slots - 1) for i in members]
+                if len(set(pos)) == len(pos) and all(table[p] == EMPTY for p in pos):
+                    for i, p in zip(members, pos):
+                        table[p] = i
+                    disp[b] = d
+                    break
+            else:
+                ok = False
+                break
+        if ok:
+            return seed, buckets, slots, disp, table
+    raise RuntimeError("no perfect hash found")
+
+
+def c_array(values, per_line=16):
+    lines = []
+    for i in range(0, len(values), per_line):
+        lines.append("    " + ", ".join("0x%02X" % v for v in values[i:i + per_line]) + ",")
+    return "\n".join(lines)
+
+
+def comment_names(names, width=72):
+    """Command names as comment lines, wrapped to width."""
+    lines, cur = [], " *  Commands:"
+    for n in names:
+        if len(cur) + 1 + len(n) > width:
+            lines.append(cur)
+            cur = " *   "
+        cur += " " + n
+    lines.append(cur)
+    return "\n".join(lines)
+
+
+def render(names, seed, buckets, slots, disp, table, synthetic=False):
+    if synthetic:
+        source = "--synthetic %d" % len(names)
+        listing = " *  Commands: %d synthetic, %s..%s" % (len(names), names[0], names[-1])
+    else:
+        source = "cmd_list.h"
+        listing = comment_names(names)
+    return """/*
+ * cmd_hash.h
+ *
+ *  GENERATED by tools/cmdgen/gen_cmd_hash.py from {source} - do not edit.
+ *  Minimal perfect hash for console command lookup (see cmd.c).
+{listing}
+ */
+
+#ifndef INC_CMD_HASH_H_
+#define INC_CMD_HASH_H_
+
+#include <stdint.h>
+
+#define CMD_HASH_COUNT    {count}u
+#define CMD_HASH_SEED     0x{seed:08X}u
+#define CMD_HASH_BUCKETS  {buckets}u
+#define CMD_HASH_SLOTS    {slots}u
+#define CMD_HASH_EMPTY    0x{empty:02X}u
+
+static const uint8_t cmd_hash_disp[CMD_HASH_BUCKETS] = {{
+{disp}
+}};
+
+/* slot -> CMD_ID (CMD_HASH_EMPTY if unused) */
+static const uint8_t cmd_hash_slot[CMD_HASH_SLOTS] = {{
+{table}
+}};
+
+#endif /* INC_CMD_HASH_H_ */
+""".format(source=source, listing=listing, count=len(names), seed=seed, buckets=buckets, slots=slots,
+           empty=EMPTY, disp=c_array(disp), table=c_array(table))
+
+
+def main(argv=None):
+    ap = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    ap.add_argument("-i", "--input", default=CMD_LIST_H, help="X-macro command list")
+    ap.add_argument("-o", "--output", default=CMD_HASH_H, help="generated header")
+    ap.add_argument("--synthetic", type=int, metavar="N",
+                    help="hash N synthetic names CMD_000.. instead of the list (benchmarks)")
+    args = ap.parse_args(argv)
+
+    if args.synthetic:
+        names = ["CMD_%03d" % i for i in range(args.synthetic)]
+    else:
+        names = read_cmd_list(args.input)
+        if not names:
+            sys.exit("no X(...) entries found in %s" % args.input)
+
+    seed, buckets, slots, disp, table = build(names)
+    with open(args.output, "w", encoding="utf-8", newline="\n") as f:
+        f.write(render(names, seed, buckets, slots, disp, table, synthetic=bool(args.synthetic)))
+    print("%s: %d commands, %d slots, %d buckets, seed 0x%08X"
+          % (args.output, len(names), slots, buckets, seed))
+
+
+if __name__ == "__main__":
+    main()
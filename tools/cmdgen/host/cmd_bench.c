@@ -0,0 +1,257 @@
+/*
+ * cmd_bench.c
+ *
+ * Host bench: cycles per binary command from the CMD byte to the handler
+ * arguments, before and after the typed dispatch table.
+ *
+ *   before  the original handle_binary_cmd(): every arg byte is printed with
+ *           sprintf("%d") so the text handler can sscanf() it back
+ *   after   handle_binary_cmd() as in cmd.c: bin_cmd_table length check plus
+ *           the generated decoder from Core/Inc/cmd_table.h
+ *
+ * The HAL calls are left out: both paths end in the same stub action that
+ * only stores the decoded arguments.
+ *
+ *   ./cmd_bench [iterations]
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "cmd.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static inline uint64_t bench_now(void) { return __rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+/* ---------- what cmd.c provides around cmd_table.h ---------- */
+typedef void (*CmdHandler)(int argc, char **argv);
+
+typedef struct
+{
+    const char *cmd_name;
+    CmdHandler handler;
+} CmdEntry;
+
+typedef int (*BinCmdHandler)(const uint8_t *args, uint16_t len);
+
+typedef struct
+{
+    uint8_t arg_len_min;
+    uint8_t arg_len_max;
+    BinCmdHandler handler;
+} BinCmdEntry;
+
+int print(const char *fmt, ...)
+{
+    (void)fmt;
+    return 0;
+}
+
+static int cmd_con_int(const char *s, int32_t lo, int32_t hi, int32_t *out)
+{
+    char *end;
+    long v = strtol(s, &end, 0);
+    if ((end == s) || (*end != '\0') || (v < lo) || (v > hi))
+        return -1;
+    *out = (int32_t)v;
+    return 0;
+}
+
+/* Arg structs, decoders and bin_cmd_table, exactly as cmd.c builds them */
+#include "cmd_table.h"
+
+/* Stub actions: keep the decoded arguments observable, no HAL */
+static volatile uint32_t g_sink;
+
+static int cmd_led_on(void) { g_sink = 1; return 0; }
+static int cmd_led_off(void) { g_sink = 0; return 0; }
+static int cmd_set_led(const CmdArgs_SET_LED *a) { g_sink = a->led_num; return 0; }
+static int cmd_uart_tx(const CmdArgs_UART_TX *a) { g_sink = a->data[0] + a->data_len; return 0; }
+static int cmd_pwm_on(const CmdArgs_PWM_ON *a) { g_sink = a->duty | ((uint32_t)a->freq << 8); return 0; }
+static int cmd_crash(void) { return 0; }
+static int cmd_link_stats(void) { return 0; }
+static int cmd_batch(const CmdArgs_BATCH *a) { g_sink = a->cmds_len; return 0; }
+static int cmd_ring_stats(const CmdArgs_RING_STATS *a) { g_sink = a->reset; return 0; }
+void func_batch(int para_count, char **para) { (void)para_count; (void)para; }
+void func_link_stats(int para_count, char **para) { (void)para_count; (void)para; }
+void func_ring_stats(int para_count, char **para) { (void)para_count; (void)para; }
+void func_invalid(int para_count, char **para) { (void)para_count; (void)para; }
+
+/* ---------- after: cmd.c handle_binary_cmd() ---------- */
+static int bin_cmd_check(const uint8_t *payload, uint16_t length)
+{
+    if (length == 0)
+        return -1;
+
+    uint8_t cmd_id = payload[0];
+    uint16_t arg_len = length - 1;
+
+    if (cmd_id >= INVALID_CMD)
+        return -1;
+
+    const BinCmdEntry *entry = &bin_cmd_table[cmd_id];
+    if (arg_len < entry->arg_len_min || arg_len > entry->arg_len_max)
+        return -2;
+    return 0;
+}
+
+static int typed_dispatch(const uint8_t *payload, uint16_t length)
+{
+    int rc = bin_cmd_check(payload, length);
+    if (rc != 0)
+        return rc;
+
+    return bin_cmd_table[payload[0]].handler(&payload[1], length - 1);
+}
+
+/* ---------- before: the sprintf / sscanf round-trip ---------- */
+static void old_led_on(int para_count, char **para)
+{
+    (void)para;
+    if (para_count != 0)
+        return;
+    g_sink = 1;
+}
+static void old_set_led(int para_count, char **para)
+{
+    if (para_count != 1)
+        return;
+    int led_num;
+    sscanf(para[0], "%d", &led_num);
+    g_sink = (uint32_t)led_num;
+}
+static void old_uart_tx(int para_count, char **para)
+{
+    (void)para_count;
+    g_sink = (uint8_t)para[0][0] + (uint32_t)strlen(para[0]);
+}
+static void old_pwm_on(int para_count, char **para)
+{
+    if (para_count != 2)
+        return;
+    int Duty;
+    int Freq;
+    sscanf(para[0], "%d", &Duty);
+    sscanf(para[1], "%d", &Freq);
+    g_sink = (uint32_t)Duty | ((uint32_t)Freq << 8);
+}
+
+static const CmdHandler old_table[INVALID_CMD] = {
+    [LED_ON] = old_led_on,
+    [SET_LED] = old_set_led,
+    [UART_TX] = old_uart_tx,
+    [PWM_ON] = old_pwm_on,
+};
+
+static void text_roundtrip(uint8_t *payload, uint8_t length)
+{
+    uint8_t cmd_id = payload[0];
+    uint8_t para_count = length - 1;
+
+    if (cmd_id >= INVALID_CMD)
+        return;
+
+    char *argv[5];
+    char temp[5][16];
+
+    if (cmd_id == UART_TX)
+    {
+        argv[0] = (char *)&payload[1];
+        old_table[cmd_id](para_count, argv);
+        return;
+    }
+
+    for (int i = 0; i < para_count; i++)
+    {
+        sprintf(temp[i], "%d", payload[1 + i]);
+        argv[i] = temp[i];
+    }
+
+    old_table[cmd_id](para_count, argv);
+}
+
+/* ---------- bench ---------- */
+typedef struct
+{
+    const char *name;
+    uint8_t before[20];     // payload in the old format
+    uint8_t before_len;
+    uint8_t after[20];      // payload in the cmd_table.h format
+    uint8_t after_len;
+} BenchCmd;
+
+/* Best of five runs, per command */
+static double time_before(const BenchCmd *c, unsigned iters)
+{
+    double best = 1e30;
+    for (int r = 0; r < 5; r++)
+    {
+        uint8_t p[20];
+        memcpy(p, c->before, sizeof(p));
+        uint64_t t0 = bench_now();
+        for (unsigned i = 0; i < iters; i++)
+            text_roundtrip(p, c->before_len);
+        double t = (double)(bench_now() - t0) / iters;
+        if (t < best)
+            best = t;
+    }
+    return best;
+}
+
+static double time_after(const BenchCmd *c, unsigned iters)
+{
+    double best = 1e30;
+    for (int r = 0; r < 5; r++)
+    {
+        /* Reloaded every call, so the decode cannot be hoisted out of the loop */
+        const uint8_t *volatile payload = c->after;
+        uint64_t t0 = bench_now();
+        for (unsigned i = 0; i < iters; i++)
+            typed_dispatch(payload, c->after_len);
+        double t = (double)(bench_now() - t0) / iters;
+        if (t < best)
+            best = t;
+    }
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    unsigned iters = (argc > 1) ? (unsigned)strtoul(argv[1], NULL, 0) : 1000000u;
+    if (iters == 0)
+        iters = 1;
+
+    /* UART_TX: the old path passed the bytes through as a C string */
+    static const BenchCmd cmds[] = {
+        {"LED_ON", {LED_ON}, 1, {LED_ON}, 1},
+        {"SET_LED 1", {SET_LED, 1}, 2, {SET_LED, 1}, 2},
+        {"PWM_ON 50 200", {PWM_ON, 50, 200}, 3, {PWM_ON, 50, 200, 0}, 4},
+        {"UART_TX 16 B", {UART_TX, 'h', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd', ' ',
+                '1', '2', '3', '4', 0}, 17,
+                {UART_TX, 'h', 'e', 'l', 'l', 'o', ' ', 'w', 'o', 'r', 'l', 'd', ' ',
+                '1', '2', '3', '4'}, 17},
+    };
+
+    printf("%u iterations, best of 5, %s per command\n\n", iters, BENCH_UNIT);
+    printf("%-15s %14s %12s\n", "command", "sprintf/sscanf", "typed");
+    for (size_t i = 0; i < sizeof(cmds) / sizeof(cmds[0]); i++)
+    {
+        double b = time_before(&cmds[i], iters);
+        double a = time_after(&cmds[i], iters);
+        printf("%-15s %14.1f %12.1f\n", cmds[i].name, b, a);
+    }
+    return 0;
+}
@@ -0,0 +1,115 @@
+/*
+ * lookup_bench.c
+ *
+ * Host bench: console command lookup cost against table size, perfect hash
+ * (cmd_lookup() in cmd.c, tables from gen_cmd_hash.py --synthetic) vs the
+ * original toupper + strcmp linear search. Queries are random table names
+ * in random letter case plus ~10% unknown tokens; both lookups must agree.
+ *
+ *   ./lookup_bench [rounds]
+ */
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "lookup_bench.h"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#define BENCH_UNIT "cycles"
+static inline uint64_t bench_now(void) { return __rdtsc(); }
+#else
+#define BENCH_UNIT "ns"
+static inline uint64_t bench_now(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000u + (uint64_t)ts.tv_nsec;
+}
+#endif
+
+#define QUERIES 1024
+
+typedef struct
+{
+    char tok[16];
+    int expect;
+} Query;
+
+static Query g_queries[QUERIES];
+
+static void make_queries(const LookupImpl *impl)
+{
+    static const char *const unknown[] = {"CMD_999", "LED_ONN", "cmd_", "PWM", "CMD_00X"};
+    for (int i = 0; i < QUERIES; i++)
+    {
+        Query *q = &g_queries[i];
+        if (rand() % 10 == 0)
+        {
+            snprintf(q->tok, sizeof(q->tok), "%s", unknown[rand() % 5]);
+            q->expect = -1;
+            continue;
+        }
+        q->expect = rand() % impl->count;
+        snprintf(q->tok, sizeof(q->tok), "%s", impl->name(q->expect));
+        for (char *s = q->tok; *s; s++)
+        {
+            if ((*s >= 'A') && (*s <= 'Z') && (rand() & 1))
+                *s = (char)(*s + ('a' - 'A'));
+        }
+    }
+}
+
+/* Best of five passes over all queries; each token is copied into the
+ * command buffer first, as process_cmd() works on cmd_buff */
+static double run(const LookupImpl *impl, int linear, int rounds, int *mismatch)
+{
+    double best = 1e30;
+    char buf[16];
+
+    for (int r = 0; r < 5; r++)
+    {
+        uint64_t t0 = bench_now();
+        for (int k = 0; k < rounds; k++)
+        {
+            for (int i = 0; i < QUERIES; i++)
+            {
+                memcpy(buf, g_queries[i].tok, sizeof(buf));
+                int id = linear ? impl->linear(buf) : impl->hash(buf);
+                *mismatch += (id != g_queries[i].expect);
+            }
+        }
+        double t = (double)(bench_now() - t0) / ((double)rounds * QUERIES);
+        if (t < best)
+            best = t;
+    }
+    return best;
+}
+
+int main(int argc, char **argv)
+{
+    const LookupImpl *impls[] = {&lookup_impl_8, &lookup_impl_32, &lookup_impl_128, &lookup_impl_200};
+    int rounds = (argc > 1) ? atoi(argv[1]) : 200;
+    int fail = 0;
+
+    if (rounds <= 0)
+        rounds = 1;
+    srand(1);
+
+    printf("%d x %d queries, best of 5, %s per lookup\n\n", rounds, QUERIES, BENCH_UNIT);
+    printf("%8s %14s %16s\n", "commands", "perfect hash", "toupper+strcmp");
+    for (size_t i = 0; i < sizeof(impls) / sizeof(impls[0]); i++)
+    {
+        const LookupImpl *impl = impls[i];
+        int mismatch = 0;
+        impl->init();
+        make_queries(impl);
+        double h = run(impl, 0, rounds, &mismatch);
+        double l = run(impl, 1, rounds, &mismatch);
+        printf("%8d %14.1f %16.1f%s\n", impl->count, h, l, mismatch ? "  FAIL" : "");
+        fail |= (mismatch != 0);
+    }
+    return fail;
+}
@@ -0,0 +1,26 @@
+/*
+ * lookup_bench.h
+ *
+ * Console lookup variants for one synthetic table size (lookup_impl.c).
+ */
+
+#ifndef LOOKUP_BENCH_H_
+#define LOOKUP_BENCH_H_
+
+#include <stdint.h>
+
+typedef struct
+{
+    int count;
+    void (*init)(void);
+    const char *(*name)(int id);
+    int (*hash)(const char *name);      // cmd_lookup(), -1 if unknown
+    int (*linear)(char *token);         // toupper + strcmp, token upper-cased in place
+} LookupImpl;
+
+extern const LookupImpl lookup_impl_8;
+extern const LookupImpl lookup_impl_32;
+extern const LookupImpl lookup_impl_128;
+extern const LookupImpl lookup_impl_200;
+
+#endif /* LOOKUP_BENCH_H_ */
@@ -0,0 +1,91 @@
+/*
+ * lookup_impl.c
+ *
+ * One console lookup table for lookup_bench.c, compiled once per table
+ * size with -DLOOKUP_N=<n> and -include cmd_hash_<n>.h (generated with
+ * gen_cmd_hash.py --synthetic <n>). Names are CMD_000..CMD_<n-1>.
+ *
+ *   hash    cmd_lookup() from cmd.c: one case-folding FNV-1a pass, one slot,
+ *           one confirming compare
+ *   linear  the original process_cmd() search: toupper() the token in place,
+ *           then strcmp() against every table entry
+ */
+#include <ctype.h>
+#include <stdio.h>
+#include <string.h>
+
+#include "lookup_bench.h"
+
+#define LOOKUP_CAT_(a, b) a##b
+#define LOOKUP_CAT(a, b) LOOKUP_CAT_(a, b)
+#define LOOKUP_IMPL LOOKUP_CAT(lookup_impl_, LOOKUP_N)
+
+_Static_assert(CMD_HASH_COUNT == LOOKUP_N, "cmd_hash_<n>.h does not match LOOKUP_N");
+
+static char g_names[LOOKUP_N][8];
+
+static void lookup_init(void)
+{
+    for (int i = 0; i < LOOKUP_N; i++)
+        snprintf(g_names[i], sizeof(g_names[i]), "CMD_%03d", i);
+}
+
+static const char *lookup_name(int id)
+{
+    return g_names[id];
+}
+
+/* ---------- cmd.c ---------- */
+static inline char cmd_upper(char c)
+{
+    return (c >= 'a' && c <= 'z') ? (char)(c - ('a' - 'A')) : c;
+}
+
+static uint32_t cmd_hash_name(const char *s)
+{
+    uint32_t h = CMD_HASH_SEED;
+    while (*s)
+    {
+        h = (h ^ (uint8_t)cmd_upper(*s++)) * 0x01000193u;
+    }
+    return h;
+}
+
+static int lookup_hash(const char *name)
+{
+    uint32_t h = cmd_hash_name(name);
+    uint8_t d = cmd_hash_disp[h & (CMD_HASH_BUCKETS - 1u)];
+    uint8_t id = cmd_hash_slot[((h >> 16) ^ d) & (CMD_HASH_SLOTS - 1u)];
+    if (id == CMD_HASH_EMPTY)
+        return -1;
+
+    const char *ref = g_names[id];
+    while (*name && cmd_upper(*name) == *ref)
+    {
+        name++;
+        ref++;
+    }
+    return (*name == '\0' && *ref == '\0') ? id : -1;
+}
+
+/* ---------- original process_cmd() ---------- */
+static int lookup_linear(char *token)
+{
+    for (char *s = token; *s; s++)
+        *s = (char)toupper((unsigned char)*s);
+
+    for (int i = 0; i < LOOKUP_N; i++)
+    {
+        if (strcmp(token, g_names[i]) == 0)
+            return i;
+    }
+    return -1;
+}
+
+const LookupImpl LOOKUP_IMPL = {
+    .count = LOOKUP_N,
+    .init = lookup_init,
+    .name = lookup_name,
+    .hash = lookup_hash,
+    .linear = lookup_linear,
+};
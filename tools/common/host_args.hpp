@@ -0,0 +1,85 @@
+/*
+ * host_args.hpp
+ *
+ * "--name value" command line options for the host benches, stress tests
+ * and harnesses under tools/. Each program lists only its own options:
+ *
+ *     Options o;
+ *     host_args::parse(argc, argv, {
+ *         host_args::opt("--mb", o.mb, 1),       // 0 is raised to 1
+ *         host_args::opt("--seed", o.seed),
+ *     });
+ *
+ * Integers take decimal or 0x hex, bools any integer (!= 0), doubles and
+ * strings as given. An unknown option exits with status 2.
+ */
+
+#ifndef HOST_ARGS_HPP_
+#define HOST_ARGS_HPP_
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <string>
+#include <type_traits>
+
+namespace host_args
+{
+
+struct Opt
+{
+    const char *name;
+    std::function<void(const char *)> set;
+};
+
+/* Bind --name to dst; numbers below lo are raised to lo */
+template <typename T>
+Opt opt(const char *name, T &dst, T lo = std::numeric_limits<T>::lowest())
+{
+    return {name, [&dst, lo](const char *v) {
+        if constexpr (std::is_same_v<T, std::string>)
+            dst = v;
+        else if constexpr (std::is_same_v<T, bool>)
+            dst = std::strtoull(v, nullptr, 0) != 0;
+        else if constexpr (std::is_floating_point_v<T>)
+            dst = std::max(static_cast<T>(std::strtod(v, nullptr)), lo);
+        else if constexpr (std::is_signed_v<T>)
+            dst = std::max(static_cast<T>(std::strtoll(v, nullptr, 0)), lo);
+        else
+            dst = std::max(static_cast<T>(std::strtoull(v, nullptr, 0)), lo);
+    }};
+}
+
+/* Same, for a bound given as a literal of another integer type */
+template <typename T, typename L, typename = std::enable_if_t<!std::is_same_v<T, L>>>
+Opt opt(const char *name, T &dst, L lo)
+{
+    return opt(name, dst, static_cast<T>(lo));
+}
+
+inline void parse(int argc, char **argv, std::initializer_list<Opt> opts)
+{
+    for (int i = 1; i + 1 < argc; i += 2)
+    {
+        const Opt *match = nullptr;
+        for (const Opt &o : opts)
+        {
+            if (std::strcmp(argv[i], o.name) == 0)
+                match = &o;
+        }
+        if (match == nullptr)
+        {
+            std::fprintf(stderr, "unknown option %s\n", argv[i]);
+            std::exit(2);
+        }
+        match->set(argv[i + 1]);
+    }
+}
+
+} // namespace host_args
+
+#endif /* HOST_ARGS_HPP_ */
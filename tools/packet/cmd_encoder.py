@@ -0,0 +1,187 @@
+"""Binary command encoders for the UART1/UART3 packet links.
+
+GENERATED by tools/cmdgen/gen_cmd.py from Core/Inc/cmd_list.h - do not edit.
+Layouts match the firmware decoders in Core/Inc/cmd_table.h.
+
+Payload = CMD byte + little-endian args; frame() wraps it in a v1 / v2
+packet (packet_codec.py reference encoders).
+
+Examples:
+    python tools/packet/cmd_encoder.py PWM_ON 50 1000
+    python tools/packet/cmd_encoder.py --v2 --seq 3 UART_TX hello
+    python tools/packet/cmd_encoder.py --list
+
+    import cmd_encoder as ce
+    ser.write(ce.frame(ce.pwm_on(50, 1000)))
+"""
+
+import argparse
+import struct
+import sys
+
+CMD_IDS = {
+    "LED_ON": 0x00,
+    "LED_OFF": 0x01,
+    "SET_LED": 0x02,
+    "UART_TX": 0x03,
+    "PWM_ON": 0x04,
+    "CRASH": 0x05,
+    "LINK_STATS": 0x06,
+    "BATCH": 0x07,
+    "RING_STATS": 0x08,
+}
+INVALID_CMD = 0x09
+
+# CMD -> [(arg, type)], wire order
+SCHEMA = {
+    "LED_ON": [],
+    "LED_OFF": [],
+    "SET_LED": [("led_num", "u8")],
+    "UART_TX": [("data", "bytes")],
+    "PWM_ON": [("duty", "u8"), ("freq", "u16")],
+    "CRASH": [],
+    "LINK_STATS": [],
+    "BATCH": [("cmds", "bytes")],
+    "RING_STATS": [("reset", "u8")],
+}
+
+# CMD -> (arg_len_min, arg_len_max), as bin_cmd_table
+ARG_LIMITS = {
+    "LED_ON": (0, 0),
+    "LED_OFF": (0, 0),
+    "SET_LED": (1, 1),
+    "UART_TX": (1, 255),
+    "PWM_ON": (3, 3),
+    "CRASH": (0, 0),
+    "LINK_STATS": (0, 0),
+    "BATCH": (1, 255),
+    "RING_STATS": (1, 1),
+}
+
+_CODES = {"u8": "B", "i8": "b", "u16": "H", "i16": "h", "u32": "I", "i32": "i"}
+
+
+def encode(name, *values):
+    """CMD + args payload for command name."""
+    args = SCHEMA[name]
+    if len(values) != len(args):
+        raise TypeError("%s takes %d arguments" % (name, len(args)))
+    out = bytearray([CMD_IDS[name]])
+    for (arg, type_), value in zip(args, values):
+        if type_ == "bytes":
+            out += value.encode() if isinstance(value, str) else bytes(value)
+        else:
+            try:
+                out += struct.pack("<" + _CODES[type_], value)
+            except struct.error as exc:
+                raise ValueError("%s: %s out of range for %s" % (name, arg, type_)) from exc
+    lo, hi = ARG_LIMITS[name]
+    if not lo <= len(out) - 1 <= hi:
+        raise ValueError("%s: %d arg bytes, expected %d..%d" % (name, len(out) - 1, lo, hi))
+    return bytes(out)
+
+
+def decode(payload):
+    """(name, {arg: value}) of a payload, as the firmware decodes it."""
+    names = {v: k for k, v in CMD_IDS.items()}
+    name = names.get(payload[0])
+    if name is None:
+        raise ValueError("unknown CMD 0x%02X" % payload[0])
+    lo, hi = ARG_LIMITS[name]
+    if not lo <= len(payload) - 1 <= hi:
+        raise ValueError("%s: bad arg length %d" % (name, len(payload) - 1))
+    values = {}
+    off = 1
+    for arg, type_ in SCHEMA[name]:
+        if type_ == "bytes":
+            values[arg] = bytes(payload[off:])
+            break
+        fmt = struct.Struct("<" + _CODES[type_])
+        values[arg] = fmt.unpack_from(payload, off)[0]
+        off += fmt.size
+    return name, values
+
+
+def frame(payload, v2=False, seq=0):
+    """v1 (default) or v2 packet around a payload."""
+    import packet_codec
+
+    if v2:
+        return packet_codec.encode_v2_ref(seq, payload[0], payload[1:])
+    return packet_codec.encode_v1_ref(payload[0], payload[1:])
+
+
+def led_on():
+    """LED_ON payload: CMD 0x00."""
+    return encode("LED_ON")
+
+
+def led_off():
+    """LED_OFF payload: CMD 0x01."""
+    return encode("LED_OFF")
+
+
+def set_led(led_num):
+    """SET_LED payload: CMD 0x02, u8 led_num."""
+    return encode("SET_LED", led_num)
+
+
+def uart_tx(data):
+    """UART_TX payload: CMD 0x03, bytes data."""
+    return encode("UART_TX", data)
+
+
+def pwm_on(duty, freq):
+    """PWM_ON payload: CMD 0x04, u8 duty, u16 freq."""
+    return encode("PWM_ON", duty, freq)
+
+
+def crash():
+    """CRASH payload: CMD 0x05."""
+    return encode("CRASH")
+
+
+def link_stats():
+    """LINK_STATS payload: CMD 0x06."""
+    return encode("LINK_STATS")
+
+
+def batch(cmds):
+    """BATCH payload: CMD 0x07, bytes cmds."""
+    return encode("BATCH", cmds)
+
+
+def ring_stats(reset):
+    """RING_STATS payload: CMD 0x08, u8 reset."""
+    return encode("RING_STATS", reset)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Encode a binary command frame")
+    parser.add_argument("cmd", nargs="?", help="command name, e.g. PWM_ON")
+    parser.add_argument("args", nargs="*", help="arguments (ints: decimal or 0x..; bytes: text)")
+    parser.add_argument("--v2", action="store_true")
+    parser.add_argument("--seq", type=int, default=0)
+    parser.add_argument("--list", action="store_true", help="list commands and layouts")
+    args = parser.parse_args()
+
+    if args.list or not args.cmd:
+        for name, fields in SCHEMA.items():
+            print("0x%02X %-12s %s" % (CMD_IDS[name], name, " ".join("%s:%s" % f for f in fields)))
+        return 0
+
+    name = args.cmd.upper()
+    if name not in SCHEMA:
+        print("unknown command %s" % args.cmd, file=sys.stderr)
+        return 1
+    values = [v if t == "bytes" else int(v, 0) for (_, t), v in zip(SCHEMA[name], args.args)]
+    if len(values) != len(args.args):
+        print("%s takes %d arguments" % (name, len(SCHEMA[name])), file=sys.stderr)
+        return 1
+    wire = frame(encode(name, *values), args.v2, args.seq)
+    print(" ".join("%02X" % b for b in wire))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,126 @@
+"""COBS (Consistent Overhead Byte Stuffing) for the UART1/UART3 packet links.
+
+Host-side counterpart of Core/Src/cobs.c and the COBS framing mode in
+Core/Inc/packet.h: a whole v1/v2 packet is COBS encoded and terminated by a
+0x00 delimiter.
+
+Examples:
+    python tools/packet/cobs.py encode "AA 03 01 10 20 DE"
+    python tools/packet/cobs.py decode "07 AA 03 01 10 20 DE 00"
+"""
+
+import argparse
+import sys
+
+DELIMITER = 0x00
+
+
+def max_encoded_len(n):
+    """Worst-case encoded size of n bytes (without delimiter)."""
+    return n + n // 254 + 1
+
+
+def encode(data):
+    """COBS encode bytes; the result contains no 0x00 and no delimiter."""
+    out = bytearray([0])
+    code_idx = 0
+    code = 1
+
+    for b in data:
+        if b == 0:
+            out[code_idx] = code
+            code_idx = len(out)
+            out.append(0)
+            code = 1
+            continue
+
+        out.append(b)
+        code += 1
+        if code == 0xFF:
+            out[code_idx] = code
+            code_idx = len(out)
+            out.append(0)
+            code = 1
+
+    out[code_idx] = code
+    return bytes(out)
+
+
+def decode(data):
+    """Decode one COBS frame (delimiter excluded). Raises ValueError."""
+    out = bytearray()
+    i = 0
+    n = len(data)
+
+    while i < n:
+        code = data[i]
+        i += 1
+        if code == 0:
+            raise ValueError("zero byte inside COBS frame")
+
+        run = code - 1
+        if run > n - i:
+            raise ValueError("COBS block runs past end of frame")
+
+        out += data[i:i + run]
+        i += run
+        if code != 0xFF and i < n:
+            out.append(0)
+
+    return bytes(out)
+
+
+def frame(packet):
+    """Encode a packet for the wire, delimiter included."""
+    return encode(packet) + bytes([DELIMITER])
+
+
+class FrameSplitter:
+    """Incremental splitter for a COBS byte stream (e.g. serial reads)."""
+
+    def __init__(self):
+        self._pending = bytearray()
+
+    def feed(self, data):
+        """Yield decoded frames completed by data; bad frames are skipped."""
+        self._pending += data
+        while True:
+            pos = self._pending.find(DELIMITER)
+            if pos < 0:
+                return
+            chunk = bytes(self._pending[:pos])
+            del self._pending[:pos + 1]
+            if not chunk:
+                continue
+            try:
+                yield decode(chunk)
+            except ValueError:
+                continue
+
+
+def _parse_hex(text):
+    return bytes(int(tok, 16) for tok in text.replace(",", " ").split())
+
+
+def _fmt_hex(data):
+    return " ".join(f"{b:02X}" for b in data)
+
+
+def main():
+    parser = argparse.ArgumentParser(description="COBS encode/decode helper")
+    parser.add_argument("op", choices=["encode", "decode"])
+    parser.add_argument("hex", help='bytes as hex, e.g. "AA 03 01 10 20 DE"')
+    args = parser.parse_args()
+
+    data = _parse_hex(args.hex)
+    if args.op == "encode":
+        print(_fmt_hex(frame(data)))
+        return 0
+
+    for decoded in FrameSplitter().feed(data if data.endswith(b"\x00") else data + b"\x00"):
+        print(_fmt_hex(decoded))
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,200 @@
+/*
+ * batch_bench.cpp
+ *
+ * Host throughput bench: the same command stream (LED_ON / SET_LED /
+ * PWM_ON, as in UART_TEST_CMD_STICKY) sent as one frame per command or as
+ * BATCH frames of N sub-commands (packet_batch_append / packet_batch_run).
+ *
+ * Each frame goes through the firmware PacketParser, is copied once into a
+ * message slot (the dispatcher message buffer) and dispatched: a length
+ * check against the command limits, then the handler. A BATCH frame is one
+ * dispatcher wakeup for all of its sub-commands.
+ *
+ *   ./batch_bench [--cmds N] [--chunk BYTES]
+ */
+#include "packet_host.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#include "host_args.hpp"
+
+namespace
+{
+
+/* Dispatcher payload limit (cmd_dispatch.h default) */
+constexpr uint16_t kDispatchMax = 128;
+
+struct Options
+{
+    uint64_t cmds = 2000000;
+    size_t chunk = 64;      // bytes per feed (DMA IDLE burst)
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--cmds", o.cmds),
+        host_args::opt("--chunk", o.chunk, 1),
+    });
+    return o;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+struct Cmd
+{
+    uint8_t id;
+    std::vector<uint8_t> args;
+};
+
+/* Command mix, cycled */
+const Cmd kMix[] = {
+    {LED_ON, {}},
+    {SET_LED, {1}},
+    {PWM_ON, {50, 0xE8, 0x03}},
+};
+
+/* Arg length limits of the commands above (bin_cmd_table) */
+int arg_limit(uint8_t id, uint16_t *min, uint16_t *max)
+{
+    switch (id)
+    {
+    case LED_ON: *min = 0; *max = 0; return 0;
+    case SET_LED: *min = 1; *max = 1; return 0;
+    case PWM_ON: *min = 3; *max = 3; return 0;
+    default: return -1;
+    }
+}
+
+struct Sink
+{
+    uint64_t executed = 0;
+    uint64_t rejected = 0;
+    uint64_t wakeups = 0;
+    uint32_t state = 0;
+};
+
+int check_cmd(void *ctx, const uint8_t *cmd, uint16_t len)
+{
+    (void)ctx;
+    uint16_t min, max;
+    if (arg_limit(cmd[0], &min, &max) != 0)
+        return -1;
+    return (len - 1U < min || len - 1U > max) ? -2 : 0;
+}
+
+int exec_cmd(void *ctx, const uint8_t *cmd, uint16_t len)
+{
+    Sink *s = static_cast<Sink *>(ctx);
+    uint32_t v = cmd[0];
+    for (uint16_t i = 1; i < len; i++)
+        v = v * 31U + cmd[i];
+    s->state ^= v;
+    s->executed++;
+    return 0;
+}
+
+/* Dispatcher side of one message (handle_binary_cmd / cmd_batch) */
+void dispatch(Sink *s, const uint8_t *msg, uint16_t len)
+{
+    s->wakeups++;
+    if (msg[0] == BATCH)
+    {
+        if (packet_batch_run(&msg[1], len - 1U, check_cmd, exec_cmd, s, nullptr) != 0)
+            s->rejected++;
+        return;
+    }
+    if (check_cmd(s, msg, len) != 0)
+    {
+        s->rejected++;
+        return;
+    }
+    exec_cmd(s, msg, len);
+}
+
+std::vector<uint8_t> build_stream(uint64_t cmds, unsigned batch)
+{
+    std::vector<uint8_t> stream;
+    uint8_t buf[kDispatchMax];
+    uint64_t i = 0;
+
+    while (i < cmds)
+    {
+        if (batch <= 1)
+        {
+            const Cmd &c = kMix[i++ % 3];
+            std::vector<uint8_t> f = pkt::encode_v1(c.id, c.args.data(), c.args.size());
+            stream.insert(stream.end(), f.begin(), f.end());
+            continue;
+        }
+
+        uint16_t n = 0;
+        for (unsigned k = 0; k < batch && i < cmds; k++, i++)
+        {
+            const Cmd &c = kMix[i % 3];
+            n = packet_batch_append(buf, sizeof(buf) - 1U, n, c.id, c.args.data(),
+                    static_cast<uint8_t>(c.args.size()));
+            if (n == 0)
+            {
+                std::fprintf(stderr, "batch of %u does not fit in %u bytes\n", batch, kDispatchMax);
+                std::exit(2);
+            }
+        }
+        std::vector<uint8_t> f = pkt::encode_v1(BATCH, buf, n);
+        stream.insert(stream.end(), f.begin(), f.end());
+    }
+    return stream;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const Options opt = parse_args(argc, argv);
+    const unsigned sizes[] = {1, 8, 32};
+    int rc = 0;
+
+    std::printf("cmds=%llu chunk=%zu, wire rate at 8N1\n", (unsigned long long)opt.cmds, opt.chunk);
+    std::printf("%-6s %8s %9s %12s %12s %14s\n",
+            "batch", "B/cmd", "wakeups", "115200 cmd/s", "1M cmd/s", "host Mcmd/s");
+
+    for (unsigned size : sizes)
+    {
+        std::vector<uint8_t> stream = build_stream(opt.cmds, size);
+        pkt::Decoder dec(PKT_V2_FRAME_SIZE(kDispatchMax), true);
+        Sink sink;
+        uint8_t slot[kDispatchMax];
+
+        dec.on_frame([&](const PacketFrame &f) {
+            // Copy into the message slot, as xMessageBufferSend/Receive do
+            std::memcpy(slot, f.payload, f.len);
+            dispatch(&sink, slot, f.len);
+        });
+
+        auto t0 = std::chrono::steady_clock::now();
+        for (size_t pos = 0; pos < stream.size(); pos += opt.chunk)
+            dec.feed(&stream[pos], std::min(opt.chunk, stream.size() - pos));
+        double t = seconds_since(t0);
+
+        double bpc = static_cast<double>(stream.size()) / opt.cmds;
+        std::printf("%-6u %8.2f %9llu %12.0f %12.0f %14.2f\n", size, bpc,
+                (unsigned long long)sink.wakeups, 11520.0 / bpc, 100000.0 / bpc,
+                opt.cmds / t / 1e6);
+
+        if ((sink.executed != opt.cmds) || (sink.rejected != 0))
+        {
+            std::printf("  FAIL: executed=%llu rejected=%llu\n",
+                    (unsigned long long)sink.executed, (unsigned long long)sink.rejected);
+            rc = 1;
+        }
+    }
+    return rc;
+}
@@ -0,0 +1,286 @@
+/*
+ * bip_bench.cpp
+ *
+ * Host bench: bytes copied per frame on the UART RX path, before and
+ * after the bip-buffer (Core/Inc/bipbuf.h) and in-place dispatch
+ * (packet_parser_set_inplace()), at several frame-size distributions.
+ *
+ * The same v2 frame stream, cut into DMA IDLE chunks (bursts of whole
+ * frames up to the DMA buffer size, some cut mid-frame), goes through:
+ *
+ *   ring, copy    RingBuffer + 16-byte rb_read() drain + parser copy
+ *                 (uart_rx.c copy path before the bip-buffer)
+ *   bip, inplace  BipBuf, peeked regions fed as they are (copy path now)
+ *   dma, copy     packet_parser_feed_dma(), in-place off
+ *   dma, inplace  packet_parser_feed_dma(), in-place on (zero-copy path now)
+ *
+ * "copied" is what the task side copies: the ring drain into its local
+ * chunk, plus every frame delivered from the parser buffer (its bytes
+ * were copied there). The ISR copy DMA -> ring / bip is the same for both
+ * copy paths and shown apart. Frames are checked by SEQ and length.
+ *
+ *   ./bip_bench [--frames N] [--seed S]
+ */
+#include "packet_host.hpp"
+#include "bipbuf.h"
+#include "uart_rb.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+#include <vector>
+
+#include "host_args.hpp"
+
+namespace
+{
+
+constexpr uint16_t kDmaSize = 64;       // UART_RX_DMA_SIZE
+constexpr uint16_t kRingSize = 128;     // RB_SIZE, UART_RX_BIP_SIZE
+constexpr uint16_t kDrainChunk = 16;    // old uart_rx_drain() local chunk
+
+struct Options
+{
+    uint32_t frames = 200000;
+    uint32_t seed = 1;
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--frames", o.frames, 1),
+        host_args::opt("--seed", o.seed),
+    });
+    return o;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+/* CMD + PAYLOAD length ranges; the largest frame fills the parser (64 B) */
+struct Dist
+{
+    const char *name;
+    uint16_t min, max;      // CMD + PAYLOAD bytes
+    uint8_t mixed;          // 60 % small, 30 % medium, 10 % large
+};
+
+const Dist kDists[] = {
+    {"small  7-10 B", 1, 4, 0},
+    {"medium 16-48 B", 10, 42, 0},
+    {"large  49-64 B", 43, PKT_V2_MAX_PAYLOAD_LEN, 0},
+    {"mixed", 0, 0, 1},
+};
+
+struct Stream
+{
+    std::vector<uint8_t> bytes;
+    std::vector<uint16_t> chunks;   // IDLE event sizes, each <= kDmaSize
+    std::vector<uint16_t> lens;     // CMD + PAYLOAD length per frame
+    uint64_t frame_bytes = 0;
+};
+
+Stream make_stream(const Dist &d, uint32_t frames, uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    Stream s;
+    uint8_t frame[PKT_PARSER_BUF_SIZE];
+    uint8_t args[PKT_PARSER_BUF_SIZE] = {0};
+    uint16_t pending = 0;   // bytes of the current chunk
+    uint32_t burst = 0;
+
+    for (uint32_t i = 0; i < frames; i++)
+    {
+        uint16_t lo = d.min, hi = d.max;
+        if (d.mixed)
+        {
+            unsigned r = rng() % 10;
+            const Dist &pick = (r < 6) ? kDists[0] : (r < 9) ? kDists[1] : kDists[2];
+            lo = pick.min;
+            hi = pick.max;
+        }
+        uint16_t len = static_cast<uint16_t>(lo + rng() % (hi - lo + 1));
+        for (uint16_t k = 1; k < len; k++)
+            args[k - 1] = static_cast<uint8_t>(rng());
+        uint16_t n = build_packet_v2(frame, static_cast<uint8_t>(i), LED_ON, args,
+                static_cast<uint16_t>(len - 1));
+
+        // IDLE after 1..4 frames, or when the DMA buffer would overflow
+        if ((pending + n > kDmaSize) || (burst == 0))
+        {
+            if (pending != 0)
+                s.chunks.push_back(pending);
+            pending = 0;
+            burst = 1 + rng() % 4;
+        }
+        s.bytes.insert(s.bytes.end(), frame, frame + n);
+        s.lens.push_back(len);
+        s.frame_bytes += n;
+        pending += n;
+        burst--;
+
+        // 1 in 8 chunks is cut mid-frame (half-transfer event, line noise)
+        if ((rng() % 8 == 0) && (pending > 1))
+        {
+            uint16_t cut = static_cast<uint16_t>(1 + rng() % (pending - 1));
+            s.chunks.push_back(cut);
+            pending = static_cast<uint16_t>(pending - cut);
+        }
+    }
+    if (pending != 0)
+        s.chunks.push_back(pending);
+    return s;
+}
+
+struct Sink
+{
+    const PacketParser *p = nullptr;
+    const std::vector<uint16_t> *lens = nullptr;
+    uint32_t next = 0;
+    uint32_t bad = 0;
+    uint64_t copied = 0;    // bytes of frames delivered from the parser buffer
+};
+
+void on_frame(void *ctx, const PacketFrame *f)
+{
+    Sink *s = static_cast<Sink *>(ctx);
+    if ((s->next >= s->lens->size()) || (f->seq != static_cast<uint8_t>(s->next))
+            || (f->len != (*s->lens)[s->next]))
+        s->bad++;
+    s->next++;
+    if ((f->payload >= s->p->buf) && (f->payload < s->p->buf + s->p->cap))
+        s->copied += f->len + PKT_V2_OVERHEAD;
+}
+
+enum Path { RING_COPY, BIP_INPLACE, DMA_COPY, DMA_INPLACE };
+
+const char *const kPathName[] = {"ring, copy", "bip, inplace", "dma, copy", "dma, inplace"};
+
+struct Result
+{
+    double ns_frame;
+    double copied_frame;    // task side copies, bytes per frame
+    double isr_frame;       // ISR copy DMA -> ring / bip, bytes per frame
+    uint32_t inplace;
+    uint32_t bad;
+};
+
+Result run(Path path, const Stream &s)
+{
+    PacketParser p;
+    packet_parser_init(&p);
+    packet_parser_set_inplace(&p, (path == BIP_INPLACE) || (path == DMA_INPLACE));
+
+    Sink sink;
+    sink.p = &p;
+    sink.lens = &s.lens;
+    packet_parser_set_handler(&p, on_frame, &sink);
+
+    RingBuffer rb;
+    BipBuf bip;
+    uint8_t storage[kRingSize];
+    uint8_t dma[kDmaSize];
+    uint8_t chunk[kDrainChunk];
+    rb_init(&rb, storage, kRingSize, SPSC_RING_REJECT_NEWEST);
+    bipbuf_init(&bip, storage, kRingSize);
+
+    uint64_t drained = 0, isr = 0, off = 0;
+    uint16_t pos = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint16_t n : s.chunks)
+    {
+        const uint8_t *src = &s.bytes[off];
+        off += n;
+        switch (path)
+        {
+        case RING_COPY:
+            isr += rb_write(&rb, src, n);
+            for (uint16_t r; (r = rb_read(&rb, chunk, kDrainChunk)) != 0;)
+            {
+                drained += r;
+                packet_parser_feed_buf(&p, chunk, r);
+            }
+            break;
+        case BIP_INPLACE:
+            isr += bipbuf_write(&bip, src, n);
+            for (;;)
+            {
+                uint16_t len;
+                const uint8_t *d = bipbuf_peek(&bip, &len);
+                if (d == nullptr)
+                    break;
+                packet_parser_feed_buf(&p, d, len);
+                bipbuf_release(&bip, len);
+            }
+            break;
+        case DMA_COPY:
+        case DMA_INPLACE:
+        {
+            // The DMA controller's writes, not a CPU copy of the firmware.
+            // One feed per IDLE event; a chunk of the full DMA size would
+            // look like no data (cur == last), it is fed in two halves.
+            uint16_t last = pos;
+            for (uint16_t k = 0; k < n; k++)
+            {
+                dma[pos] = src[k];
+                pos = static_cast<uint16_t>((pos + 1U) % kDmaSize);
+                if ((n == kDmaSize) && (k + 1U == kDmaSize / 2U))
+                {
+                    packet_parser_feed_dma(&p, dma, kDmaSize, last, pos);
+                    last = pos;
+                }
+            }
+            packet_parser_feed_dma(&p, dma, kDmaSize, last, pos);
+            break;
+        }
+        }
+    }
+    double t = seconds_since(t0);
+
+    uint32_t frames = static_cast<uint32_t>(s.lens.size());
+    Result r;
+    r.ns_frame = t * 1e9 / frames;
+    r.copied_frame = static_cast<double>(drained + sink.copied) / frames;
+    r.isr_frame = static_cast<double>(isr) / frames;
+    r.inplace = p.inplace_frames;
+    r.bad = sink.bad + (sink.next != frames) + (p.frames_ok != frames);
+    return r;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt = parse_args(argc, argv);
+    int rc = 0;
+
+    std::printf("%u frames per run, DMA %u B, ring / bip %u B, v2 frames\n\n",
+            opt.frames, kDmaSize, kRingSize);
+    std::printf("%-15s %-13s %8s %10s %10s %9s %9s\n", "frames", "path", "B/frame",
+            "copied/fr", "isr/fr", "in place", "ns/frame");
+
+    for (const Dist &d : kDists)
+    {
+        Stream s = make_stream(d, opt.frames, opt.seed);
+        double avg = static_cast<double>(s.frame_bytes) / opt.frames;
+        double base = 0;
+        for (Path path : {RING_COPY, BIP_INPLACE, DMA_COPY, DMA_INPLACE})
+        {
+            Result r = run(path, s);
+            if (path == RING_COPY)
+                base = r.copied_frame;
+            std::printf("%-15s %-13s %8.1f %10.1f %10.1f %8.1f%% %9.1f%s\n", d.name,
+                    kPathName[path], avg, r.copied_frame, r.isr_frame,
+                    100.0 * r.inplace / opt.frames, r.ns_frame, r.bad ? "  FAIL" : "");
+            rc |= (r.bad != 0);
+        }
+        std::printf("%-15s saved vs ring, copy: %.1f B/frame\n\n", "",
+                base - run(BIP_INPLACE, s).copied_frame);
+    }
+    return rc;
+}
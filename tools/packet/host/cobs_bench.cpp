@@ -0,0 +1,156 @@
+/*
+ * cobs_bench.cpp
+ *
+ * Host bench: receive throughput of the two link framings over the same
+ * frames. The raw v1 / v2 stream goes through the streaming PacketParser
+ * (packet_parser_feed_buf()), the COBS framed stream through
+ * PacketCobsParser (packet_cobs_feed_buf()), both cut into the same kind of
+ * random DMA-sized chunks. Both must dispatch every frame.
+ *
+ *   ./cobs_bench [--mb MBYTES] [--chunk MAX] [--seed S]
+ */
+#include "packet_host.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "host_args.hpp"
+
+namespace
+{
+
+struct Options
+{
+    size_t mb = 4;          // raw stream size per distribution
+    size_t chunk = 64;      // max bytes per feed (DMA RX event)
+    uint32_t seed = 1;
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--mb", o.mb, 1),
+        host_args::opt("--chunk", o.chunk, 1),
+        host_args::opt("--seed", o.seed),
+    });
+    return o;
+}
+
+struct Wire
+{
+    std::vector<uint8_t> bytes;
+    std::vector<size_t> cuts;
+};
+
+void cut(Wire &w, std::mt19937 &rng, size_t chunk)
+{
+    for (size_t pos = 0; pos < w.bytes.size();)
+    {
+        size_t c = std::min(1 + rng() % chunk, w.bytes.size() - pos);
+        w.cuts.push_back(c);
+        pos += c;
+    }
+}
+
+void count_frame(void *ctx, const PacketFrame *frame)
+{
+    (void)frame;
+    (*static_cast<uint64_t *>(ctx))++;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+/* Returns seconds; *frames = frames dispatched */
+double run_raw(const Wire &w, uint64_t *frames)
+{
+    PacketParser p;
+    packet_parser_init(&p);
+    *frames = 0;
+    packet_parser_set_handler(&p, count_frame, frames);
+
+    auto t0 = std::chrono::steady_clock::now();
+    size_t pos = 0;
+    for (size_t c : w.cuts)
+    {
+        packet_parser_feed_buf(&p, &w.bytes[pos], c);
+        pos += c;
+    }
+    return seconds_since(t0);
+}
+
+double run_cobs(const Wire &w, uint64_t *frames)
+{
+    PacketCobsParser c;
+    packet_cobs_init(&c);
+    *frames = 0;
+    packet_cobs_set_handler(&c, count_frame, frames);
+
+    auto t0 = std::chrono::steady_clock::now();
+    size_t pos = 0;
+    for (size_t n : w.cuts)
+    {
+        packet_cobs_feed_buf(&c, &w.bytes[pos], n);
+        pos += n;
+    }
+    return seconds_since(t0);
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt = parse_args(argc, argv);
+    int rc = 0;
+
+    std::printf("%zu MB raw per stream, chunks 1..%zu B, v1 / v2 mixed\n\n", opt.mb, opt.chunk);
+    std::printf("%-15s %9s | %-24s | %s\n", "", "", "PacketParser", "COBS split + decode");
+    std::printf("%-15s %9s | %8s %7s %7s | %8s %7s %7s\n", "frames", "count",
+            "B/frame", "ns/B", "ns/fr", "B/frame", "ns/B", "ns/fr");
+    for (const pkt::SizeDist &d : pkt::kSizeDists)
+    {
+        std::mt19937 rng(opt.seed);
+        Wire raw, cobs;
+        uint64_t sent = 0;
+        uint8_t args[PKT_PARSER_BUF_SIZE];
+        while (raw.bytes.size() < (opt.mb << 20))
+        {
+            uint16_t len = static_cast<uint16_t>(d.min + rng() % (d.max - d.min + 1));
+            for (uint16_t k = 0; k + 1U < len; k++)
+                args[k] = static_cast<uint8_t>(rng());
+            std::vector<uint8_t> f = (rng() & 1U)
+                    ? pkt::encode_v2(static_cast<uint8_t>(rng()), LED_ON, args, len - 1U)
+                    : pkt::encode_v1(LED_ON, args, len - 1U);
+            std::vector<uint8_t> e = pkt::cobs_frame(f);
+            raw.bytes.insert(raw.bytes.end(), f.begin(), f.end());
+            cobs.bytes.insert(cobs.bytes.end(), e.begin(), e.end());
+            sent++;
+        }
+        cut(raw, rng, opt.chunk);
+        cut(cobs, rng, opt.chunk);
+
+        // Best of three runs each, to keep scheduler noise out
+        uint64_t f_raw, f_cobs;
+        double t_raw = 1e9, t_cobs = 1e9;
+        for (int r = 0; r < 3; r++)
+        {
+            t_raw = std::min(t_raw, run_raw(raw, &f_raw));
+            t_cobs = std::min(t_cobs, run_cobs(cobs, &f_cobs));
+        }
+        bool ok = (f_raw == sent) && (f_cobs == sent);
+        std::printf("%-15s %9llu | %8.2f %7.2f %7.1f | %8.2f %7.2f %7.1f%s\n", d.name,
+                (unsigned long long)sent,
+                double(raw.bytes.size()) / sent, t_raw * 1e9 / raw.bytes.size(), t_raw * 1e9 / sent,
+                double(cobs.bytes.size()) / sent, t_cobs * 1e9 / cobs.bytes.size(), t_cobs * 1e9 / sent,
+                ok ? "" : "  FAIL");
+        rc |= !ok;
+    }
+    std::printf("\n(B/frame = wire bytes per frame, ns/B per wire byte, ns/fr per frame)\n");
+    return rc;
+}
@@ -0,0 +1,148 @@
+/*
+ * codec_test.cpp
+ *
+ * Host regression tests for the streaming parser's LENGTH checks, built
+ * with AddressSanitizer (SANITIZE in the Makefile). The parser gets frame
+ * storage of exactly cap bytes on the heap, so any write past it aborts.
+ *
+ *   - v2 LEN 0xFFFA..0xFFFF: LEN + 6 wraps in 16 bits to a frame size that
+ *     looked like it fits; it must be rejected as a length error
+ *   - v1 LEN 0xFF and a v2 LEN one byte over the capacity: rejected
+ *   - LEN 0: rejected
+ * Each case runs through packet_parser_feed(), packet_parser_feed_buf() and
+ * packet_parser_feed_dma(), with resync off and on, at cap 16 and 64, and a
+ * valid frame sent after the bad header must still come out.
+ *
+ *   ./codec_test
+ */
+#include "packet_host.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include <vector>
+
+namespace
+{
+
+enum class Feed { Byte, Buf, Dma };
+
+const char *feed_name(Feed f)
+{
+    return (f == Feed::Byte) ? "feed" : (f == Feed::Buf) ? "feed_buf" : "feed_dma";
+}
+
+struct Seen
+{
+    unsigned frames = 0;
+    unsigned good = 0;
+};
+
+void on_frame(void *ctx, const PacketFrame *f)
+{
+    Seen *s = static_cast<Seen *>(ctx);
+    s->frames++;
+    if ((f->version == 2) && (f->seq == 0x5A) && (f->len == 3) && (f->payload[0] == LED_ON)
+            && (f->payload[1] == 0x11) && (f->payload[2] == 0x22))
+        s->good++;
+}
+
+void feed(PacketParser *p, Feed how, const std::vector<uint8_t> &in)
+{
+    if (how == Feed::Byte)
+    {
+        for (uint8_t b : in)
+            packet_parser_feed(p, b);
+    }
+    else if (how == Feed::Buf)
+    {
+        packet_parser_feed_buf(p, in.data(), in.size());
+    }
+    else
+    {
+        // Through a 32-byte circular DMA buffer, 20 bytes per RX event
+        const uint16_t size = 32;
+        std::vector<uint8_t> dma(size);
+        uint16_t last = 0, cur = 0;
+        for (size_t pos = 0; pos < in.size();)
+        {
+            for (int n = 0; (n < 20) && (pos < in.size()); n++)
+            {
+                dma[cur] = in[pos++];
+                cur = static_cast<uint16_t>((cur + 1U) % size);
+            }
+            packet_parser_feed_dma(p, dma.data(), size, last, cur);
+            last = cur;
+        }
+    }
+}
+
+int failures = 0;
+
+void run_case(const char *name, const std::vector<uint8_t> &bad, uint16_t cap, Feed how, bool resync)
+{
+    static const uint8_t args[] = {0x11, 0x22};
+    std::vector<uint8_t> in = bad;
+    in.resize(in.size() + 2 * cap, 0x00);  // filler past the bad header
+    std::vector<uint8_t> good = pkt::encode_v2(0x5A, LED_ON, args, sizeof(args));
+    in.insert(in.end(), good.begin(), good.end());
+
+    std::vector<uint8_t> storage(cap);
+    PacketParser p;
+    Seen seen;
+    packet_parser_init_buf(&p, storage.data(), cap);
+    packet_parser_set_resync(&p, resync ? 1 : 0);
+    packet_parser_set_handler(&p, on_frame, &seen);
+
+    feed(&p, how, in);
+
+    bool ok = (p.len_err >= 1) && (seen.frames == 1) && (seen.good == 1);
+    if (!ok)
+    {
+        failures++;
+        std::printf("FAIL %-22s cap=%-3u %-8s resync=%d: len_err=%u frames=%u good=%u\n",
+                name, cap, feed_name(how), resync ? 1 : 0, (unsigned)p.len_err,
+                seen.frames, seen.good);
+    }
+}
+
+} // namespace
+
+int main()
+{
+    struct Case
+    {
+        std::string name;
+        std::vector<uint8_t> hdr;
+    };
+    std::vector<Case> cases;
+    for (unsigned len = 0xFFFA; len <= 0xFFFF; len++)
+    {
+        char name[32];
+        std::snprintf(name, sizeof(name), "v2 LEN 0x%04X", len);
+        cases.push_back({name, {CMD_HEADER_V2, static_cast<uint8_t>(len), static_cast<uint8_t>(len >> 8)}});
+    }
+    cases.push_back({"v2 LEN 0", {CMD_HEADER_V2, 0x00, 0x00}});
+    cases.push_back({"v1 LEN 0xFF", {CMD_HEADER, 0xFF}});
+    cases.push_back({"v1 LEN 0", {CMD_HEADER, 0x00}});
+
+    unsigned runs = 0;
+    for (uint16_t cap : {uint16_t(16), uint16_t(PKT_PARSER_BUF_SIZE)})
+    {
+        // One byte more than fits: LEN = cap - 6 + 1
+        uint16_t over = static_cast<uint16_t>(cap - PKT_V2_OVERHEAD + 1);
+        std::vector<Case> all = cases;
+        all.push_back({"v2 LEN cap-6+1", {CMD_HEADER_V2, static_cast<uint8_t>(over), static_cast<uint8_t>(over >> 8)}});
+
+        for (const Case &c : all)
+            for (Feed how : {Feed::Byte, Feed::Buf, Feed::Dma})
+                for (bool resync : {false, true})
+                {
+                    run_case(c.name.c_str(), c.hdr, cap, how, resync);
+                    runs++;
+                }
+    }
+
+    std::printf("%u cases, %d failed\n%s\n", runs, failures, failures ? "FAIL" : "PASS");
+    return failures ? 1 : 0;
+}
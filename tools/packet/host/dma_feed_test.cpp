@@ -0,0 +1,142 @@
+/*
+ * dma_feed_test.cpp
+ *
+ * Host test for packet_parser_feed_dma(): a v1 / v2 stream is written into a
+ * circular DMA RX buffer whose NDTR-style counter wraps at random points,
+ * and the parser is fed [last_pos, cur_pos) on every simulated RX event,
+ * the way uart_rx_process() does. Every frame must come out bit for bit.
+ *
+ *   ./dma_feed_test [--frames N] [--dma BYTES] [--seed S]
+ */
+#include "packet_host.hpp"
+
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "host_args.hpp"
+
+namespace
+{
+
+struct Sent
+{
+    uint8_t version;
+    uint8_t seq;
+    std::vector<uint8_t> payload;   // CMD + PAYLOAD
+};
+
+struct Options
+{
+    uint64_t frames = 200000;
+    uint16_t dma = 64;      // DMA RX buffer size (UART_DMA_RX_BUF_SIZE)
+    uint32_t seed = 1;
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--frames", o.frames),
+        host_args::opt("--dma", o.dma, 2),
+        host_args::opt("--seed", o.seed),
+    });
+    return o;
+}
+
+struct Check
+{
+    const std::vector<Sent> *sent;
+    size_t next = 0;
+    uint64_t ok = 0, bad = 0;
+};
+
+void check_frame(void *ctx, const PacketFrame *f)
+{
+    Check *c = static_cast<Check *>(ctx);
+    if (c->next >= c->sent->size())
+    {
+        c->bad++;
+        return;
+    }
+    const Sent &s = (*c->sent)[c->next++];
+    if ((f->version == s.version) && (f->seq == s.seq) && (f->len == s.payload.size())
+            && (std::memcmp(f->payload, s.payload.data(), f->len) == 0))
+        c->ok++;
+    else
+        c->bad++;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const Options opt = parse_args(argc, argv);
+    std::mt19937 rng(opt.seed);
+
+    std::vector<Sent> sent(opt.frames);
+    std::vector<uint8_t> stream;
+    for (Sent &s : sent)
+    {
+        s.version = (rng() & 1U) ? 2 : 1;
+        s.seq = (s.version == 2) ? static_cast<uint8_t>(rng()) : 0;
+        size_t max = (s.version == 2) ? PKT_V2_MAX_PAYLOAD_LEN : PKT_MAX_PAYLOAD_LEN;
+        s.payload.resize(1 + rng() % max);
+        for (uint8_t &b : s.payload)
+            b = static_cast<uint8_t>(rng());
+        std::vector<uint8_t> f = (s.version == 2)
+                ? pkt::encode_v2(s.seq, s.payload[0], &s.payload[1], s.payload.size() - 1)
+                : pkt::encode_v1(s.payload[0], &s.payload[1], s.payload.size() - 1);
+        stream.insert(stream.end(), f.begin(), f.end());
+    }
+
+    PacketParser p;
+    Check chk;
+    chk.sent = &sent;
+    packet_parser_init(&p);
+    packet_parser_set_handler(&p, check_frame, &chk);
+
+    // Circular DMA: the counter counts down from dma to 1 and reloads, so the
+    // write position is dma - NDTR and reads back as 0 right after a wrap.
+    std::vector<uint8_t> dma(opt.dma);
+    uint16_t ndtr = opt.dma;
+    uint16_t last_pos = 0;
+    uint64_t events = 0, wraps = 0, returned = 0;
+
+    for (size_t pos = 0; pos < stream.size();)
+    {
+        // Bytes until the next RX event (IDLE / HT / TC); never a full lap,
+        // or the DMA would overrun data the parser has not seen yet
+        size_t n = std::min<size_t>(1 + rng() % (opt.dma - 1U), stream.size() - pos);
+        for (size_t i = 0; i < n; i++)
+        {
+            dma[opt.dma - ndtr] = stream[pos++];
+            if (--ndtr == 0)
+                ndtr = opt.dma;
+        }
+
+        uint16_t cur_pos = opt.dma - ndtr;
+        // Counter read as 0 before the reload is seen: position == buf_size
+        if ((cur_pos == 0) && (rng() & 1U))
+            cur_pos = opt.dma;
+        if (cur_pos % opt.dma < last_pos)
+            wraps++;
+
+        returned += packet_parser_feed_dma(&p, dma.data(), opt.dma, last_pos, cur_pos);
+        last_pos = cur_pos % opt.dma;
+        events++;
+    }
+
+    bool pass = (chk.ok == opt.frames) && (chk.bad == 0) && (returned == opt.frames)
+            && (p.csum_err == 0) && (p.len_err == 0);
+    std::printf("frames=%llu ok=%llu bad=%llu returned=%llu dma=%u events=%llu wraps=%llu\n",
+            (unsigned long long)opt.frames, (unsigned long long)chk.ok,
+            (unsigned long long)chk.bad, (unsigned long long)returned, opt.dma,
+            (unsigned long long)events, (unsigned long long)wraps);
+    std::printf("parser: frames_ok=%u csum_err=%u len_err=%u resync=%u\n",
+            (unsigned)p.frames_ok, (unsigned)p.csum_err, (unsigned)p.len_err,
+            (unsigned)p.resync_count);
+    std::printf("%s\n", pass ? "PASS" : "FAIL");
+    return pass ? 0 : 1;
+}
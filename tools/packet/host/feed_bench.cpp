@@ -0,0 +1,130 @@
+/*
+ * feed_bench.cpp
+ *
+ * Host bench: ns/byte of the streaming parser fed one byte at a time
+ * (packet_parser_feed()) against the bulk chunk feed
+ * (packet_parser_feed_buf()), for v1 / v2 streams of several frame-size
+ * distributions. Both paths must dispatch the same frames.
+ *
+ *   ./feed_bench [--mb MBYTES] [--chunk MAX] [--seed S]
+ */
+#include "packet_host.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "host_args.hpp"
+
+namespace
+{
+
+struct Options
+{
+    size_t mb = 4;          // stream size per distribution
+    size_t chunk = 64;      // max bytes per bulk feed (DMA RX event)
+    uint32_t seed = 1;
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--mb", o.mb, 1),
+        host_args::opt("--chunk", o.chunk, 1),
+        host_args::opt("--seed", o.seed),
+    });
+    return o;
+}
+
+struct Stream
+{
+    std::vector<uint8_t> bytes;
+    std::vector<size_t> cuts;
+    uint64_t frames = 0;
+};
+
+Stream make_stream(const pkt::SizeDist &d, const Options &o)
+{
+    std::mt19937 rng(o.seed);
+    Stream s;
+    uint8_t args[PKT_PARSER_BUF_SIZE];
+    while (s.bytes.size() < (o.mb << 20))
+    {
+        uint16_t len = static_cast<uint16_t>(d.min + rng() % (d.max - d.min + 1));
+        for (uint16_t k = 0; k + 1U < len; k++)
+            args[k] = static_cast<uint8_t>(rng());
+        std::vector<uint8_t> f = (rng() & 1U)
+                ? pkt::encode_v2(static_cast<uint8_t>(rng()), LED_ON, args, len - 1U)
+                : pkt::encode_v1(LED_ON, args, len - 1U);
+        s.bytes.insert(s.bytes.end(), f.begin(), f.end());
+        s.frames++;
+    }
+    for (size_t pos = 0; pos < s.bytes.size();)
+    {
+        size_t c = std::min(1 + rng() % o.chunk, s.bytes.size() - pos);
+        s.cuts.push_back(c);
+        pos += c;
+    }
+    return s;
+}
+
+void count_frame(void *ctx, const PacketFrame *frame)
+{
+    (void)frame;
+    (*static_cast<uint64_t *>(ctx))++;
+}
+
+/* Returns ns/byte; *frames = frames dispatched */
+double run(const Stream &s, bool bulk, uint64_t *frames)
+{
+    PacketParser p;
+    packet_parser_init(&p);
+    *frames = 0;
+    packet_parser_set_handler(&p, count_frame, frames);
+
+    auto t0 = std::chrono::steady_clock::now();
+    if (bulk)
+    {
+        size_t pos = 0;
+        for (size_t c : s.cuts)
+        {
+            packet_parser_feed_buf(&p, &s.bytes[pos], c);
+            pos += c;
+        }
+    }
+    else
+    {
+        for (uint8_t b : s.bytes)
+            packet_parser_feed(&p, b);
+    }
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return t * 1e9 / s.bytes.size();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt = parse_args(argc, argv);
+    int rc = 0;
+
+    std::printf("%zu MB per stream, bulk chunks 1..%zu B, v1 / v2 mixed\n\n", opt.mb, opt.chunk);
+    std::printf("%-15s %10s %12s %12s %8s\n", "frames", "count", "per-byte", "bulk", "speedup");
+    for (const pkt::SizeDist &d : pkt::kSizeDists)
+    {
+        Stream s = make_stream(d, opt);
+        uint64_t f_byte, f_bulk;
+        double ns_byte = run(s, false, &f_byte);
+        double ns_bulk = run(s, true, &f_bulk);
+        bool ok = (f_byte == s.frames) && (f_bulk == s.frames);
+        std::printf("%-15s %10llu %9.2f ns %9.2f ns %7.2fx%s\n", d.name,
+                (unsigned long long)s.frames, ns_byte, ns_bulk, ns_byte / ns_bulk,
+                ok ? "" : "  FAIL");
+        rc |= !ok;
+    }
+    std::printf("\n(ns per byte of stream)\n");
+    return rc;
+}
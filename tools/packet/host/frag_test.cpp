@@ -0,0 +1,305 @@
+/*
+ * frag_test.cpp
+ *
+ * Host regression test for bulk transfers (Core/Src/frag.c), built with
+ * AddressSanitizer like codec_test. Every run sends 4 KB transfers as v2
+ * frames through the firmware parser into a 4 KB reassembly pool and checks
+ * each completed block byte for byte.
+ *
+ *   direct  fragments straight into frag_rx_feed(), as uart_link_on_frame()
+ *           does without ARQ: duplicated fragments are ignored; a lost one
+ *           aborts the transfer, which the sender then repeats
+ *   arq     the same fragments through the ARQ engine (arq.c) on both ends
+ *           of a pipe that drops and duplicates frames, as with ARQ_ENABLE:
+ *           every transfer must complete on the first attempt
+ *
+ *   ./frag_test
+ */
+#include "packet_host.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <deque>
+#include <random>
+#include <vector>
+
+#include "arq.h"
+#include "frag.h"
+
+namespace
+{
+
+const uint16_t XFER_SIZE = 4096;
+const unsigned XFERS = 20;
+const uint16_t FRAG_PAYLOAD = ARQ_MAX_PAYLOAD;   // CMD + PAYLOAD per frame
+
+int failures = 0;
+
+void check(bool ok, const char *name, const char *what)
+{
+    if (!ok)
+    {
+        std::printf("FAIL %s: %s\n", name, what);
+        failures++;
+    }
+}
+
+std::vector<uint8_t> make_data(uint32_t seed)
+{
+    std::mt19937 rng(seed);
+    std::vector<uint8_t> d(XFER_SIZE);
+    for (uint8_t &b : d)
+        b = static_cast<uint8_t>(rng());
+    return d;
+}
+
+/* Receiver: parser -> (ARQ) -> FragRx with one 4 KB buffer */
+struct Receiver
+{
+    FragRx frag;
+    std::vector<uint8_t> pool = std::vector<uint8_t>(XFER_SIZE);
+    const std::vector<uint8_t> *expect = nullptr;
+    unsigned blocks = 0;
+    unsigned bad = 0;
+
+    static void on_block(void *ctx, FragBlock *blk)
+    {
+        Receiver *r = static_cast<Receiver *>(ctx);
+        r->blocks++;
+        if ((blk->len != r->expect->size())
+                || (std::memcmp(blk->data, r->expect->data(), blk->len) != 0))
+            r->bad++;
+        frag_release(&r->frag, blk);
+    }
+
+    Receiver()
+    {
+        frag_rx_init(&frag, pool.data(), XFER_SIZE, 1, on_block, this);
+    }
+};
+
+std::vector<std::vector<uint8_t>> fragments(uint8_t xfer_id, const std::vector<uint8_t> &data)
+{
+    FragTx tx;
+    uint8_t payload[FRAG_PAYLOAD];
+    uint16_t n;
+    std::vector<std::vector<uint8_t>> out;
+
+    frag_tx_init(&tx, xfer_id, data.data(), static_cast<uint16_t>(data.size()), FRAG_PAYLOAD);
+    while ((n = frag_tx_next(&tx, payload)) > 0)
+        out.emplace_back(payload, payload + n);
+    return out;
+}
+
+/* ---------- direct: no ARQ between the parser and frag_rx_feed() ---------- */
+void frag_on_frame(void *ctx, const PacketFrame *f)
+{
+    Receiver *r = static_cast<Receiver *>(ctx);
+    frag_rx_feed(&r->frag, f->payload, f->len);
+}
+
+void test_direct(double loss, double dup)
+{
+    char name[64];
+    std::snprintf(name, sizeof(name), "direct loss %.0f%% dup %.0f%%", loss * 100, dup * 100);
+
+    std::mt19937 rng(7);
+    std::bernoulli_distribution lose(loss), twice(dup);
+    std::vector<uint8_t> parser_buf(PKT_V2_FRAME_SIZE(FRAG_PAYLOAD));
+    PacketParser parser;
+    Receiver rx;
+    packet_parser_init_buf(&parser, parser_buf.data(), static_cast<uint16_t>(parser_buf.size()));
+    packet_parser_set_handler(&parser, frag_on_frame, &rx);
+
+    unsigned attempts = 0;
+    uint8_t seq = 0;
+    for (unsigned x = 0; x < XFERS; x++)
+    {
+        std::vector<uint8_t> data = make_data(x);
+        auto frags = fragments(static_cast<uint8_t>(x), data);
+        rx.expect = &data;
+        unsigned before = rx.blocks;
+
+        // The sender repeats the whole transfer until it lands
+        while ((rx.blocks == before) && (attempts < XFERS * 100))
+        {
+            attempts++;
+            for (const auto &fr : frags)
+            {
+                std::vector<uint8_t> wire = pkt::encode_v2(seq++, fr[0], &fr[1], fr.size() - 1);
+                if (lose(rng))
+                    continue;
+                packet_parser_feed_buf(&parser, wire.data(), wire.size());
+                if (twice(rng))
+                    packet_parser_feed_buf(&parser, wire.data(), wire.size());
+            }
+        }
+    }
+
+    check(rx.blocks == XFERS, name, "transfers missing");
+    check(rx.bad == 0, name, "block content differs");
+    check(rx.frag.completed == XFERS, name, "completed count");
+    check((dup == 0) || (rx.frag.duplicates > 0), name, "no duplicate seen");
+    check((loss > 0) || (rx.frag.aborted == 0), name, "aborted without loss");
+    std::printf("%-26s %2u/%u blocks, %3u attempts, %4u duplicates, %3u aborted\n", name,
+            rx.blocks, XFERS, attempts, rx.frag.duplicates, rx.frag.aborted);
+}
+
+/* ---------- arq: fragments as reliable data frames ---------- */
+/* One direction: whole frames are dropped or duplicated, delivered next tick */
+struct Pipe
+{
+    std::mt19937 &rng;
+    std::bernoulli_distribution lose, twice;
+    std::deque<std::vector<uint8_t>> q;
+
+    Pipe(std::mt19937 &r, double loss, double dup) : rng(r), lose(loss), twice(dup) {}
+
+    void send(const uint8_t *frame, uint16_t len)
+    {
+        if (lose(rng))
+            return;
+        q.emplace_back(frame, frame + len);
+        if (twice(rng))
+            q.emplace_back(frame, frame + len);
+    }
+
+    void deliver(PacketParser *p)
+    {
+        std::deque<std::vector<uint8_t>> now;
+        now.swap(q);
+        for (const auto &f : now)
+            packet_parser_feed_buf(p, f.data(), f.size());
+    }
+};
+
+struct Endpoint
+{
+    Arq arq;
+    PacketParser parser;
+    std::vector<uint8_t> parser_buf = std::vector<uint8_t>(PKT_V2_FRAME_SIZE(ARQ_MAX_PAYLOAD));
+    Pipe *out = nullptr;
+    Receiver *rx = nullptr;     // receiving side only
+    uint32_t now = 0;
+
+    static void tx_fn(void *ctx, const uint8_t *frame, uint16_t len)
+    {
+        static_cast<Endpoint *>(ctx)->out->send(frame, len);
+    }
+
+    // arq_link_deliver() -> uart_link_on_payload() in main.c
+    static void deliver_fn(void *ctx, const uint8_t *payload, uint16_t len)
+    {
+        Endpoint *e = static_cast<Endpoint *>(ctx);
+        if ((e->rx != nullptr) && (len > 0) && (payload[0] == FRAG_CMD))
+            frag_rx_feed(&e->rx->frag, payload, len);
+    }
+
+    static void on_frame(void *ctx, const PacketFrame *f)
+    {
+        Endpoint *e = static_cast<Endpoint *>(ctx);
+        if (f->version == 2)
+            arq_on_frame(&e->arq, f, e->now);
+    }
+
+    void init(Pipe *o, Receiver *r)
+    {
+        out = o;
+        rx = r;
+        arq_init(&arq, 8, 30, tx_fn, deliver_fn, this);
+        packet_parser_init_buf(&parser, parser_buf.data(), static_cast<uint16_t>(parser_buf.size()));
+        packet_parser_set_handler(&parser, on_frame, this);
+    }
+};
+
+void test_arq(double loss, double dup)
+{
+    char name[64];
+    std::snprintf(name, sizeof(name), "arq loss %.0f%% dup %.0f%%", loss * 100, dup * 100);
+
+    std::mt19937 rng(11);
+    Pipe a_to_b(rng, loss, dup), b_to_a(rng, loss, dup);
+    Receiver rx;
+    Endpoint a, b;
+    a.init(&a_to_b, nullptr);
+    b.init(&b_to_a, &rx);
+
+    uint32_t now = 0;
+    for (unsigned x = 0; x < XFERS; x++)
+    {
+        std::vector<uint8_t> data = make_data(100 + x);
+        auto frags = fragments(static_cast<uint8_t>(x), data);
+        rx.expect = &data;
+        size_t next = 0;
+
+        // Send once; ARQ repairs loss and drops duplicates, 10 ms per tick
+        while ((rx.blocks == x) && (now < 600000))
+        {
+            while ((next < frags.size()) && (arq_window_free(&a.arq) > 0))
+            {
+                arq_send(&a.arq, frags[next].data(), static_cast<uint16_t>(frags[next].size()), now);
+                next++;
+            }
+            now += 10;
+            a.now = b.now = now;
+            a_to_b.deliver(&b.parser);
+            b_to_a.deliver(&a.parser);
+            arq_poll(&a.arq, now);
+            arq_poll(&b.arq, now);
+        }
+    }
+
+    check(rx.blocks == XFERS, name, "transfers missing");
+    check(rx.bad == 0, name, "block content differs");
+    check(rx.frag.aborted == 0, name, "transfer aborted");
+    check((loss == 0) || (a.arq.stats.retransmits > 0), name, "no retransmit under loss");
+    check((dup == 0) || (b.arq.stats.dup_rx > 0), name, "no duplicate seen");
+    std::printf("%-26s %2u/%u blocks, %5u retransmits, %4u dup_rx, %3u aborted\n", name,
+            rx.blocks, XFERS, a.arq.stats.retransmits, b.arq.stats.dup_rx, rx.frag.aborted);
+}
+
+/* ---------- pool ownership ---------- */
+void test_no_buffer()
+{
+    const char *name = "no buffer";
+    std::vector<uint8_t> pool(XFER_SIZE);
+    FragBlock *held = nullptr;
+    FragRx r;
+    frag_rx_init(&r, pool.data(), XFER_SIZE, 1,
+            [](void *ctx, FragBlock *blk) { *static_cast<FragBlock **>(ctx) = blk; }, &held);
+
+    std::vector<uint8_t> data = make_data(1);
+    for (unsigned k = 0; k < 2; k++)
+    {
+        for (const auto &fr : fragments(static_cast<uint8_t>(k), data))
+            frag_rx_feed(&r, fr.data(), static_cast<uint16_t>(fr.size()));
+    }
+    check((r.completed == 1) && (r.no_buffer == 1), name, "second transfer not refused");
+
+    frag_release(&r, held);
+    for (const auto &fr : fragments(2, data))
+        frag_rx_feed(&r, fr.data(), static_cast<uint16_t>(fr.size()));
+    check(r.completed == 2, name, "released buffer not reused");
+    check((held != nullptr) && (std::memcmp(held->data, data.data(), XFER_SIZE) == 0), name,
+            "block content differs");
+}
+
+} // namespace
+
+int main()
+{
+    std::printf("%u transfers of %u B, %u B fragments\n\n", XFERS, XFER_SIZE, FRAG_PAYLOAD);
+
+    test_direct(0.0, 0.0);
+    test_direct(0.0, 0.2);
+    test_direct(0.01, 0.1);
+
+    test_arq(0.0, 0.0);
+    test_arq(0.05, 0.05);
+    test_arq(0.2, 0.2);
+
+    test_no_buffer();
+
+    std::printf("\nfrag_test: %s\n", failures ? "FAIL" : "ok");
+    return failures ? 1 : 0;
+}
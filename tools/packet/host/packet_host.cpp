@@ -0,0 +1,173 @@
+/*
+ * packet_host.cpp
+ *
+ * C++ wrapper (packet_host.hpp) and the C ABI used by the Python binding
+ * (tools/packet/packet_codec.py, ctypes).
+ */
+#include "packet_host.hpp"
+
+#include <cstring>
+#include <deque>
+
+/* No command table on the host: frames of parsers without a handler are dropped */
+extern "C" void packet_default_handler(void *ctx, const PacketFrame *frame)
+{
+    (void)ctx;
+    (void)frame;
+}
+
+namespace pkt
+{
+
+std::vector<uint8_t> encode_v1(uint8_t cmd, const uint8_t *params, size_t len)
+{
+    std::vector<uint8_t> out(PKT_V1_FRAME_SIZE(1 + len));
+    uint8_t n = build_packet(out.data(), static_cast<CMD_ID>(cmd),
+            const_cast<uint8_t *>(params), static_cast<uint8_t>(len));
+    out.resize(n);
+    return out;
+}
+
+std::vector<uint8_t> encode_v2(uint8_t seq, uint8_t cmd, const uint8_t *params, size_t len)
+{
+    std::vector<uint8_t> out(PKT_V2_FRAME_SIZE(1 + len));
+    uint16_t n = build_packet_v2(out.data(), seq, static_cast<CMD_ID>(cmd),
+            params, static_cast<uint16_t>(len));
+    out.resize(n);
+    return out;
+}
+
+std::vector<uint8_t> cobs_frame(const std::vector<uint8_t> &frame)
+{
+    std::vector<uint8_t> out(COBS_MAX_ENCODED_LEN(frame.size()) + 1);
+    uint16_t n = packet_cobs_encode(out.data(), frame.data(), static_cast<uint16_t>(frame.size()));
+    out.resize(n);
+    return out;
+}
+
+const SizeDist kSizeDists[4] = {
+    {"small  1-4 B", 1, 4},
+    {"medium 8-32 B", 8, 32},
+    {"large  40-58 B", 40, PKT_V2_MAX_PAYLOAD_LEN},
+    {"mixed  1-58 B", 1, PKT_V2_MAX_PAYLOAD_LEN},
+};
+
+Decoder::Decoder(uint16_t cap, bool resync) : buf_(cap)
+{
+    packet_parser_init_buf(&parser_, buf_.data(), cap);
+    packet_parser_set_resync(&parser_, resync ? 1 : 0);
+    packet_parser_set_handler(&parser_, &Decoder::trampoline, this);
+}
+
+uint16_t Decoder::feed(const uint8_t *data, size_t len)
+{
+    return packet_parser_feed_buf(&parser_, data, len);
+}
+
+void Decoder::trampoline(void *ctx, const PacketFrame *frame)
+{
+    Decoder *self = static_cast<Decoder *>(ctx);
+    if (self->fn_)
+        self->fn_(*frame);
+}
+
+} // namespace pkt
+
+/* ---------- C ABI ---------- */
+namespace
+{
+
+struct QueuedFrame
+{
+    uint8_t version;
+    uint8_t seq;
+    std::vector<uint8_t> payload;
+};
+
+struct HostDecoder
+{
+    explicit HostDecoder(uint16_t cap, bool resync) : dec(cap, resync)
+    {
+        dec.on_frame([this](const PacketFrame &f) {
+            frames.push_back({f.version, f.seq,
+                    std::vector<uint8_t>(f.payload, f.payload + f.len)});
+        });
+    }
+
+    pkt::Decoder dec;
+    std::deque<QueuedFrame> frames;
+};
+
+} // namespace
+
+extern "C" {
+
+/* Encode into out (cap bytes). Returns frame length, -1 if out is too small. */
+int pkt_encode_v1(uint8_t *out, size_t cap, uint8_t cmd, const uint8_t *params, size_t len)
+{
+    if ((len > 0xFFU - PKT_V1_OVERHEAD - 1U) || (cap < PKT_V1_FRAME_SIZE(1 + len)))
+        return -1;
+    return build_packet(out, static_cast<CMD_ID>(cmd), const_cast<uint8_t *>(params),
+            static_cast<uint8_t>(len));
+}
+
+int pkt_encode_v2(uint8_t *out, size_t cap, uint8_t seq, uint8_t cmd, const uint8_t *params, size_t len)
+{
+    if ((len > 0xFFFFU - 1U) || (cap < PKT_V2_FRAME_SIZE(1 + len)))
+        return -1;
+    return build_packet_v2(out, seq, static_cast<CMD_ID>(cmd), params, static_cast<uint16_t>(len));
+}
+
+int pkt_parse(uint8_t *buf, size_t len)
+{
+    return parse_packet(buf, static_cast<uint16_t>(len));
+}
+
+void *pkt_decoder_new(uint16_t cap, int resync)
+{
+    return new HostDecoder(cap, resync != 0);
+}
+
+void pkt_decoder_free(void *d)
+{
+    delete static_cast<HostDecoder *>(d);
+}
+
+int pkt_decoder_feed(void *d, const uint8_t *data, size_t len)
+{
+    return static_cast<HostDecoder *>(d)->dec.feed(data, len);
+}
+
+/* Pop the oldest decoded frame: CMD + PAYLOAD into out.
+ * Returns its length, -1 if none is queued, -2 if out is too small. */
+int pkt_decoder_next(void *d, uint8_t *out, size_t cap, uint8_t *version, uint8_t *seq)
+{
+    HostDecoder *h = static_cast<HostDecoder *>(d);
+    if (h->frames.empty())
+        return -1;
+
+    QueuedFrame &f = h->frames.front();
+    if (f.payload.size() > cap)
+        return -2;
+
+    std::memcpy(out, f.payload.data(), f.payload.size());
+    *version = f.version;
+    *seq = f.seq;
+    int n = static_cast<int>(f.payload.size());
+    h->frames.pop_front();
+    return n;
+}
+
+/* resync, dropped_bytes, recovered, frames_ok, csum_err, len_err */
+void pkt_decoder_stats(void *d, uint32_t out[6])
+{
+    const PacketParser &p = static_cast<HostDecoder *>(d)->dec.parser();
+    out[0] = p.resync_count;
+    out[1] = p.dropped_bytes;
+    out[2] = p.recovered_frames;
+    out[3] = p.frames_ok;
+    out[4] = p.csum_err;
+    out[5] = p.len_err;
+}
+
+} // extern "C"
@@ -0,0 +1,65 @@
+/*
+ * packet_host.hpp
+ *
+ * Thin C++ host wrapper around the firmware packet codec
+ * (Core/Src/packet_codec.c, compiled unchanged for the host).
+ */
+
+#ifndef PACKET_HOST_HPP_
+#define PACKET_HOST_HPP_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+
+#include "packet_codec.h"
+
+namespace pkt
+{
+
+/* Whole v1 / v2 frame for CMD + params (build_packet / build_packet_v2) */
+std::vector<uint8_t> encode_v1(uint8_t cmd, const uint8_t *params, size_t len);
+std::vector<uint8_t> encode_v2(uint8_t seq, uint8_t cmd, const uint8_t *params, size_t len);
+
+/* Frame -> COBS + 0x00 delimiter (packet_cobs_encode) */
+std::vector<uint8_t> cobs_frame(const std::vector<uint8_t> &frame);
+
+/* CMD + PAYLOAD length range of a bench stream */
+struct SizeDist
+{
+    const char *name;
+    uint16_t min, max;
+};
+
+/* small / medium / large / mixed, all inside the default 64-byte parser */
+extern const SizeDist kSizeDists[4];
+
+/* Streaming decoder: the firmware PacketParser with its own frame buffer */
+class Decoder
+{
+public:
+    using FrameFn = std::function<void(const PacketFrame &)>;
+
+    explicit Decoder(uint16_t cap = PKT_PARSER_BUF_SIZE, bool resync = true);
+    Decoder(const Decoder &) = delete;
+    Decoder &operator=(const Decoder &) = delete;
+
+    void on_frame(FrameFn fn) { fn_ = std::move(fn); }
+
+    /* Returns the number of frames completed */
+    uint16_t feed(const uint8_t *data, size_t len);
+
+    const PacketParser &parser() const { return parser_; }
+
+private:
+    static void trampoline(void *ctx, const PacketFrame *frame);
+
+    PacketParser parser_;
+    std::vector<uint8_t> buf_;
+    FrameFn fn_;
+};
+
+} // namespace pkt
+
+#endif /* PACKET_HOST_HPP_ */
@@ -0,0 +1,172 @@
+/*
+ * packet_loopback.cpp
+ *
+ * Host loopback bench: random v1/v2 frames -> host encoder (build_packet*)
+ * -> byte stream cut into random chunks -> firmware streaming parser.
+ * Every decoded frame is compared bit for bit with what was sent.
+ *
+ *   ./packet_loopback [--frames N] [--cap BYTES] [--chunk MAX] [--junk PCT] [--seed S]
+ */
+#include "packet_host.hpp"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <random>
+
+#include "host_args.hpp"
+
+namespace
+{
+
+struct Sent
+{
+    uint8_t version;
+    uint8_t seq;
+    std::vector<uint8_t> payload;   // CMD + PAYLOAD
+};
+
+struct Options
+{
+    uint64_t frames = 2000000;
+    uint16_t cap = PKT_PARSER_BUF_SIZE;
+    size_t chunk = 64;      // max bytes per feed (DMA IDLE burst)
+    unsigned junk = 0;      // % of frames followed by junk bytes
+    uint32_t seed = 1;
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--frames", o.frames),
+        host_args::opt("--cap", o.cap),
+        host_args::opt("--chunk", o.chunk, 1),
+        host_args::opt("--junk", o.junk),
+        host_args::opt("--seed", o.seed),
+    });
+    return o;
+}
+
+double seconds_since(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const Options opt = parse_args(argc, argv);
+    const size_t batch = 4096;
+    // Largest CMD + PAYLOAD the parser capacity accepts, per format
+    const size_t max_v1 = std::min<size_t>(opt.cap - PKT_V1_OVERHEAD, 0xFFU - PKT_V1_OVERHEAD - 1U);
+    const size_t max_v2 = opt.cap - PKT_V2_OVERHEAD;
+
+    std::mt19937 rng(opt.seed);
+    pkt::Decoder dec(opt.cap, true);
+
+    std::vector<Sent> sent;
+    std::vector<uint8_t> stream;
+    size_t next = 0;
+    uint64_t ok = 0, bad = 0, bytes = 0;
+    double t_enc = 0, t_dec = 0;
+
+    dec.on_frame([&](const PacketFrame &f) {
+        if (next >= sent.size())
+        {
+            bad++;
+            return;
+        }
+        const Sent &s = sent[next++];
+        if ((f.version == s.version) && (f.seq == s.seq) && (f.len == s.payload.size())
+                && (std::memcmp(f.payload, s.payload.data(), f.len) == 0))
+            ok++;
+        else
+            bad++;
+    });
+
+    for (uint64_t done = 0; done < opt.frames; done += batch)
+    {
+        size_t n = static_cast<size_t>(std::min<uint64_t>(batch, opt.frames - done));
+
+        // Random content first, so only build_packet* is timed below
+        sent.resize(n);
+        for (Sent &s : sent)
+        {
+            s.version = (rng() & 1U) ? 2 : 1;
+            s.seq = (s.version == 2) ? static_cast<uint8_t>(rng()) : 0;
+            size_t max = (s.version == 2) ? max_v2 : max_v1;
+            s.payload.resize(1 + rng() % max);
+            for (uint8_t &b : s.payload)
+                b = static_cast<uint8_t>(rng());
+        }
+
+        stream.clear();
+        auto t0 = std::chrono::steady_clock::now();
+        for (const Sent &s : sent)
+        {
+            std::vector<uint8_t> f = (s.version == 2)
+                    ? pkt::encode_v2(s.seq, s.payload[0], &s.payload[1], s.payload.size() - 1)
+                    : pkt::encode_v1(s.payload[0], &s.payload[1], s.payload.size() - 1);
+            stream.insert(stream.end(), f.begin(), f.end());
+        }
+        t_enc += seconds_since(t0);
+
+        if (opt.junk != 0)
+        {
+            // Junk between frames, free of header bytes so no frame is lost
+            std::vector<uint8_t> mixed;
+            mixed.reserve(stream.size() * 2);
+            size_t pos = 0;
+            for (const Sent &s : sent)
+            {
+                size_t flen = s.payload.size() + ((s.version == 2) ? PKT_V2_OVERHEAD : PKT_V1_OVERHEAD);
+                mixed.insert(mixed.end(), stream.begin() + pos, stream.begin() + pos + flen);
+                pos += flen;
+                if (rng() % 100 < opt.junk)
+                {
+                    for (unsigned j = rng() % 16; j > 0; j--)
+                    {
+                        uint8_t b = static_cast<uint8_t>(rng());
+                        mixed.push_back((b == CMD_HEADER || b == CMD_HEADER_V2) ? 0 : b);
+                    }
+                }
+            }
+            stream.swap(mixed);
+        }
+
+        std::vector<size_t> cuts;
+        for (size_t pos = 0; pos < stream.size();)
+        {
+            size_t c = 1 + rng() % opt.chunk;
+            cuts.push_back(c);
+            pos += c;
+        }
+
+        next = 0;
+        t0 = std::chrono::steady_clock::now();
+        size_t pos = 0;
+        for (size_t c : cuts)
+        {
+            c = std::min(c, stream.size() - pos);
+            dec.feed(&stream[pos], c);
+            pos += c;
+        }
+        t_dec += seconds_since(t0);
+
+        bad += sent.size() - next;  // frames never decoded
+        bytes += stream.size();
+    }
+
+    const PacketParser &p = dec.parser();
+    std::printf("frames=%llu ok=%llu bad=%llu bytes=%llu cap=%u chunk<=%zu junk=%u%%\n",
+            (unsigned long long)opt.frames, (unsigned long long)ok, (unsigned long long)bad,
+            (unsigned long long)bytes, opt.cap, opt.chunk, opt.junk);
+    std::printf("encode: %.2f Mframes/s  parse: %.2f Mframes/s (%.1f MB/s)\n",
+            opt.frames / t_enc / 1e6, opt.frames / t_dec / 1e6, bytes / t_dec / 1e6);
+    std::printf("parser: frames_ok=%u csum_err=%u len_err=%u resync=%u\n",
+            (unsigned)p.frames_ok, (unsigned)p.csum_err, (unsigned)p.len_err, (unsigned)p.resync_count);
+
+    return (bad == 0 && ok == opt.frames) ? 0 : 1;
+}
@@ -0,0 +1,194 @@
+/*
+ * scan_bench.cpp
+ *
+ * Equivalence test and microbench of the parser scan kernels
+ * (Core/Src/pkt_scan.c): header search and the v1 8-bit sum, scalar vs
+ * SWAR (word at a time).
+ *
+ * Equivalence: random buffers, every start alignment, lengths 0..600
+ * (every 64th case up to 5000, several sum blocks),
+ * random / edge-case byte values, against a plain byte loop.
+ * Bench: MB/s over junk without headers (the PKT_WAIT_HEADER worst case)
+ * and over frame-sized checksum spans. On x86-64 glibc memchr() is SIMD,
+ * so the "byte loop" column is the closer model of newlib-nano on the
+ * Cortex-M0+.
+ *
+ *   ./scan_bench [--cases N] [--mb MBYTES]
+ */
+#include "packet_codec.h"
+#include "pkt_scan.h"
+
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+#include "host_args.hpp"
+
+namespace
+{
+
+struct Options
+{
+    uint64_t cases = 2000000;
+    uint64_t mb = 256;      // bytes scanned per bench row
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--cases", o.cases),
+        host_args::opt("--mb", o.mb, 1),
+    });
+    return o;
+}
+
+const uint8_t *find2_ref(const uint8_t *data, size_t len, uint8_t a, uint8_t b)
+{
+    for (size_t i = 0; i < len; i++)
+    {
+        if (data[i] == a || data[i] == b)
+            return &data[i];
+    }
+    return nullptr;
+}
+
+uint8_t sum8_ref(uint8_t init, const uint8_t *data, size_t len)
+{
+    unsigned s = init;
+    for (size_t i = 0; i < len; i++)
+        s += data[i];
+    return static_cast<uint8_t>(s);
+}
+
+/* Byte values that stress the zero-byte test: borrows, high bits */
+const uint8_t kEdge[] = {0x00, 0x01, 0x7F, 0x80, 0x81, 0xFE, 0xFF, CMD_HEADER, CMD_HEADER_V2,
+                         CMD_HEADER ^ 0x80, CMD_HEADER + 1, CMD_HEADER - 1};
+
+int equivalence(uint64_t cases)
+{
+    std::mt19937 rng(12345);
+    std::vector<uint8_t> buf(8 + 5000);
+    uint64_t fail = 0;
+
+    for (uint64_t c = 0; c < cases; c++)
+    {
+        size_t off = rng() % 8;
+        size_t len = (c % 64 == 0) ? rng() % 5000 : rng() % 600;
+        unsigned mode = rng() % 4;
+        uint8_t a = CMD_HEADER, b = CMD_HEADER_V2;
+        if (c & 1)
+        {
+            a = (rng() & 1) ? kEdge[rng() % sizeof(kEdge)] : static_cast<uint8_t>(rng());
+            b = (rng() & 1) ? a : kEdge[rng() % sizeof(kEdge)];
+        }
+
+        uint8_t *p = &buf[off];
+        for (size_t i = 0; i < len; i++)
+        {
+            uint8_t v;
+            switch (mode)
+            {
+            case 0: v = static_cast<uint8_t>(rng()); break;                 // random
+            case 1: v = kEdge[rng() % sizeof(kEdge)]; break;                // edge values
+            case 2: v = (rng() % 512 == 0) ? a : static_cast<uint8_t>(rng() | 1); break;   // sparse hits
+            default: v = 0xFF; break;                                       // lane saturation
+            }
+            // Headers are only searched for, keep the sparse mode sparse
+            if (mode == 2 && v != a && (v == b))
+                v ^= 0x02;
+            p[i] = v;
+        }
+        if (mode == 2 && len > 0 && (rng() & 1))
+            p[len - 1 - rng() % std::min<size_t>(len, 8)] = b;     // hit near the tail
+
+        const uint8_t *ref = find2_ref(p, len, a, b);
+        const uint8_t *sw = pkt_find2_swar(p, len, a, b);
+        const uint8_t *sc = pkt_find2_scalar(p, len, a, b);
+        uint8_t init = static_cast<uint8_t>(rng());
+        uint8_t sref = sum8_ref(init, p, len);
+        uint8_t ssw = pkt_sum8_swar(init, p, len);
+        uint8_t ssc = pkt_sum8_scalar(init, p, len);
+
+        if ((sw != ref) || (sc != ref) || (ssw != sref) || (ssc != sref))
+        {
+            if (fail++ < 5)
+                std::printf("  mismatch: off=%zu len=%zu mode=%u a=%02X b=%02X find ref=%td swar=%td scalar=%td "
+                        "sum ref=%02X swar=%02X scalar=%02X\n", off, len, mode, a, b,
+                        ref ? ref - p : -1, sw ? sw - p : -1, sc ? sc - p : -1, sref, ssw, ssc);
+        }
+    }
+
+    std::printf("equivalence: %llu cases, %llu mismatches\n",
+            (unsigned long long)cases, (unsigned long long)fail);
+    return fail ? 1 : 0;
+}
+
+template <typename F>
+double bench_mbs(uint64_t total, size_t span, F &&f)
+{
+    uint64_t iters = total / span;
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < iters; i++)
+        f(i);
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return iters * span / t / 1e6;
+}
+
+volatile uintptr_t g_sink;
+
+void bench(uint64_t mb)
+{
+    const uint64_t total = mb << 20;
+    std::mt19937 rng(7);
+    std::vector<uint8_t> junk(4096 + 8);
+    for (uint8_t &v : junk)
+    {
+        v = static_cast<uint8_t>(rng());
+        if (v == CMD_HEADER || v == CMD_HEADER_V2)
+            v = 0x55;
+    }
+
+    std::printf("\nheader search over junk (MB/s)\n");
+    std::printf("%-8s %10s %10s %10s\n", "span", "byte loop", "memchr x2", "swar");
+    for (size_t span : {16, 64, 4096})
+    {
+        const uint8_t *p = &junk[1];    // unaligned start
+        double loop = bench_mbs(total, span, [&](uint64_t) {
+            g_sink = (uintptr_t)find2_ref(p, span, CMD_HEADER, CMD_HEADER_V2);
+        });
+        double sc = bench_mbs(total, span, [&](uint64_t) {
+            g_sink = (uintptr_t)pkt_find2_scalar(p, span, CMD_HEADER, CMD_HEADER_V2);
+        });
+        double sw = bench_mbs(total, span, [&](uint64_t) {
+            g_sink = (uintptr_t)pkt_find2_swar(p, span, CMD_HEADER, CMD_HEADER_V2);
+        });
+        std::printf("%-8zu %10.0f %10.0f %10.0f\n", span, loop, sc, sw);
+    }
+
+    std::printf("\nsum8 (MB/s)\n");
+    std::printf("%-8s %10s %10s\n", "span", "scalar", "swar");
+    for (size_t span : {8, 64, 134, 4096})
+    {
+        const uint8_t *p = &junk[1];
+        double sc = bench_mbs(total, span, [&](uint64_t i) {
+            g_sink = pkt_sum8_scalar(static_cast<uint8_t>(i), p, span);
+        });
+        double sw = bench_mbs(total, span, [&](uint64_t i) {
+            g_sink = pkt_sum8_swar(static_cast<uint8_t>(i), p, span);
+        });
+        std::printf("%-8zu %10.0f %10.0f\n", span, sc, sw);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const Options opt = parse_args(argc, argv);
+    std::printf("PKT_USE_SWAR=%d\n", PKT_USE_SWAR);
+    int rc = equivalence(opt.cases);
+    bench(opt.mb);
+    return rc;
+}
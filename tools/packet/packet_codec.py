@@ -0,0 +1,259 @@
+"""Python binding of the firmware packet codec (Core/Src/packet_codec.c).
+
+Loads the host build from tools/packet/host (make -C tools/packet/host)
+through ctypes, so frames are built and parsed by exactly the firmware
+code. A pure-Python reference encoder (encode_v1_ref / encode_v2_ref,
+written from the format description in packet_codec.h) is kept for
+cross-checking.
+
+Examples:
+    python tools/packet/packet_codec.py encode 0x01 "10 20"
+    python tools/packet/packet_codec.py encode --v2 --seq 7 0x01 "10 20"
+    python tools/packet/packet_codec.py check --frames 100000
+    python tools/packet/packet_codec.py bench --frames 200000
+"""
+
+import argparse
+import ctypes
+import os
+import random
+import sys
+import time
+from pathlib import Path
+
+CMD_HEADER = 0xAA
+CMD_HEADER_V2 = 0xA5
+PKT_V1_OVERHEAD = 3
+PKT_V2_OVERHEAD = 6
+PKT_PARSER_BUF_SIZE = 64
+
+_HOST_DIR = Path(__file__).resolve().parent / "host"
+_LIB_NAMES = ["libpacket_host.so", "packet_host.dll", "libpacket_host.dylib"]
+
+
+def _load_lib():
+    override = os.environ.get("PACKET_HOST_LIB")
+    candidates = [Path(override)] if override else [_HOST_DIR / n for n in _LIB_NAMES]
+    for path in candidates:
+        if path.exists():
+            lib = ctypes.CDLL(str(path))
+            break
+    else:
+        raise OSError(f"packet host library not found in {_HOST_DIR}; run: make -C tools/packet/host")
+
+    u8p = ctypes.POINTER(ctypes.c_uint8)
+    lib.pkt_encode_v1.argtypes = [u8p, ctypes.c_size_t, ctypes.c_uint8, u8p, ctypes.c_size_t]
+    lib.pkt_encode_v2.argtypes = [u8p, ctypes.c_size_t, ctypes.c_uint8, ctypes.c_uint8, u8p, ctypes.c_size_t]
+    lib.pkt_parse.argtypes = [u8p, ctypes.c_size_t]
+    lib.pkt_decoder_new.argtypes = [ctypes.c_uint16, ctypes.c_int]
+    lib.pkt_decoder_new.restype = ctypes.c_void_p
+    lib.pkt_decoder_free.argtypes = [ctypes.c_void_p]
+    lib.pkt_decoder_feed.argtypes = [ctypes.c_void_p, u8p, ctypes.c_size_t]
+    lib.pkt_decoder_next.argtypes = [ctypes.c_void_p, u8p, ctypes.c_size_t, u8p, u8p]
+    lib.pkt_decoder_stats.argtypes = [ctypes.c_void_p, ctypes.POINTER(ctypes.c_uint32)]
+    return lib
+
+
+_lib = None
+
+
+def lib():
+    global _lib
+    if _lib is None:
+        _lib = _load_lib()
+    return _lib
+
+
+def _u8(buf):
+    return ctypes.cast(buf, ctypes.POINTER(ctypes.c_uint8))
+
+
+# ---------- firmware codec ----------
+def encode_v1(cmd, params=b""):
+    """v1 frame (build_packet); params up to 251 bytes."""
+    out = (ctypes.c_uint8 * (len(params) + 1 + PKT_V1_OVERHEAD))()
+    n = lib().pkt_encode_v1(out, len(out), cmd, _u8(ctypes.c_char_p(bytes(params))), len(params))
+    if n < 0:
+        raise ValueError("v1 payload too long")
+    return bytes(out[:n])
+
+
+def encode_v2(seq, cmd, params=b""):
+    """v2 frame (build_packet_v2)."""
+    out = (ctypes.c_uint8 * (len(params) + 1 + PKT_V2_OVERHEAD))()
+    n = lib().pkt_encode_v2(out, len(out), seq, cmd, _u8(ctypes.c_char_p(bytes(params))), len(params))
+    if n < 0:
+        raise ValueError("v2 payload too long")
+    return bytes(out[:n])
+
+
+def parse(frame):
+    """parse_packet(): 0 valid, -1 too short, -2 bad header, -3 length, -4 checksum/CRC."""
+    buf = (ctypes.c_uint8 * len(frame)).from_buffer_copy(frame)
+    return lib().pkt_parse(buf, len(frame))
+
+
+class Decoder:
+    """Firmware streaming PacketParser with cap bytes of frame storage."""
+
+    def __init__(self, cap=PKT_PARSER_BUF_SIZE, resync=True):
+        self._d = lib().pkt_decoder_new(cap, 1 if resync else 0)
+        self._out = (ctypes.c_uint8 * cap)()
+
+    def close(self):
+        if self._d:
+            lib().pkt_decoder_free(self._d)
+            self._d = None
+
+    def __del__(self):
+        self.close()
+
+    def feed(self, data):
+        """Yield (version, seq, cmd_and_payload) for each frame completed by data."""
+        data = bytes(data)
+        lib().pkt_decoder_feed(self._d, _u8(ctypes.c_char_p(data)), len(data))
+        version = ctypes.c_uint8()
+        seq = ctypes.c_uint8()
+        while True:
+            n = lib().pkt_decoder_next(self._d, self._out, len(self._out), ctypes.byref(version), ctypes.byref(seq))
+            if n < 0:
+                return
+            yield version.value, seq.value, bytes(self._out[:n])
+
+    def stats(self):
+        raw = (ctypes.c_uint32 * 6)()
+        lib().pkt_decoder_stats(self._d, raw)
+        keys = ["resync", "dropped_bytes", "recovered", "frames_ok", "csum_err", "len_err"]
+        return dict(zip(keys, raw))
+
+
+# ---------- pure-Python reference ----------
+def crc16_ccitt(data, crc=0xFFFF):
+    for b in data:
+        crc ^= b << 8
+        for _ in range(8):
+            crc = ((crc << 1) ^ 0x1021) & 0xFFFF if crc & 0x8000 else (crc << 1) & 0xFFFF
+    return crc
+
+
+def encode_v1_ref(cmd, params=b""):
+    body = bytes([CMD_HEADER, 1 + len(params), cmd]) + bytes(params)
+    return body + bytes([sum(body) & 0xFF])
+
+
+def encode_v2_ref(seq, cmd, params=b""):
+    n = 1 + len(params)
+    body = bytes([CMD_HEADER_V2, n & 0xFF, n >> 8, seq, cmd]) + bytes(params)
+    crc = crc16_ccitt(body)
+    return body + bytes([crc & 0xFF, crc >> 8])
+
+
+def pack_batch(payloads):
+    """Arguments of a BATCH command: each CMD + ARGS payload prefixed with
+    its length (packet_batch_append())."""
+    out = bytearray()
+    for p in payloads:
+        if not 1 <= len(p) <= 0xFF:
+            raise ValueError("sub-command length must be 1..255")
+        out.append(len(p))
+        out += p
+    return bytes(out)
+
+
+def _random_frames(count, rng, cap):
+    for _ in range(count):
+        v2 = rng.random() < 0.5
+        limit = cap - (PKT_V2_OVERHEAD if v2 else PKT_V1_OVERHEAD)
+        if not v2:
+            limit = min(limit, 252)     # build_packet() frame length is 8-bit
+        payload = bytes(rng.getrandbits(8) for _ in range(rng.randint(1, limit)))
+        seq = rng.getrandbits(8) if v2 else 0
+        yield (2 if v2 else 1), seq, payload
+
+
+def cross_check(count, seed=1, cap=PKT_PARSER_BUF_SIZE):
+    """Firmware encoder vs reference, then stream round trip. Returns mismatches."""
+    rng = random.Random(seed)
+    bad = 0
+    sent = []
+    stream = bytearray()
+    for version, seq, payload in _random_frames(count, rng, cap):
+        if version == 2:
+            fw, ref = encode_v2(seq, payload[0], payload[1:]), encode_v2_ref(seq, payload[0], payload[1:])
+        else:
+            fw, ref = encode_v1(payload[0], payload[1:]), encode_v1_ref(payload[0], payload[1:])
+        if fw != ref or parse(fw) != 0:
+            bad += 1
+        sent.append((version, seq, payload))
+        stream += fw
+
+    dec = Decoder(cap)
+    got = []
+    pos = 0
+    while pos < len(stream):
+        step = rng.randint(1, 64)
+        got.extend(dec.feed(stream[pos:pos + step]))
+        pos += step
+    bad += sum(1 for a, b in zip(sent, got) if a != b) + abs(len(sent) - len(got))
+    return bad
+
+
+def bench(count, seed=1, cap=PKT_PARSER_BUF_SIZE):
+    rng = random.Random(seed)
+    frames = list(_random_frames(count, rng, cap))
+
+    t0 = time.perf_counter()
+    wire = b"".join(
+        encode_v2(s, p[0], p[1:]) if v == 2 else encode_v1(p[0], p[1:]) for v, s, p in frames
+    )
+    t_enc = time.perf_counter() - t0
+
+    dec = Decoder(cap)
+    t0 = time.perf_counter()
+    n = sum(1 for _ in dec.feed(wire))
+    t_dec = time.perf_counter() - t0
+
+    print(f"frames={count} decoded={n} bytes={len(wire)}")
+    print(f"encode (ctypes per frame): {count / t_enc:,.0f} frames/s")
+    print(f"decode (one feed):         {count / t_dec:,.0f} frames/s")
+
+
+def _parse_hex(text):
+    return bytes(int(tok, 16) for tok in text.replace(",", " ").split())
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Firmware packet codec (host build)")
+    sub = parser.add_subparsers(dest="op", required=True)
+
+    enc = sub.add_parser("encode", help="build a frame")
+    enc.add_argument("cmd", type=lambda s: int(s, 0))
+    enc.add_argument("params", nargs="?", default="", help='hex bytes, e.g. "10 20"')
+    enc.add_argument("--v2", action="store_true")
+    enc.add_argument("--seq", type=int, default=0)
+
+    for name in ("check", "bench"):
+        p = sub.add_parser(name)
+        p.add_argument("--frames", type=int, default=100000)
+        p.add_argument("--seed", type=int, default=1)
+        p.add_argument("--cap", type=int, default=PKT_PARSER_BUF_SIZE)
+
+    args = parser.parse_args()
+
+    if args.op == "encode":
+        params = _parse_hex(args.params)
+        frame = encode_v2(args.seq, args.cmd, params) if args.v2 else encode_v1(args.cmd, params)
+        print(" ".join(f"{b:02X}" for b in frame))
+        return 0
+
+    if args.op == "check":
+        bad = cross_check(args.frames, args.seed, args.cap)
+        print(f"frames={args.frames} mismatches={bad}")
+        return 1 if bad else 0
+
+    bench(args.frames, args.seed, args.cap)
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
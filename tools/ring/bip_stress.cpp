@@ -0,0 +1,166 @@
+/*
+ * bip_stress.cpp
+ *
+ * Host stress test of the SPSC bip-buffer (Core/Inc/bipbuf.h).
+ *
+ * A producer thread and a consumer thread move a known byte sequence
+ * through bip-buffers of several capacities. The producer mixes
+ * bipbuf_reserve() / bipbuf_commit() (committing a random part of the
+ * reservation) with bipbuf_write(); the consumer peeks a region and
+ * releases a random part of it. Checked: every byte, that reservations and
+ * peeked regions stay inside the storage, the fill level, and that the
+ * bytes bipbuf_write() did not store match bipbuf's dropped count.
+ *
+ *   ./bip_stress [--mb MBYTES] [--seed S]
+ */
+#include "bipbuf.h"
+
+#include <atomic>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "host_args.hpp"
+
+namespace
+{
+
+struct Options
+{
+    uint64_t mb = 16;       // bytes moved per size
+    uint32_t seed = 1;
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--mb", o.mb, 1),
+        host_args::opt("--seed", o.seed),
+    });
+    return o;
+}
+
+/* Byte i of the stream, as in rb_stress */
+inline uint8_t seq_byte(uint64_t i)
+{
+    return static_cast<uint8_t>((i * 0x9E3779B1U) >> 13 ^ (i >> 8));
+}
+
+int stress(uint16_t size, uint64_t total, uint32_t seed)
+{
+    std::vector<uint8_t> storage(size);
+    BipBuf bip;
+    if (bipbuf_init(&bip, storage.data(), size) != 0)
+    {
+        std::fprintf(stderr, "bipbuf_init(%u) failed\n", size);
+        return 1;
+    }
+
+    const uint8_t *lo = storage.data();
+    const uint8_t *hi = lo + size;
+    std::atomic<uint64_t> bad{0};
+    uint64_t refused = 0, reserve_fail = 0;
+    const unsigned max_chunk = size + size / 2U + 1U;
+
+    std::thread producer([&] {
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> chunk(max_chunk);
+        uint64_t i = 0;
+        while (i < total)
+        {
+            unsigned n = 1 + rng() % max_chunk;
+            if (n > total - i)
+                n = static_cast<unsigned>(total - i);
+
+            if (rng() & 1U)
+            {
+                uint8_t *p = bipbuf_reserve(&bip, static_cast<uint16_t>(n));
+                if (p == nullptr)
+                {
+                    reserve_fail++;
+                    std::this_thread::yield();
+                    continue;
+                }
+                if ((p < lo) || (p + n > hi))
+                    bad++;
+                unsigned c = 1 + rng() % n;     // commit part of it
+                for (unsigned k = 0; k < c; k++)
+                    p[k] = seq_byte(i + k);
+                bipbuf_commit(&bip, static_cast<uint16_t>(c));
+                i += c;
+            }
+            else
+            {
+                for (unsigned k = 0; k < n; k++)
+                    chunk[k] = seq_byte(i + k);
+                uint16_t w = bipbuf_write(&bip, chunk.data(), static_cast<uint16_t>(n));
+                refused += n - w;
+                i += w;
+                if (w < n)
+                    std::this_thread::yield();
+            }
+        }
+    });
+
+    std::thread consumer([&] {
+        std::mt19937 rng(seed ^ 0x5A5A5A5AU);
+        uint64_t i = 0;
+        while (i < total)
+        {
+            if (bipbuf_used(&bip) > size)
+                bad++;
+
+            uint16_t len;
+            const uint8_t *d = bipbuf_peek(&bip, &len);
+            if (d == nullptr)
+            {
+                std::this_thread::yield();
+                continue;
+            }
+            if ((d < lo) || (d + len > hi))
+                bad++;
+            uint16_t n = static_cast<uint16_t>(1 + rng() % len);
+            for (uint16_t k = 0; k < n; k++)
+            {
+                if (d[k] != seq_byte(i + k))
+                    bad++;
+            }
+            bipbuf_release(&bip, n);
+            i += n;
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    bool ok = (bad == 0) && (bip.dropped == refused) && (bipbuf_used(&bip) == 0);
+    std::printf("  size %5u: %llu B, refused %llu B (dropped %lu), reserve NULL %llu, errors %llu  %s\n",
+            size, (unsigned long long)total, (unsigned long long)refused,
+            (unsigned long)bip.dropped, (unsigned long long)reserve_fail,
+            (unsigned long long)bad.load(), ok ? "OK" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    Options opt = parse_args(argc, argv);
+    uint64_t total = opt.mb << 20;
+    int rc = 0;
+
+    BipBuf b;
+    uint8_t one;
+    if (bipbuf_init(&b, &one, 1) != -1)
+    {
+        std::printf("bipbuf_init() accepted size 1  FAIL\n");
+        rc = 1;
+    }
+
+    std::printf("stress (%llu MB per size):\n", (unsigned long long)opt.mb);
+    for (uint16_t size : {2, 7, 128, 4096})
+        rc |= stress(size, total, opt.seed);
+    return rc;
+}
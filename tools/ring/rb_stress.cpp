@@ -0,0 +1,256 @@
+/*
+ * rb_stress.cpp
+ *
+ * Host stress test and throughput bench of the SPSC byte ring
+ * (Core/Inc/uart_rb.h: SPSC ring of uint8_t, SPSC_RING_REJECT_NEWEST).
+ *
+ * Stress: a producer thread and a consumer thread move a known byte
+ * sequence through rings of several capacities with random chunk sizes,
+ * mixing rb_push()/rb_write() and rb_pop()/rb_read(). The consumer checks
+ * every byte and the fill level; the producer counts the bytes a full ring
+ * refused and retries them, which must match rb_dropped() at the end.
+ * Bench: two-thread MB/s per chunk size, and the single-thread cost of a
+ * write + read round trip (no cross-core traffic, closer to ISR -> task).
+ *
+ *   ./rb_stress [--mb MBYTES] [--seed S]
+ */
+#include "uart_rb.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "host_args.hpp"
+
+namespace
+{
+
+struct Options
+{
+    uint64_t mb = 64;       // bytes moved per stress / bench run
+    uint32_t seed = 1;
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--mb", o.mb, 1),
+        host_args::opt("--seed", o.seed),
+    });
+    return o;
+}
+
+/* Byte i of the stream: not periodic in any power of two ring size */
+inline uint8_t seq_byte(uint64_t i)
+{
+    return static_cast<uint8_t>((i * 0x9E3779B1U) >> 13 ^ (i >> 8));
+}
+
+struct Ring
+{
+    RingBuffer rb;
+    std::vector<uint8_t> storage;
+
+    explicit Ring(uint16_t size) : storage(size)
+    {
+        if (rb_init(&rb, storage.data(), size, SPSC_RING_REJECT_NEWEST) != 0)
+        {
+            std::fprintf(stderr, "rb_init(%u) failed\n", size);
+            std::exit(2);
+        }
+    }
+};
+
+/* ---------- stress ---------- */
+int stress(uint16_t size, uint64_t total, uint32_t seed)
+{
+    Ring ring(size);
+    RingBuffer *rb = &ring.rb;
+    std::atomic<uint64_t> bad{0};
+    uint64_t refused = 0, partial = 0;
+    const unsigned max_chunk = 2U * size + 3U;
+
+    std::thread producer([&] {
+        std::mt19937 rng(seed);
+        std::vector<uint8_t> chunk(max_chunk);
+        uint64_t i = 0;
+        while (i < total)
+        {
+            unsigned n = 1 + rng() % max_chunk;
+            if (n > total - i)
+                n = static_cast<unsigned>(total - i);
+
+            if (n == 1)
+            {
+                uint8_t b = seq_byte(i);
+                if (rb_push(rb, &b))
+                    i++;
+                else
+                    refused++;
+            }
+            else
+            {
+                for (unsigned k = 0; k < n; k++)
+                    chunk[k] = seq_byte(i + k);
+                uint16_t w = rb_write(rb, chunk.data(), static_cast<uint16_t>(n));
+                refused += n - w;
+                partial += (w != 0 && w < n);
+                i += w;
+            }
+            if (rb_full(rb))
+                std::this_thread::yield();
+        }
+    });
+
+    std::thread consumer([&] {
+        std::mt19937 rng(seed ^ 0x5A5A5A5AU);
+        std::vector<uint8_t> chunk(max_chunk);
+        uint64_t i = 0;
+        while (i < total)
+        {
+            uint16_t used = rb_used(rb);
+            if (used > size)
+                bad++;
+
+            unsigned n = 1 + rng() % max_chunk;
+            uint16_t r;
+            if (n == 1)
+                r = static_cast<uint16_t>(rb_pop(rb, chunk.data()));
+            else
+                r = rb_read(rb, chunk.data(), static_cast<uint16_t>(n));
+
+            for (uint16_t k = 0; k < r; k++)
+            {
+                if (chunk[k] != seq_byte(i + k))
+                    bad++;
+            }
+            i += r;
+            if (r == 0)
+                std::this_thread::yield();
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    bool ok = (bad == 0) && (rb_dropped(rb) == refused) && (rb_used(rb) == 0);
+    std::printf("  size %5u: %llu B, refused %llu B (overrun %lu), partial writes %llu, errors %llu  %s\n",
+            size, (unsigned long long)total, (unsigned long long)refused,
+            (unsigned long)rb_dropped(rb), (unsigned long long)partial,
+            (unsigned long long)bad.load(), ok ? "OK" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+/* ---------- bench ---------- */
+double two_thread_mbs(uint16_t size, unsigned chunk, uint64_t total)
+{
+    Ring ring(size);
+    RingBuffer *rb = &ring.rb;
+
+    auto t0 = std::chrono::steady_clock::now();
+    std::thread producer([&] {
+        std::vector<uint8_t> buf(chunk, 0x55);
+        for (uint64_t i = 0; i < total;)
+        {
+            uint16_t w = (chunk == 1) ? static_cast<uint16_t>(rb_push(rb, &buf[0]))
+                    : rb_write(rb, buf.data(), static_cast<uint16_t>(chunk));
+            i += w;
+            if (w == 0)
+                std::this_thread::yield();
+        }
+    });
+    std::vector<uint8_t> buf(chunk);
+    for (uint64_t i = 0; i < total;)
+    {
+        uint16_t r = (chunk == 1) ? static_cast<uint16_t>(rb_pop(rb, buf.data()))
+                : rb_read(rb, buf.data(), static_cast<uint16_t>(chunk));
+        i += r;
+        if (r == 0)
+            std::this_thread::yield();
+    }
+    producer.join();
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return total / t / 1e6;
+}
+
+/* ns per byte of a rb_write() + rb_read() round trip of chunk bytes */
+double round_trip_ns(uint16_t size, unsigned chunk, uint64_t total)
+{
+    Ring ring(size);
+    RingBuffer *rb = &ring.rb;
+    std::vector<uint8_t> in(chunk, 0x55), out(chunk);
+    volatile uint8_t sink = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < total; i += chunk)
+    {
+        rb_write(rb, in.data(), static_cast<uint16_t>(chunk));
+        rb_read(rb, out.data(), static_cast<uint16_t>(chunk));
+        sink = out[0];
+    }
+    (void)sink;
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return t * 1e9 / total;
+}
+
+/* Byte-at-a-time copy through rb_push/rb_pop, as the RX path did before
+ * rb_write/rb_read: same chunk, one call per byte */
+double per_byte_ns(uint16_t size, unsigned chunk, uint64_t total)
+{
+    Ring ring(size);
+    RingBuffer *rb = &ring.rb;
+    std::vector<uint8_t> in(chunk, 0x55), out(chunk);
+    volatile uint8_t sink = 0;
+
+    auto t0 = std::chrono::steady_clock::now();
+    for (uint64_t i = 0; i < total; i += chunk)
+    {
+        for (unsigned k = 0; k < chunk; k++)
+            rb_push(rb, &in[k]);
+        for (unsigned k = 0; k < chunk; k++)
+            rb_pop(rb, &out[k]);
+        sink = out[0];
+    }
+    (void)sink;
+    double t = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return t * 1e9 / total;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const Options opt = parse_args(argc, argv);
+    const uint64_t total = opt.mb << 20;
+    int rc = 0;
+
+    std::printf("stress: 2 threads, %u hardware threads\n", std::thread::hardware_concurrency());
+    for (uint16_t size : {2, 16, 128, 4096})
+        rc |= stress(size, (size < 128) ? total / 8 : total, opt.seed);
+
+    RingBuffer rb;
+    uint8_t odd[100];
+    if ((rb_init(&rb, odd, 100, SPSC_RING_REJECT_NEWEST) != -1)
+            || (rb_init(&rb, odd, 0, SPSC_RING_REJECT_NEWEST) != -1))
+    {
+        std::printf("rb_init accepted a size that is not a power of two\n");
+        rc = 1;
+    }
+
+    std::printf("\ntwo threads (MB/s)\n%-6s %10s %10s\n", "chunk", "size 128", "size 4096");
+    for (unsigned chunk : {1, 16, 64})
+        std::printf("%-6u %10.1f %10.1f\n", chunk, two_thread_mbs(128, chunk, total / 4),
+                two_thread_mbs(4096, chunk, total / 4));
+
+    std::printf("\nsingle thread, write + read round trip (ns/byte, size 128)\n");
+    std::printf("%-6s %12s %12s\n", "chunk", "per byte", "rb_write/read");
+    for (unsigned chunk : {16, 32, 64})
+        std::printf("%-6u %12.2f %12.2f\n", chunk, per_byte_ns(128, chunk, total),
+                round_trip_ns(128, chunk, total));
+    return rc;
+}
@@ -0,0 +1,331 @@
+/*
+ * ring_bench.cpp
+ *
+ * Stress test and cost bench of the typed SPSC ring (Core/Inc/spsc_ring.h)
+ * with a 16-byte element shaped like LatencySample, for both full-ring
+ * policies.
+ *
+ * Stress (producer and consumer threads, random batch sizes):
+ *   REJECT_NEWEST  producer retries refused elements; the consumer must
+ *                  see every sequence number in order and dropped() must
+ *                  equal the refusals.
+ *   DROP_OLDEST    producer never waits; the consumer must only see
+ *                  intact elements (no half-overwritten copy) in
+ *                  increasing order, and received + dropped() == pushed.
+ *   Both: the high watermark stays within the size and overflows are
+ *   counted exactly when elements were lost (SPSC_RING_STATS).
+ * Bench (one thread, the ISR -> task pattern on a single core):
+ *   push cost per element (ring not full / full), drain cost per element
+ *   for pop() vs read() batches of 8 and 32, and the previous latency.c
+ *   ring (modulo indexing, volatile slots) for reference.
+ *
+ *   ./ring_bench [--elems N] [--seed S]
+ */
+#include "spsc_ring.h"
+
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <random>
+#include <thread>
+#include <vector>
+
+#include "host_args.hpp"
+
+namespace
+{
+
+struct Sample
+{
+    uint32_t seq;
+    uint32_t inv;       // ~seq
+    uint32_t mix;       // seq * golden ratio
+    uint32_t chk;       // inv ^ mix
+};
+
+Sample make_sample(uint32_t seq)
+{
+    Sample s;
+    s.seq = seq;
+    s.inv = ~seq;
+    s.mix = seq * 0x9E3779B1U;
+    s.chk = s.inv ^ s.mix;
+    return s;
+}
+
+bool intact(const Sample &s)
+{
+    return (s.inv == ~s.seq) && (s.mix == s.seq * 0x9E3779B1U) && (s.chk == (s.inv ^ s.mix));
+}
+
+SPSC_RING_DEFINE(SampleRing, sample_ring, Sample)
+
+struct Options
+{
+    uint64_t elems = 20000000;
+    uint32_t seed = 1;
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--elems", o.elems, 1),
+        host_args::opt("--seed", o.seed),
+    });
+    return o;
+}
+
+const char *policy_name(uint8_t policy)
+{
+    return (policy == SPSC_RING_DROP_OLDEST) ? "drop-oldest" : "reject-newest";
+}
+
+/* ---------- stress ---------- */
+int stress(uint8_t policy, uint16_t size, uint64_t total, uint32_t seed)
+{
+    std::vector<Sample> slots(size);
+    SampleRing q;
+    sample_ring_init(&q, slots.data(), size, policy);
+
+    std::atomic<bool> done{false};
+    uint64_t refused = 0;
+    uint64_t received = 0, torn = 0, order = 0;
+
+    std::thread producer([&] {
+        std::mt19937 rng(seed);
+        std::vector<Sample> batch(2U * size + 1U);
+        uint64_t i = 0;
+        while (i < total)
+        {
+            unsigned n = 1 + rng() % batch.size();
+            if (n > total - i)
+                n = static_cast<unsigned>(total - i);
+            for (unsigned k = 0; k < n; k++)
+                batch[k] = make_sample(static_cast<uint32_t>(i + k));
+
+            uint16_t w = (n == 1) ? static_cast<uint16_t>(sample_ring_push(&q, batch.data()))
+                    : sample_ring_write(&q, batch.data(), static_cast<uint16_t>(n));
+            refused += n - w;
+            i += w;
+            if ((w < n) || (rng() % 64 == 0))
+                std::this_thread::yield();
+        }
+        done = true;
+    });
+
+    std::thread consumer([&] {
+        std::mt19937 rng(seed ^ 0xA5A5A5A5U);
+        std::vector<Sample> batch(size + 3U);
+        int64_t last = -1;
+        for (;;)
+        {
+            bool fin = done;    // read before the ring: nothing is pushed after
+            unsigned n = 1 + rng() % batch.size();
+            sample_ring_sample(&q);
+            uint16_t r = (n == 1) ? static_cast<uint16_t>(sample_ring_pop(&q, batch.data()))
+                    : sample_ring_read(&q, batch.data(), static_cast<uint16_t>(n));
+            for (uint16_t k = 0; k < r; k++)
+            {
+                const Sample &s = batch[k];
+                if (!intact(s))
+                    torn++;
+                if ((int64_t)s.seq <= last)
+                    order++;
+                if ((policy == SPSC_RING_REJECT_NEWEST) && ((int64_t)s.seq != last + 1))
+                    order++;
+                last = s.seq;
+            }
+            received += r;
+            if (r == 0)
+            {
+                if (fin)
+                    break;
+                std::this_thread::yield();
+            }
+        }
+    });
+
+    producer.join();
+    consumer.join();
+
+    uint32_t dropped = sample_ring_dropped(&q);
+    bool ok = (torn == 0) && (order == 0);
+#if (SPSC_RING_STATS != 0)
+    // Every refusal / overwrite came from a push that found the ring full
+    const SpscRingStats &st = q.ring.stats;
+    ok = ok && (st.high_water <= size) && ((dropped != 0) == (st.overflows != 0));
+#endif
+    if (policy == SPSC_RING_REJECT_NEWEST)
+        ok = ok && (received == total) && (dropped == refused);
+    else
+        ok = ok && (received + dropped == total) && (refused == 0);
+
+    std::printf("  %-13s size %4u: pushed %llu, received %llu, dropped %lu, torn %llu, order %llu  %s\n",
+            policy_name(policy), size, (unsigned long long)total, (unsigned long long)received,
+            (unsigned long)dropped, (unsigned long long)torn, (unsigned long long)order,
+            ok ? "OK" : "FAIL");
+    return ok ? 0 : 1;
+}
+
+/* ---------- previous latency.c ring, for reference ---------- */
+constexpr uint16_t kLegacySize = 512;
+volatile Sample g_legacy[kLegacySize];
+volatile uint16_t g_legacy_head, g_legacy_tail;
+volatile uint32_t g_legacy_overwrite;
+
+void legacy_push(const Sample *s)
+{
+    uint16_t next = (uint16_t)((g_legacy_head + 1U) % kLegacySize);
+    if (next == g_legacy_tail)
+    {
+        g_legacy_tail = (uint16_t)((g_legacy_tail + 1U) % kLegacySize);
+        g_legacy_overwrite++;
+    }
+    g_legacy[g_legacy_head].seq = s->seq;
+    g_legacy[g_legacy_head].inv = s->inv;
+    g_legacy[g_legacy_head].mix = s->mix;
+    g_legacy[g_legacy_head].chk = s->chk;
+    g_legacy_head = next;
+}
+
+int legacy_pop(Sample *s)
+{
+    // __disable_irq() / __enable_irq() on target
+    if (g_legacy_head == g_legacy_tail)
+        return 0;
+    s->seq = g_legacy[g_legacy_tail].seq;
+    s->inv = g_legacy[g_legacy_tail].inv;
+    s->mix = g_legacy[g_legacy_tail].mix;
+    s->chk = g_legacy[g_legacy_tail].chk;
+    g_legacy_tail = (uint16_t)((g_legacy_tail + 1U) % kLegacySize);
+    return 1;
+}
+
+/* ---------- bench ---------- */
+volatile uint32_t g_sink;
+
+double elapsed_ns(std::chrono::steady_clock::time_point t0)
+{
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+}
+
+/* push cost: fill half the ring, drain it (untimed), repeat */
+double bench_push(SampleRing *q, uint64_t elems, bool full)
+{
+    const uint16_t size = q->ring.size;
+    std::vector<Sample> out(size);
+    Sample s = make_sample(1);
+    double ns = 0;
+    uint64_t ops = 0;
+
+    if (full)
+    {
+        for (uint16_t i = 0; i < size; i++)
+            sample_ring_push(q, &s);
+    }
+    while (ops < elems)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        for (uint16_t i = 0; i < size / 2; i++)
+        {
+            s.seq = i;
+            sample_ring_push(q, &s);
+        }
+        ns += elapsed_ns(t0);
+        ops += size / 2;
+        if (!full)
+            while (sample_ring_read(q, out.data(), size) != 0) {}
+    }
+    while (sample_ring_read(q, out.data(), size) != 0) {}
+    return ns / ops;
+}
+
+/* drain cost: fill the ring (untimed), pop it with batches of `batch` */
+double bench_drain(SampleRing *q, uint64_t elems, uint16_t batch)
+{
+    const uint16_t size = q->ring.size;
+    std::vector<Sample> out(batch);
+    Sample s = make_sample(1);
+    double ns = 0;
+    uint64_t ops = 0;
+
+    while (ops < elems)
+    {
+        for (uint16_t i = 0; i < size; i++)
+            sample_ring_push(q, &s);
+        auto t0 = std::chrono::steady_clock::now();
+        uint16_t n;
+        if (batch == 1)
+        {
+            while (sample_ring_pop(q, out.data()) != 0)
+                g_sink = out[0].seq;
+        }
+        else
+        {
+            while ((n = sample_ring_read(q, out.data(), batch)) != 0)
+                g_sink = out[n - 1].seq;
+        }
+        ns += elapsed_ns(t0);
+        ops += size;
+    }
+    return ns / ops;
+}
+
+void bench_legacy(uint64_t elems, double *push_ns, double *pop_ns)
+{
+    Sample s = make_sample(1), o;
+    double pn = 0, dn = 0;
+    uint64_t ops = 0;
+    while (ops < elems)
+    {
+        auto t0 = std::chrono::steady_clock::now();
+        for (uint16_t i = 0; i < kLegacySize - 1; i++)
+            legacy_push(&s);
+        pn += elapsed_ns(t0);
+        t0 = std::chrono::steady_clock::now();
+        while (legacy_pop(&o) != 0)
+            g_sink = o.seq;
+        dn += elapsed_ns(t0);
+        ops += kLegacySize - 1;
+    }
+    *push_ns = pn / ops;
+    *pop_ns = dn / ops;
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    const Options opt = parse_args(argc, argv);
+    int rc = 0;
+
+    std::printf("stress: 2 threads, %u hardware threads, %zu-byte elements\n",
+            std::thread::hardware_concurrency(), sizeof(Sample));
+    for (uint8_t policy : {SPSC_RING_REJECT_NEWEST, SPSC_RING_DROP_OLDEST})
+    {
+        for (uint16_t size : {1, 4, 64, 512})
+            rc |= stress(policy, size, opt.elems / 4, opt.seed + size);
+    }
+
+    std::printf("\ncost per element (host ns), ring of 512\n");
+    std::printf("%-14s %8s %8s %8s %8s %8s\n", "policy", "push", "push full", "pop", "read 8", "read 32");
+    for (uint8_t policy : {SPSC_RING_REJECT_NEWEST, SPSC_RING_DROP_OLDEST})
+    {
+        std::vector<Sample> slots(512);
+        SampleRing q;
+        sample_ring_init(&q, slots.data(), 512, policy);
+        double push = bench_push(&q, opt.elems, false);
+        double push_full = bench_push(&q, opt.elems, true);
+        double pop = bench_drain(&q, opt.elems, 1);
+        double r8 = bench_drain(&q, opt.elems, 8);
+        double r32 = bench_drain(&q, opt.elems, 32);
+        std::printf("%-14s %8.2f %8.2f %8.2f %8.2f %8.2f\n", policy_name(policy),
+                push, push_full, pop, r8, r32);
+    }
+    double lp, ld;
+    bench_legacy(opt.elems, &lp, &ld);
+    std::printf("%-14s %8.2f %8s %8.2f %8s %8s   (previous latency.c ring, no IRQ masking on host)\n",
+            "legacy", lp, "-", ld, "-", "-");
+    return rc;
+}
@@ -0,0 +1,25 @@
+/*
+ * rx_prof.h
+ *
+ * Stage timing hooks for the replay build of Core/Src/uart_rx.c,
+ * force-included with -include (see Makefile). Implemented in rx_replay.cpp.
+ */
+
+#ifndef RX_PROF_H_
+#define RX_PROF_H_
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void rx_prof_begin(int stage);
+void rx_prof_end(int stage);
+
+#ifdef __cplusplus
+}
+#endif
+
+#define UART_RX_PROF_BEGIN(stage) rx_prof_begin(stage)
+#define UART_RX_PROF_END(stage)   rx_prof_end(stage)
+
+#endif /* RX_PROF_H_ */
@@ -0,0 +1,709 @@
+/*
+ * rx_replay.cpp
+ *
+ * Host replay harness for the UART1/UART3 RX path: byte stream -> mocked
+ * circular DMA buffer -> RX events -> Core/Src/uart_rx.c (bip-buffer
+ * push / drain, streaming or COBS parser) -> frame handler -> model of the
+ * command dispatcher message buffer (cmd_dispatch_post()).
+ *
+ * uart_rx.c, packet_codec.c and bipbuf.c are the firmware sources, built
+ * with the same compile switches (UART_RX_ZERO_COPY, UART_LINK_COBS).
+ * Time is simulated: bytes land in the DMA buffer at the baud rate, and
+ * the RX event callback (HAL_UARTEx_ReceiveToIdle_DMA) fires at half
+ * transfer, transfer complete and one character time after each burst
+ * (IDLE), --isr-us after the event was raised; --ht-tc 0 replays the old
+ * IDLE-only design. With --rx-task 1 (UART_RX_TASK) the event only does
+ * its bookkeeping and notifies the port's RX task, which runs
+ * uart_rx_service() --task-us later; with --rx-task 0 the ISR parses and
+ * the main loop drains the bip-buffer every --loop-us (copy path). The
+ * dispatcher task needs --cmd-us per command. CPU cost of each stage is
+ * measured on the host; for synthetic streams the frame latency (last
+ * byte on the wire -> frame handler) and the frames stuck in the buffers
+ * (signalled by an RX event, still unparsed at the next one) are
+ * reported. --check 1 exits with 1 when a synthetic frame or a byte was
+ * lost (stress runs, see Makefile).
+ *
+ *   ./rx_replay [--frames N] [--burst-frames K] [--gap-us G] [--junk PCT]
+ *               [--v2 PCT] [--seed S]                       synthetic stream
+ *   ./rx_replay --input capture.bin [--burst-bytes B] [--gap-us G]
+ *   ./rx_replay --timed capture.txt       lines "<t_us> <hex bytes...>"
+ *   common: [--baud B] [--dma BYTES] [--ht-tc 0|1] [--isr-us I]
+ *           [--rx-task 0|1] [--task-us T] [--loop-us L] [--loop-drain M]
+ *           [--cmd-us C] [--check 0|1]
+ */
+#include "uart_rx.h"
+#include "cmd_dispatch.h"
+#include "rx_prof.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <fstream>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "host_args.hpp"
+
+namespace
+{
+
+struct Options
+{
+    uint64_t frames = 20000;
+    unsigned burst_frames = 1;
+    double gap_us = 500;
+    unsigned junk = 0;
+    unsigned v2 = 0;
+    uint32_t seed = 1;
+    std::string input;
+    std::string timed;
+    size_t burst_bytes = 32;
+    uint32_t baud = 115200;
+    uint16_t dma = 64;
+    bool ht_tc = true;
+    double isr_us = 0;
+    bool rx_task = (UART_RX_TASK != 0);
+    double task_us = 20;
+    double loop_us = 0;
+    uint16_t loop_drain = 0;
+    double cmd_us = 0;
+    bool check = false;
+};
+
+Options parse_args(int argc, char **argv)
+{
+    Options o;
+    host_args::parse(argc, argv, {
+        host_args::opt("--frames", o.frames),
+        host_args::opt("--burst-frames", o.burst_frames, 1),
+        host_args::opt("--gap-us", o.gap_us, 0.0),
+        host_args::opt("--junk", o.junk),
+        host_args::opt("--v2", o.v2),
+        host_args::opt("--seed", o.seed),
+        host_args::opt("--input", o.input),
+        host_args::opt("--timed", o.timed),
+        host_args::opt("--burst-bytes", o.burst_bytes, 1),
+        host_args::opt("--baud", o.baud),
+        host_args::opt("--dma", o.dma),
+        host_args::opt("--ht-tc", o.ht_tc),
+        host_args::opt("--isr-us", o.isr_us),
+        host_args::opt("--rx-task", o.rx_task),
+        host_args::opt("--task-us", o.task_us),
+        host_args::opt("--loop-us", o.loop_us),
+        host_args::opt("--loop-drain", o.loop_drain),
+        host_args::opt("--cmd-us", o.cmd_us),
+        host_args::opt("--check", o.check),
+    });
+    if (o.dma < 2 || o.baud == 0)
+    {
+        std::fprintf(stderr, "--dma must be >= 2 and --baud > 0\n");
+        std::exit(2);
+    }
+    return o;
+}
+
+uint64_t now_ns()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+struct Burst
+{
+    double t_start;                 // us, first start bit
+    std::vector<uint8_t> bytes;
+};
+
+/* RX event, numbered as HAL_UART_RXEVENT_TC / _HT / _IDLE */
+enum EventType { EV_TC = 0, EV_HT = 1, EV_IDLE = 2 };
+
+struct Event
+{
+    double t;                       // us, raised
+    uint64_t w;                     // bytes written by then
+    EventType type;
+};
+
+struct Cost
+{
+    uint64_t calls = 0;
+    uint64_t ns = 0;
+    uint64_t max_ns = 0;
+
+    void add(uint64_t d)
+    {
+        calls++;
+        ns += d;
+        max_ns = std::max(max_ns, d);
+    }
+    double avg() const { return calls ? static_cast<double>(ns) / calls : 0.0; }
+};
+
+/* ---------- stage timing (rx_prof.h hooks) ---------- */
+Cost g_stage[2];
+uint64_t g_stage_t0[2];
+uint64_t g_stage_handler_mark[2];
+Cost g_handler;
+
+/* ---------- dispatcher model ----------
+ * One of the two message buffers of cmd_dispatch.c: the ISR side with
+ * --rx-task 0, the task side with --rx-task 1 (one port, one producer) */
+struct Msg
+{
+    double t_post;
+    uint16_t len;
+};
+
+struct Dispatcher
+{
+    std::deque<Msg> q;
+    size_t bytes = 0;               // message buffer usage, len + 4 per message
+    double free_at = 0;
+    double cmd_us = 0;
+    uint64_t posted = 0, executed = 0, full = 0, too_big = 0;
+    size_t high_water = 0;
+    uint8_t slot[CMD_DISPATCH_MAX_PAYLOAD];
+
+    void advance(double t)
+    {
+        while (!q.empty())
+        {
+            double start = std::max(free_at, q.front().t_post);
+            if (start + cmd_us > t)
+                break;
+            free_at = start + cmd_us;
+            bytes -= q.front().len + 4U;
+            q.pop_front();
+            executed++;
+        }
+    }
+
+    void post(double t, const uint8_t *payload, uint16_t len)
+    {
+        if ((len == 0U) || (len > CMD_DISPATCH_MAX_PAYLOAD))
+        {
+            too_big++;
+            return;
+        }
+        if (bytes + len + 4U > CMD_DISPATCH_BUF_SIZE)
+        {
+            full++;
+            return;
+        }
+        std::memcpy(slot, payload, len);    // xMessageBufferSendFromISR copy
+        q.push_back({t, len});
+        bytes += len + 4U;
+        high_water = std::max(high_water, bytes);
+        posted++;
+    }
+};
+
+/* ---------- frame checking ---------- */
+double g_now = 0;
+
+struct Checker
+{
+    std::vector<std::vector<uint8_t>> expected;     // empty for captures
+    std::vector<uint64_t> end_w;    // per expected frame: bytes written after its last byte
+    std::vector<double> end_t;      // per expected frame: its last byte landed, us
+    std::vector<double> latency;    // per matched frame: end_t -> handler, us
+    std::vector<uint64_t> cover;    // per expected frame: first RX event that covered it
+    uint64_t events = 0;            // RX events handled so far
+    size_t next = 0;
+    uint64_t frames = 0, ok = 0, lost = 0, unexpected = 0, stuck = 0;
+
+    /* RX event handing the first w bytes to the firmware */
+    void on_event(uint64_t w)
+    {
+        events++;
+        while ((cover.size() < end_w.size()) && (end_w[cover.size()] <= w))
+            cover.push_back(events);
+    }
+
+    void on_frame(const PacketFrame *f)
+    {
+        frames++;
+        if (expected.empty())
+            return;
+        for (size_t i = next; i < expected.size() && i < next + 256; i++)
+        {
+            const std::vector<uint8_t> &e = expected[i];
+            if ((e.size() == f->len) && (std::memcmp(e.data(), f->payload, f->len) == 0))
+            {
+                lost += i - next;
+                next = i + 1;
+                ok++;
+                latency.push_back(g_now - end_t[i]);
+                // Parsed only after a later RX event: it sat in a buffer
+                if ((i < cover.size()) && (events > cover[i]))
+                    stuck++;
+                return;
+            }
+        }
+        unexpected++;   // spliced / corrupted frame that still passed the checksum
+    }
+};
+
+Dispatcher g_disp;
+Checker g_check;
+
+/* uart_link_on_frame() of main.c: post to the dispatcher */
+void on_frame(void *ctx, const PacketFrame *frame)
+{
+    (void)ctx;
+    uint64_t t0 = now_ns();
+    g_check.on_frame(frame);
+    g_disp.post(g_now, frame->payload, frame->len);
+    g_handler.add(now_ns() - t0);
+}
+
+/* ---------- stream sources ---------- */
+std::vector<uint8_t> make_frame(std::mt19937 &rng, bool v2, std::vector<uint8_t> &payload)
+{
+    static const uint8_t text[] = "Hi!\r\n";
+    switch (rng() % 4)
+    {
+    case 0: payload = {LED_ON}; break;
+    case 1: payload = {SET_LED, 1}; break;
+    case 2: payload = {PWM_ON, static_cast<uint8_t>(rng() % 101), 0xE8, 0x03}; break;
+    default:
+        payload = {UART_TX};
+        payload.insert(payload.end(), text, text + sizeof(text) - 1);
+        break;
+    }
+
+    std::vector<uint8_t> frame(PKT_V2_FRAME_SIZE(payload.size()));
+    uint16_t n = v2 ? build_packet_v2(frame.data(), static_cast<uint8_t>(rng()),
+                    static_cast<CMD_ID>(payload[0]), &payload[1],
+                    static_cast<uint16_t>(payload.size() - 1))
+                    : build_packet(frame.data(), static_cast<CMD_ID>(payload[0]),
+                    &payload[1], static_cast<uint8_t>(payload.size() - 1));
+    frame.resize(n);
+#if (UART_LINK_COBS != 0)
+    std::vector<uint8_t> enc(COBS_MAX_ENCODED_LEN(n) + 1);
+    enc.resize(packet_cobs_encode(enc.data(), frame.data(), n));
+    return enc;
+#else
+    return frame;
+#endif
+}
+
+std::vector<Burst> synthetic(const Options &o, double char_us)
+{
+    std::mt19937 rng(o.seed);
+    std::vector<Burst> bursts;
+    double t = 0;
+    uint64_t w = 0;
+
+    for (uint64_t i = 0; i < o.frames;)
+    {
+        Burst b;
+        b.t_start = t;
+        for (unsigned k = 0; k < o.burst_frames && i < o.frames; k++, i++)
+        {
+            std::vector<uint8_t> payload;
+            std::vector<uint8_t> f = make_frame(rng, (rng() % 100) < o.v2, payload);
+            g_check.expected.push_back(payload);
+            b.bytes.insert(b.bytes.end(), f.begin(), f.end());
+            g_check.end_w.push_back(w + b.bytes.size());
+            g_check.end_t.push_back(t + b.bytes.size() * char_us);
+            if ((rng() % 100) < o.junk)
+            {
+                // Junk without header / delimiter bytes, so no frame is lost
+                for (unsigned j = 1 + rng() % 16; j > 0; j--)
+                {
+                    uint8_t x = static_cast<uint8_t>(rng());
+                    b.bytes.push_back((x == CMD_HEADER || x == CMD_HEADER_V2 || x == 0) ? 0x55 : x);
+                }
+            }
+        }
+        t += b.bytes.size() * char_us + o.gap_us;
+        w += b.bytes.size();
+        bursts.push_back(std::move(b));
+    }
+    return bursts;
+}
+
+std::vector<Burst> from_raw(const Options &o, double char_us)
+{
+    std::ifstream f(o.input, std::ios::binary);
+    if (!f)
+    {
+        std::fprintf(stderr, "cannot open %s\n", o.input.c_str());
+        std::exit(2);
+    }
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(f)), std::istreambuf_iterator<char>());
+    std::vector<Burst> bursts;
+    double t = 0;
+    for (size_t pos = 0; pos < data.size(); pos += o.burst_bytes)
+    {
+        size_t n = std::min(o.burst_bytes, data.size() - pos);
+        bursts.push_back({t, std::vector<uint8_t>(data.begin() + pos, data.begin() + pos + n)});
+        t += n * char_us + o.gap_us;
+    }
+    return bursts;
+}
+
+std::vector<Burst> from_timed(const Options &o)
+{
+    std::ifstream f(o.timed);
+    if (!f)
+    {
+        std::fprintf(stderr, "cannot open %s\n", o.timed.c_str());
+        std::exit(2);
+    }
+    std::vector<Burst> bursts;
+    std::string line;
+    while (std::getline(f, line))
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream ss(line);
+        Burst b;
+        std::string tok;
+        if (!(ss >> b.t_start))
+            continue;
+        while (ss >> tok)
+            b.bytes.push_back(static_cast<uint8_t>(std::strtoul(tok.c_str(), nullptr, 16)));
+        if (!b.bytes.empty())
+            bursts.push_back(std::move(b));
+    }
+    std::sort(bursts.begin(), bursts.end(),
+            [](const Burst &a, const Burst &b) { return a.t_start < b.t_start; });
+    return bursts;
+}
+
+} // namespace
+
+extern "C" void rx_prof_begin(int stage)
+{
+    g_stage_handler_mark[stage] = g_handler.ns;
+    g_stage_t0[stage] = now_ns();
+}
+
+extern "C" void rx_prof_end(int stage)
+{
+    uint64_t d = now_ns() - g_stage_t0[stage];
+    uint64_t handler = g_handler.ns - g_stage_handler_mark[stage];
+    g_stage[stage].add(d > handler ? d - handler : 0);
+}
+
+/* RX task model: uart_rx_task.c notify hook, ISR context. The task runs
+ * --task-us later; notifications while it is pending add nothing. */
+namespace
+{
+double g_task_due = 1e300;
+double g_task_us = 0;
+uint64_t g_notified = 0, g_notify_merged = 0;
+}
+
+extern "C" void rx_task_notify(void *ctx)
+{
+    (void)ctx;
+    g_notified++;
+    if (g_task_due < 1e300)
+        g_notify_merged++;
+    else
+        g_task_due = g_now + g_task_us;
+}
+
+/* Parsers without a handler are not used here */
+extern "C" void packet_default_handler(void *ctx, const PacketFrame *frame)
+{
+    (void)ctx;
+    (void)frame;
+}
+
+int main(int argc, char **argv)
+{
+    const Options opt = parse_args(argc, argv);
+    const double char_us = 10.0 * 1e6 / opt.baud;     // 8N1
+
+    std::vector<Burst> bursts = !opt.timed.empty() ? from_timed(opt)
+            : !opt.input.empty() ? from_raw(opt, char_us) : synthetic(opt, char_us);
+    if (bursts.empty())
+    {
+        std::fprintf(stderr, "empty stream\n");
+        return 2;
+    }
+
+    // Port set up as in main.c
+    std::vector<uint8_t> dma(opt.dma);
+    std::vector<uint8_t> parser_buf(PKT_V2_FRAME_SIZE(CMD_DISPATCH_MAX_PAYLOAD));
+    static BipBuf bip;
+    static uint8_t bip_buf[UART_RX_BIP_SIZE];
+    static PacketParser parser;
+    static PacketCobsParser cobs;
+    UartRxPort port;
+    bipbuf_init(&bip, bip_buf, sizeof(bip_buf));
+    packet_parser_init_buf(&parser, parser_buf.data(), static_cast<uint16_t>(parser_buf.size()));
+    packet_parser_set_resync(&parser, 1);
+    packet_parser_set_handler(&parser, on_frame, nullptr);
+    packet_cobs_init(&cobs);
+    packet_cobs_set_handler(&cobs, on_frame, nullptr);
+    uart_rx_port_init(&port, dma.data(), opt.dma, &bip, &parser, &cobs);
+    if (opt.rx_task)
+        uart_rx_set_notify(&port, rx_task_notify, nullptr);
+    uint32_t cndtr = opt.dma;       // the DMA channel's counter (CNDTR)
+    uart_rx_set_dma_counter(&port, &cndtr);
+    g_task_us = opt.task_us;
+    g_disp.cmd_us = opt.cmd_us;
+
+    // Byte arrival: the line is busy while a burst is on the wire
+    std::vector<double> t_end(bursts.size());
+    double busy = 0;
+    uint64_t total_bytes = 0;
+    for (size_t i = 0; i < bursts.size(); i++)
+    {
+        bursts[i].t_start = std::max(bursts[i].t_start, busy);
+        t_end[i] = bursts[i].t_start + bursts[i].bytes.size() * char_us;
+        busy = t_end[i];
+        total_bytes += bursts[i].bytes.size();
+    }
+
+    // RX events in time order: HT / TC as the bytes land, IDLE after a burst
+    const uint16_t half = static_cast<uint16_t>(opt.dma / 2U);
+    std::vector<Event> events;
+    uint64_t merged = 0;
+    {
+        uint64_t w = 0;
+        for (size_t i = 0; i < bursts.size(); i++)
+        {
+            const Burst &b = bursts[i];
+            for (size_t k = 0; k < b.bytes.size(); k++)
+            {
+                w++;
+                uint16_t pos = static_cast<uint16_t>(w % opt.dma);
+                if (opt.ht_tc && ((pos == 0U) || (pos == half)))
+                    events.push_back({b.t_start + (k + 1) * char_us, w, (pos == 0U) ? EV_TC : EV_HT});
+            }
+            // IDLE one character time after the burst, unless the next one starts first
+            double t_idle = t_end[i] + char_us;
+            if ((i + 1 < bursts.size()) && (bursts[i + 1].t_start < t_idle))
+            {
+                merged++;
+                continue;
+            }
+            events.push_back({t_idle, w, EV_IDLE});
+        }
+    }
+
+    const bool loop_drain = (UART_RX_ZERO_COPY == 0) && !opt.rx_task && (opt.loop_us > 0);
+    size_t wb = 0, wo = 0;          // next byte to land in the DMA buffer
+    uint64_t wr = 0, w_last = 0;    // bytes written, processed by the firmware
+    uint64_t ev_count[3] = {0, 0, 0}, coalesced = 0, overwritten = 0;
+    double pending_until[3] = {-1, -1, -1};
+    double next_loop = loop_drain ? opt.loop_us : 1e300;
+    Cost isr, loop, task;
+
+    auto dma_until = [&](double t) {
+        while (wb < bursts.size())
+        {
+            const Burst &b = bursts[wb];
+            if (b.t_start + (wo + 1) * char_us > t)
+                break;
+            dma[wr % opt.dma] = b.bytes[wo];
+            wr++;
+            cndtr = opt.dma - static_cast<uint32_t>(wr % opt.dma);
+            if (++wo == b.bytes.size())
+            {
+                wb++;
+                wo = 0;
+            }
+        }
+    };
+
+    // Main loop drains and RX task runs due before t, in time order
+    auto run_until = [&](double t) {
+        for (;;)
+        {
+            double next = std::min(next_loop, g_task_due);
+            if (next > t)
+                break;
+            g_now = next;
+            dma_until(g_now);
+            g_disp.advance(g_now);
+            if (next == g_task_due)
+            {
+                g_task_due = 1e300;
+  #if (UART_RX_ZERO_COPY != 0)
+                // The task reads the n bytes ending at the last event now;
+                // a byte is stale if the DMA already wrote one dma_size later.
+                // The task skips those itself (lapped): only stale bytes it
+                // did not see are parsed as if they were new
+                uint32_t n = port.rx_head - port.task_done;
+                uint64_t stale = 0;
+                if ((n < opt.dma) && (wr > opt.dma) && (wr - opt.dma > w_last - n))
+                    stale = std::min<uint64_t>(n, wr - opt.dma - (w_last - n));
+                uint32_t lapped = port.lapped;
+  #endif
+                uint64_t t0 = now_ns();
+                uart_rx_service(&port);
+                task.add(now_ns() - t0);
+  #if (UART_RX_ZERO_COPY != 0)
+                if (stale > port.lapped - lapped)
+                    overwritten += stale - (port.lapped - lapped);
+  #endif
+            }
+            else
+            {
+                uint64_t t0 = now_ns();
+                uart_rx_drain(&port, opt.loop_drain);
+                loop.add(now_ns() - t0);
+                next_loop += opt.loop_us;
+            }
+        }
+    };
+
+    for (const Event &e : events)
+    {
+        // Its flag is still set from an event not serviced yet: one interrupt
+        if (e.t < pending_until[e.type])
+        {
+            coalesced++;
+            continue;
+        }
+        const double t_isr = e.t + opt.isr_us;
+        pending_until[e.type] = t_isr;
+
+        run_until(t_isr);
+        g_now = t_isr;
+        dma_until(g_now);
+        g_disp.advance(g_now);
+
+        // HT / TC report a fixed position, IDLE the DMA counter at ISR time;
+        // HAL drops an IDLE at position 0 (transfer complete covers it)
+        uint64_t w_ev = (e.type == EV_IDLE) ? wr : e.w;
+        uint16_t pos = static_cast<uint16_t>(w_ev % opt.dma);
+        if (e.type == EV_TC)
+            pos = opt.dma;
+        else if ((e.type == EV_IDLE) && (pos == 0U) && opt.ht_tc)
+            continue;
+
+        // The firmware reads (w_ev - w_last) % dma bytes ending at w_ev; a
+        // byte is stale if the DMA already wrote one dma_size later
+        uint64_t delta = w_ev - w_last;
+        uint64_t read_from = w_ev - (delta % opt.dma);
+        if (wr > opt.dma)
+            read_from = std::max(read_from, wr - opt.dma);
+        overwritten += delta - ((w_ev > read_from) ? w_ev - read_from : 0);
+        w_last = w_ev;
+
+        uint16_t remaining = static_cast<uint16_t>(opt.dma - (wr % opt.dma));
+        g_check.on_event(w_ev);
+        uint64_t t0 = now_ns();
+        uart_rx_on_event(&port, pos, remaining);
+        isr.add(now_ns() - t0);
+        ev_count[e.type]++;
+    }
+    if (g_task_due < 1e300)
+        run_until(g_task_due);
+
+    const double sim_us = g_now;
+    uint16_t ring_left = bipbuf_used(&bip);
+    uint16_t parser_left = (UART_LINK_COBS != 0) ? cobs.idx : parser.idx;
+    g_disp.advance(1e300);
+
+    const uint32_t csum_err = (UART_LINK_COBS != 0) ? cobs.csum_err : parser.csum_err;
+    const uint32_t len_err = (UART_LINK_COBS != 0) ? cobs.len_err : parser.len_err;
+    if (!g_check.expected.empty())
+        g_check.lost += g_check.expected.size() - g_check.next;
+
+    std::printf("path: %s, framing: %s, events: %s, baud %u, dma %u B, bip %u B, parser cap %zu B\n",
+            UART_RX_ZERO_COPY ? "zero-copy (DMA -> parser)" : "copy (DMA -> bip-buffer -> parser)",
+            UART_LINK_COBS ? "COBS" : "HEADER+LENGTH", opt.ht_tc ? "HT+TC+IDLE" : "IDLE only",
+            opt.baud, opt.dma, bip.size, parser_buf.size());
+    if (opt.rx_task)
+        std::printf("parsing: RX task, woken %.0f us after the ISR; %llu notifications, %llu while pending\n",
+                opt.task_us, (unsigned long long)g_notified, (unsigned long long)g_notify_merged);
+    else
+        std::printf("parsing: in the ISR%s\n", (UART_RX_ZERO_COPY != 0) ? ""
+                : loop_drain ? ", bip-buffer capped + main loop drain" : ", bip-buffer capped (UART_RX_ISR_DRAIN)");
+    std::printf("stream: %zu bursts, %llu bytes, %.3f s simulated, %llu bursts merged\n",
+            bursts.size(), (unsigned long long)total_bytes, sim_us / 1e6, (unsigned long long)merged);
+    std::printf("events: HT %llu, TC %llu, IDLE %llu, coalesced %llu (isr latency %.0f us)\n",
+            (unsigned long long)ev_count[EV_HT], (unsigned long long)ev_count[EV_TC],
+            (unsigned long long)ev_count[EV_IDLE], (unsigned long long)coalesced, opt.isr_us);
+    std::printf("frames: parsed %llu", (unsigned long long)g_check.frames);
+    if (!g_check.expected.empty())
+        std::printf(", sent %zu, matched %llu, lost %llu, unexpected %llu",
+                g_check.expected.size(), (unsigned long long)g_check.ok,
+                (unsigned long long)g_check.lost, (unsigned long long)g_check.unexpected);
+    if (UART_LINK_COBS == 0)
+        std::printf(", in place %lu (no parser copy)", (unsigned long)parser.inplace_frames);
+    std::printf("\n");
+    std::printf("drops: dma_overwrite %llu B, dma_anomaly %lu, task_lapped %lu B, rb_overrun %lu B, csum_err %lu, "
+            "len_err %lu, resync %lu (%lu B), dispatch_full %llu, dispatch_too_big %llu\n",
+            (unsigned long long)overwritten, (unsigned long)port.dma_anomaly, (unsigned long)port.lapped,
+            (unsigned long)bip.dropped,
+            (unsigned long)csum_err, (unsigned long)len_err, (unsigned long)parser.resync_count,
+            (unsigned long)parser.dropped_bytes, (unsigned long long)g_disp.full,
+            (unsigned long long)g_disp.too_big);
+    std::printf("stuck at end: %u B in bip, %u B in parser; dispatcher: %llu executed, buffer high water %zu/%u B\n",
+            ring_left, parser_left, (unsigned long long)g_disp.executed, g_disp.high_water,
+            (unsigned)CMD_DISPATCH_BUF_SIZE);
+    if (!g_check.latency.empty())
+    {
+        std::vector<double> &lat = g_check.latency;
+        std::sort(lat.begin(), lat.end());
+        double sum = 0;
+        for (double l : lat)
+            sum += l;
+        std::printf("latency (last byte -> handler, us): avg %.1f, p50 %.1f, p99 %.1f, max %.1f; "
+                "stuck past the next RX event %llu frames (%.2f%%)\n",
+                sum / lat.size(), lat[lat.size() / 2], lat[lat.size() * 99 / 100], lat.back(),
+                (unsigned long long)g_check.stuck, 100.0 * g_check.stuck / g_check.expected.size());
+    }
+
+#if (SPSC_RING_STATS != 0)
+    // Same numbers as the RING_STATS command (ring_stats.h)
+    auto occupancy = [](const char *name, uint16_t size, const SpscRingStats &st) {
+        std::printf("  %-10s high %u/%u, overflows %lu, hist", name, st.high_water, size,
+                (unsigned long)st.overflows);
+        for (uint32_t h : st.hist)
+            std::printf(" %lu", (unsigned long)h);
+        std::printf("\n");
+    };
+    std::printf("occupancy (hist: events / drains per eighth of the size)\n");
+    occupancy("dma", opt.dma, port.dma_stats);
+    if (UART_RX_ZERO_COPY == 0)
+        occupancy("bip", bip.size, bip.stats);
+#endif
+
+    std::printf("stage cost (host ns)      calls      avg      max\n");
+    auto row = [](const char *name, const Cost &c) {
+        std::printf("  %-22s %9llu %8.0f %8llu\n", name, (unsigned long long)c.calls, c.avg(),
+                (unsigned long long)c.max_ns);
+    };
+    row("RX event ISR (total)", isr);
+    if (opt.rx_task)
+        row("RX task (total)", task);
+    if (UART_RX_ZERO_COPY == 0)
+    {
+        row("bip push", g_stage[UART_RX_STAGE_PUSH]);
+        if (loop_drain)
+            row("loop drain (total)", loop);
+    }
+    row("parse (excl. handler)", g_stage[UART_RX_STAGE_PARSE]);
+    row("frame handler + post", g_handler);
+
+    uint64_t cpu_ns = isr.ns + loop.ns + task.ns;
+    std::printf("throughput: %.2f M frames/s of RX path CPU; wire %.0f frames/s, %.1f%% line utilization\n",
+            cpu_ns ? g_check.frames * 1e3 / cpu_ns : 0.0,
+            sim_us > 0 ? g_check.frames * 1e6 / sim_us : 0.0,
+            sim_us > 0 ? 100.0 * total_bytes * char_us / sim_us : 0.0);
+
+    if (opt.check)
+    {
+        bool ok = (overwritten == 0) && (port.lapped == 0) && (bip.dropped == 0) && (g_check.lost == 0)
+                && (g_check.unexpected == 0) && (ring_left == 0) && (parser_left == 0);
+        std::printf("check: %s\n", ok ? "OK" : "FAIL");
+        return ok ? 0 : 1;
+    }
+    return 0;
+}
@@ -0,0 +1,255 @@
+#!/usr/bin/env python3
+"""Decode binary telemetry frames (Core/Inc/telemetry.h) from a UART capture.
+
+With TELEMETRY_BINARY=1 the firmware sends Phase1 / Phase2 measurements as
+v1 packet frames instead of CSV rows:
+
+    AA | LENGTH | 0xC0 + id | RECORD | CHECKSUM     data record
+    AA | LENGTH | 0xCF | id | "name|field:T,..." | CHECKSUM   schema
+
+Record layouts come from the schema frames in the capture itself, so this
+script has no copy of the firmware structs. print() text on the same UART
+is kept as lines.
+
+The DataFrames match the CSV parsers (same columns, dtypes and row order):
+
+- latency_dataframe(): tools/phase1/capture_latency.py parse_latency_lines()
+- phase2_dataframe(): tools/phase2/phase2_analyze.py extract_dataframe()
+
+Examples:
+    # Capture raw bytes, then convert to the text format the phase tools read
+    python tools/telemetry/decode_telemetry.py --port COM5 --seconds 20 --out lat.bin
+    python tools/telemetry/decode_telemetry.py --input lat.bin --phase1-text lat.txt
+    python tools/phase1/capture_latency.py --input lat.txt
+
+    python tools/telemetry/decode_telemetry.py --input mode1.bin --phase2-text mode1_demo.txt
+"""
+
+from __future__ import annotations
+
+import argparse
+import struct
+import sys
+import time
+from dataclasses import dataclass, field
+from pathlib import Path
+
+import pandas as pd
+
+CMD_HEADER = 0xAA
+TELEM_CMD_BASE = 0xC0
+TELEM_CMD_SCHEMA = 0xCF
+
+LATENCY_COLUMNS = [
+    "seq",
+    "systick_ms",
+    "load_active",
+    "latency_ticks",
+    "latency_us",
+    "exec_ticks",
+    "exec_us",
+    "latency_delta_ticks",
+]
+PHASE2_COLUMNS = ["iter", "mode", "high_wait_ticks", "low_hold_ticks", "medium_spin_count"]
+
+
+@dataclass
+class RecordType:
+    name: str
+    fields: list
+    fmt: struct.Struct
+
+
+@dataclass
+class Capture:
+    records: dict = field(default_factory=dict)     # name -> list of dicts
+    text_lines: list = field(default_factory=list)
+    frames: int = 0
+    bad_frames: int = 0         # checksum / length errors
+    unknown_records: int = 0    # data record before its schema
+
+
+def parse_schema(payload):
+    """Schema frame payload (after CMD): id, 'name|field:T,...'."""
+    type_id = payload[0]
+    name, _, spec = payload[1:].decode("ascii").partition("|")
+    names, codes = [], []
+    for item in spec.split(","):
+        fname, _, code = item.partition(":")
+        names.append(fname)
+        codes.append(code)
+    return type_id, RecordType(name, names, struct.Struct("<" + "".join(codes)))
+
+
+def decode(data):
+    """Split a raw capture into telemetry records and text lines."""
+    cap = Capture()
+    types = {}
+    text = bytearray()
+    i = 0
+    n = len(data)
+
+    while i < n:
+        b = data[i]
+        if b != CMD_HEADER:
+            text.append(b)
+            i += 1
+            continue
+
+        if i + 2 >= n:
+            break
+        length = data[i + 1]
+        end = i + 2 + length
+        if length == 0 or end >= n:
+            cap.bad_frames += 1
+            i += 1
+            continue
+        if (sum(data[i:end]) & 0xFF) != data[end]:
+            cap.bad_frames += 1
+            i += 1
+            continue
+
+        cmd = data[i + 2]
+        payload = bytes(data[i + 3:end])
+        i = end + 1
+        cap.frames += 1
+
+        if cmd == TELEM_CMD_SCHEMA:
+            type_id, rtype = parse_schema(payload)
+            types[type_id] = rtype
+            cap.records.setdefault(rtype.name, [])
+            continue
+
+        rtype = types.get(cmd - TELEM_CMD_BASE)
+        if rtype is None or len(payload) != rtype.fmt.size:
+            cap.unknown_records += 1
+            continue
+        values = rtype.fmt.unpack(payload)
+        cap.records[rtype.name].append(dict(zip(rtype.fields, values)))
+
+    for line in text.decode("utf-8", errors="ignore").splitlines():
+        line = line.strip()
+        if line:
+            cap.text_lines.append(line)
+    return cap
+
+
+def _x1000(ticks, tick_hz):
+    # Same integer math as latency.c: "%lu.%03lu" of ticks * 1e9 / tick_hz
+    return (ticks * 1000000000 // tick_hz) / 1000
+
+
+def latency_rows(cap):
+    """Phase1 rows, as dicts with the capture_latency.py CSV columns."""
+    starts = cap.records.get("lat_start", [])
+    samples = cap.records.get("lat_sample", [])
+    if not samples:
+        return []
+    if not starts:
+        raise ValueError("lat_start record missing (tick_hz unknown)")
+
+    tick_hz = starts[-1]["tick_hz"]
+    rows = []
+    for s in samples:
+        rows.append(
+            {
+                "seq": s["seq"],
+                "systick_ms": s["systick_ms"],
+                "load_active": s["load_active"],
+                "latency_ticks": s["latency_ticks"],
+                "latency_us": _x1000(s["latency_ticks"], tick_hz),
+                "exec_ticks": s["exec_ticks"],
+                "exec_us": _x1000(s["exec_ticks"], tick_hz),
+                "latency_delta_ticks": s["latency_delta_ticks"],
+            }
+        )
+    return rows
+
+
+def latency_dataframe(cap):
+    return pd.DataFrame(latency_rows(cap))
+
+
+def phase2_dataframe(cap):
+    """(df, cfg) like phase2_analyze.extract_dataframe(); cfg values are str."""
+    rows = [{k: r[k] for k in PHASE2_COLUMNS} for r in cap.records.get("p2_row", [])]
+    cfgs = cap.records.get("p2_cfg", [])
+    cfg = {k: str(v) for k, v in cfgs[-1].items()} if cfgs else {}
+
+    df = pd.DataFrame(rows)
+    if not df.empty:
+        df = df.sort_values(["mode", "iter"]).drop_duplicates(["mode", "iter"], keep="last").reset_index(drop=True)
+    return df, cfg
+
+
+def write_phase1_text(cap, path):
+    """CSV text accepted by capture_latency.py --input."""
+    with open(path, "w", encoding="utf-8", newline="") as f:
+        f.write(",".join(LATENCY_COLUMNS) + "\n")
+        for r in latency_rows(cap):
+            f.write(
+                f"{r['seq']},{r['systick_ms']},{r['load_active']},{r['latency_ticks']},"
+                f"{r['latency_us']:.3f},{r['exec_ticks']},{r['exec_us']:.3f},{r['latency_delta_ticks']}\n"
+            )
+
+
+def write_phase2_text(cap, path):
+    """CFG line + CSV text accepted by phase2_analyze.py."""
+    df, cfg = phase2_dataframe(cap)
+    with open(path, "w", encoding="utf-8", newline="") as f:
+        if cfg:
+            f.write("CFG," + ",".join(f"{k}={v}" for k, v in cfg.items()) + "\n")
+        f.write(",".join(PHASE2_COLUMNS) + "\n")
+        for row in df.itertuples(index=False):
+            f.write(",".join(str(int(v)) for v in row) + "\n")
+
+
+def capture_serial(port, baud, seconds, out_path):
+    import serial
+
+    start = time.time()
+    with serial.Serial(port=port, baudrate=baud, timeout=0.5) as ser, open(out_path, "wb") as f:
+        print(f"[INFO] 開始擷取 serial: {port} @ {baud}, duration={seconds}s")
+        while time.time() - start < seconds:
+            f.write(ser.read(4096))
+    print(f"[INFO] Serial 擷取完成，raw 檔案: {out_path}")
+
+
+def main():
+    parser = argparse.ArgumentParser(description="Decode binary telemetry frames")
+    parser.add_argument("--port", help="Serial port, e.g. COM5 (capture raw bytes to --out)")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--seconds", type=int, default=20)
+    parser.add_argument("--out", help="Raw capture file written by --port")
+    parser.add_argument("--input", help="Raw capture file to decode")
+    parser.add_argument("--phase1-text", help="Write Phase1 CSV text for capture_latency.py --input")
+    parser.add_argument("--phase2-text", help="Write Phase2 log text for phase2_analyze.py")
+    args = parser.parse_args()
+
+    if args.port:
+        if not args.out:
+            print("[ERROR] --port 需要搭配 --out")
+            sys.exit(1)
+        capture_serial(args.port, args.baud, args.seconds, args.out)
+        if not args.input:
+            args.input = args.out
+
+    if not args.input:
+        print("[ERROR] 未提供 --input 或 --port")
+        sys.exit(1)
+
+    cap = decode(Path(args.input).read_bytes())
+    print(f"frames={cap.frames} bad={cap.bad_frames} unknown={cap.unknown_records} text_lines={len(cap.text_lines)}")
+    for name, recs in cap.records.items():
+        print(f"  {name}: {len(recs)}")
+
+    if args.phase1_text:
+        write_phase1_text(cap, args.phase1_text)
+        print(f"phase1 text: {args.phase1_text}")
+    if args.phase2_text:
+        write_phase2_text(cap, args.phase2_text)
+        print(f"phase2 text: {args.phase2_text}")
+
+
+if __name__ == "__main__":
+    main()